@@ -3,5 +3,6 @@
 //
 // Sub-packages:
 //   - hnsw: HNSWlib bindings for vector similarity search
+//   - hybrid: fused keyword + vector search over the two bindings
 //   - xapian: Xapian bindings for full-text search
 package cgo
@@ -14,22 +14,29 @@ import "C"
 import (
 	"context"
 	"errors"
+	"fmt"
 	"sync"
+	"time"
 	"unsafe"
 
 	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
 )
 
-// Ensure Index implements the interface.
-var _ driven.VectorIndex = (*Index)(nil)
+// Ensure Index implements the interfaces.
+var (
+	_ driven.VectorIndex           = (*Index)(nil)
+	_ driven.BatchVectorIndex      = (*Index)(nil)
+	_ driven.FilterableVectorIndex = (*Index)(nil)
+)
 
 // Default configuration values
 const (
 	DefaultMaxElements = 100000
 )
 
-// Precision defines the storage precision for vectors.
-// Runtime operations always use float32; this only affects disk storage.
+// Precision defines the storage precision for vectors, both in memory and on
+// disk. Compressed precisions are searched directly in their compressed form;
+// int8 results are re-ranked against the float32 query.
 type Precision int
 
 const (
@@ -42,35 +49,153 @@ const (
 )
 
 // Index provides vector similarity search using HNSWlib.
+// The native index synchronises adds, deletes and searches itself, so mu only
+// guards the handle against Close: every operation holds it shared.
 type Index struct {
 	mu        sync.RWMutex
 	idx       *C.HnswIndex
 	path      string
 	dimension int
 	precision Precision
+	readOnly  bool
+	buffers   bufferPool
+	labels    labelCache
+}
+
+// errReadOnly is returned by mutations on an index opened with OpenReadOnly.
+var errReadOnly = errors.New("hnsw: index is read-only")
+
+// Options tunes the HNSW graph. Zero fields use the library defaults
+// (M=16, EfConstruction=200, EfSearch=50).
+type Options struct {
+	// M is the number of connections per element. Higher values improve
+	// recall at the cost of memory. Fixed when the index is created.
+	M int
+	// EfConstruction is the beam width used while inserting. Higher values
+	// build a better graph more slowly. Fixed when the index is created.
+	EfConstruction int
+	// EfSearch is the default search beam width. Higher values improve
+	// recall at the cost of latency. Applied on every open.
+	EfSearch int
+	// MaxElements is the initial capacity (default DefaultMaxElements). The
+	// index grows past it as needed. Fixed when the index is created.
+	MaxElements int
+}
+
+// SearchOptions overrides index defaults for a single search.
+// Zero fields use the index defaults.
+type SearchOptions struct {
+	// Ef is the search beam width; the effective value is at least k.
+	Ef int
+	// RerankFactor is the number of candidates per result re-ranked in
+	// float32 for compressed indexes (1 disables re-ranking).
+	RerankFactor int
+	// Filter restricts results by the attributes stored with each vector.
+	// It is applied during graph traversal, so up to k eligible hits are
+	// returned. Nil searches all vectors.
+	Filter *driven.VectorFilter
+}
+
+// FlushOptions schedules background maintenance of a writable index. Zero
+// fields use the defaults.
+type FlushOptions struct {
+	// Interval is the longest time between rounds (default 1s). Each round
+	// syncs the changes logged since the last one to stable storage.
+	Interval time.Duration
+	// MaxUnsynced starts a round early once this many changes are unsynced
+	// (default 1000).
+	MaxUnsynced int
+	// MaxLogBytes checkpoints once the write-ahead log reaches this size
+	// (default: half the snapshot size, as on Close).
+	MaxLogBytes int64
+}
+
+// StatsBuckets is the number of buckets in each Stats histogram. Bucket 0
+// counts values below 2 and bucket i (i > 0) values in [2^i, 2^(i+1)); the
+// last bucket is open-ended.
+const StatsBuckets = C.HNSW_STATS_BUCKETS
+
+// Stats reports index sizes and the counters gathered since it was opened.
+type Stats struct {
+	LiveElements    uint64 // Mapped chunk IDs
+	DeletedElements uint64 // Tombstoned graph slots awaiting reuse or compaction
+	MaxElements     uint64 // Current capacity
+	Resizes         uint64 // Capacity growths
+	// UnsourcedElements are live vectors without a source, which pass every
+	// source filter: vectors added without attributes, or indexed before
+	// attributes were stored.
+	UnsourcedElements uint64
+
+	VectorBytes  uint64 // Stored vectors (allocated capacity)
+	GraphBytes   uint64 // Links and labels of all layers
+	MappingBytes uint64 // Chunk ID table and filter attributes
+	WALBytes     uint64 // Write-ahead log on disk
+
+	Searches             uint64
+	DistanceComputations uint64        // Summed over searches
+	SearchTime           time.Duration // Summed over searches
+	// DistanceHistogram buckets searches by their distance computations.
+	DistanceHistogram [StatsBuckets]uint64
+	// LatencyHistogram buckets searches by latency in microseconds.
+	LatencyHistogram [StatsBuckets]uint64
+
+	LockWaits         uint64        // Contended lock acquisitions
+	ReadLockWait      time.Duration // Searches waiting for the index lock
+	ExclusiveLockWait time.Duration // Graph mutations waiting for the index lock
+	WriterWait        time.Duration // Adds and deletes waiting for another writer
 }
 
 // New creates or opens an HNSW index with the specified storage precision.
-// The precision parameter only affects disk storage; runtime always uses float32.
+// The precision parameter sets the in-memory and on-disk vector format.
 func New(path string, dimension int, precision Precision) (*Index, error) {
+	return NewWithOptions(path, dimension, precision, Options{})
+}
+
+// NewWithOptions creates or opens an HNSW index with explicit graph options.
+// M and EfConstruction only apply when a new index is created; an existing
+// index keeps the values it was built with. An existing index that cannot be
+// opened is an error and is left untouched; a partitioned store at path is
+// reported as ErrLayoutMismatch.
+func NewWithOptions(path string, dimension int, precision Precision, opts Options) (*Index, error) {
 	if path == "" {
 		return nil, errors.New("hnsw: path cannot be empty")
 	}
 	if dimension <= 0 {
 		return nil, errors.New("hnsw: dimension must be positive")
 	}
+	if hasPartitions(path) {
+		return nil, fmt.Errorf("%w: %s is partitioned by source", ErrLayoutMismatch, path)
+	}
 
 	cpath := C.CString(path)
 	defer C.free(unsafe.Pointer(cpath))
 
-	// Try to open existing index first
+	// Try to open existing index first. An index that exists but fails to
+	// open (other dimension, damaged or unknown format) is reported, never
+	// replaced by a new one.
 	idx := C.hnsw_open(cpath, C.int(dimension))
 	if idx == nil {
-		// Create new index with specified precision
-		idx = C.hnsw_create(cpath, C.int(dimension), C.int(DefaultMaxElements), C.HnswPrecision(precision))
+		if C.hnsw_index_exists(cpath) != 0 {
+			return nil, errors.New("hnsw: failed to open existing index")
+		}
+
+		// Create new index with specified precision and graph parameters
+		params := C.HnswBuildParams{
+			M:               C.int(opts.M),
+			ef_construction: C.int(opts.EfConstruction),
+			ef_search:       C.int(opts.EfSearch),
+		}
+		maxElements := opts.MaxElements
+		if maxElements <= 0 {
+			maxElements = DefaultMaxElements
+		}
+		idx = C.hnsw_create_ex(cpath, C.int(dimension), C.int(maxElements),
+			C.HnswPrecision(precision), &params)
 		if idx == nil {
 			return nil, errors.New("hnsw: failed to create index")
 		}
+	} else if opts.EfSearch > 0 {
+		C.hnsw_set_ef(idx, C.int(opts.EfSearch))
 	}
 
 	return &Index{
@@ -81,14 +206,54 @@ func New(path string, dimension int, precision Precision) (*Index, error) {
 	}, nil
 }
 
+// IndexExists reports whether path holds the files of an index, whether or
+// not it can be opened.
+func IndexExists(path string) bool {
+	cpath := C.CString(path)
+	defer C.free(unsafe.Pointer(cpath))
+
+	return C.hnsw_index_exists(cpath) != 0
+}
+
+// OpenReadOnly opens an existing index by memory-mapping it, for processes
+// that only search. Open time does not depend on index size and the mapped
+// pages are shared with other processes. Add, AddBatch and Delete fail.
+// Legacy compressed indexes must be opened once with New to be upgraded.
+func OpenReadOnly(path string, dimension int) (*Index, error) {
+	if path == "" {
+		return nil, errors.New("hnsw: path cannot be empty")
+	}
+	if dimension <= 0 {
+		return nil, errors.New("hnsw: dimension must be positive")
+	}
+
+	cpath := C.CString(path)
+	defer C.free(unsafe.Pointer(cpath))
+
+	idx := C.hnsw_open_readonly(cpath, C.int(dimension))
+	if idx == nil {
+		return nil, errors.New("hnsw: failed to open index read-only")
+	}
+
+	return &Index{
+		idx:       idx,
+		path:      path,
+		dimension: dimension,
+		readOnly:  true,
+	}, nil
+}
+
 // Add inserts a vector for the given chunk ID.
 func (idx *Index) Add(_ context.Context, chunkID string, embedding []float32) error {
-	idx.mu.Lock()
-	defer idx.mu.Unlock()
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
 
 	if idx.idx == nil {
 		return errors.New("hnsw: index is closed")
 	}
+	if idx.readOnly {
+		return errReadOnly
+	}
 
 	if len(embedding) != idx.dimension {
 		return errors.New("hnsw: embedding dimension mismatch")
@@ -111,14 +276,105 @@ func (idx *Index) Add(_ context.Context, chunkID string, embedding []float32) er
 	return nil
 }
 
+// AddBatch inserts vectors for many chunk IDs in a single native call.
+// Graph construction is spread across all available cores.
+func (idx *Index) AddBatch(_ context.Context, chunkIDs []string, embeddings [][]float32) error {
+	return idx.addBatch(chunkIDs, embeddings, nil)
+}
+
+// AddBatchWithAttributes inserts vectors like AddBatch and stores the source
+// and document of each one for filtered searches.
+func (idx *Index) AddBatchWithAttributes(
+	_ context.Context, chunkIDs []string, embeddings [][]float32, attrs []driven.VectorAttributes,
+) error {
+	if len(attrs) != len(chunkIDs) {
+		return errors.New("hnsw: chunk ID and attribute counts differ")
+	}
+	return idx.addBatch(chunkIDs, embeddings, attrs)
+}
+
+// addBatch inserts vectors with optional attributes (attrs may be nil).
+func (idx *Index) addBatch(chunkIDs []string, embeddings [][]float32, attrs []driven.VectorAttributes) error {
+	if len(chunkIDs) != len(embeddings) {
+		return errors.New("hnsw: chunk ID and embedding counts differ")
+	}
+	if len(chunkIDs) == 0 {
+		return nil
+	}
+
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return errors.New("hnsw: index is closed")
+	}
+	if idx.readOnly {
+		return errReadOnly
+	}
+
+	// Flatten embeddings into one contiguous buffer
+	vectors := make([]float32, 0, len(embeddings)*idx.dimension)
+	for _, embedding := range embeddings {
+		if len(embedding) != idx.dimension {
+			return errors.New("hnsw: embedding dimension mismatch")
+		}
+		vectors = append(vectors, embedding...)
+	}
+
+	cIDs := make([]*C.char, len(chunkIDs))
+	for i, id := range chunkIDs {
+		cIDs[i] = C.CString(id)
+	}
+	defer func() {
+		for _, cID := range cIDs {
+			C.free(unsafe.Pointer(cID))
+		}
+	}()
+
+	var cAttrs *C.HnswAttributes
+	if attrs != nil {
+		list := make([]C.HnswAttributes, len(attrs))
+		for i, a := range attrs {
+			list[i].source_id = cStringOrNil(a.SourceID)
+			list[i].document_id = cStringOrNil(a.DocumentID)
+		}
+		defer func() {
+			for i := range list {
+				C.free(unsafe.Pointer(list[i].source_id))
+				C.free(unsafe.Pointer(list[i].document_id))
+			}
+		}()
+		cAttrs = &list[0]
+	}
+
+	result := C.hnsw_add_batch_ex(
+		idx.idx,
+		(**C.char)(unsafe.Pointer(&cIDs[0])),
+		(*C.float)(unsafe.Pointer(&vectors[0])),
+		C.int(len(chunkIDs)),
+		C.int(idx.dimension),
+		C.int(0), // use all hardware threads
+		cAttrs,
+	)
+
+	if result != 0 {
+		return errors.New("hnsw: failed to add vectors")
+	}
+
+	return nil
+}
+
 // Delete removes a vector from the index.
 func (idx *Index) Delete(_ context.Context, chunkID string) error {
-	idx.mu.Lock()
-	defer idx.mu.Unlock()
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
 
 	if idx.idx == nil {
 		return errors.New("hnsw: index is closed")
 	}
+	if idx.readOnly {
+		return errReadOnly
+	}
 
 	cChunkID := C.CString(chunkID)
 	defer C.free(unsafe.Pointer(cChunkID))
@@ -132,7 +388,25 @@ func (idx *Index) Delete(_ context.Context, chunkID string) error {
 }
 
 // Search finds the k nearest neighbours to the query vector.
-func (idx *Index) Search(_ context.Context, query []float32, k int) ([]driven.VectorHit, error) {
+func (idx *Index) Search(ctx context.Context, query []float32, k int) ([]driven.VectorHit, error) {
+	return idx.SearchWithOptions(ctx, query, k, SearchOptions{})
+}
+
+// SearchFiltered finds the k nearest neighbours that pass the filter. The
+// filter is evaluated while traversing the graph, so no over-fetching is
+// needed to end up with k eligible hits.
+func (idx *Index) SearchFiltered(
+	ctx context.Context, query []float32, k int, filter driven.VectorFilter,
+) ([]driven.VectorHit, error) {
+	return idx.SearchWithOptions(ctx, query, k, SearchOptions{Filter: &filter})
+}
+
+// SearchWithOptions finds the k nearest neighbours using per-call options,
+// e.g. a larger ef for recall-sensitive searches. Options only affect this
+// call and are safe to vary across concurrent searches.
+func (idx *Index) SearchWithOptions(
+	_ context.Context, query []float32, k int, opts SearchOptions,
+) ([]driven.VectorHit, error) {
 	idx.mu.RLock()
 	defer idx.mu.RUnlock()
 
@@ -148,40 +422,361 @@ func (idx *Index) Search(_ context.Context, query []float32, k int) ([]driven.Ve
 		return nil, nil
 	}
 
-	var results *C.HnswSearchResult
-	count := C.hnsw_search(
+	options := C.HnswSearchOptions{
+		ef:            C.int(opts.Ef),
+		rerank_factor: C.int(opts.RerankFactor),
+	}
+	if opts.Filter != nil {
+		filter := newCFilter(opts.Filter)
+		defer freeCFilter(filter)
+		options.filter = filter
+	}
+
+	return idx.searchInto(query, k, &options)
+}
+
+// newCFilter copies filter into C memory. The filter and its ID arrays are
+// reached through pointers, which cgo does not allow in Go memory passed to C.
+func newCFilter(filter *driven.VectorFilter) *C.HnswFilter {
+	f := (*C.HnswFilter)(C.calloc(1, C.size_t(unsafe.Sizeof(C.HnswFilter{}))))
+	f.source_ids = cStringArray(filter.SourceIDs)
+	f.num_source_ids = C.int(len(filter.SourceIDs))
+	f.document_ids = cStringArray(filter.DocumentIDs)
+	f.num_document_ids = C.int(len(filter.DocumentIDs))
+	if filter.Exclude {
+		f.exclude = 1
+	}
+	return f
+}
+
+// freeCFilter releases a filter allocated by newCFilter.
+func freeCFilter(f *C.HnswFilter) {
+	freeCStringArray(f.source_ids, int(f.num_source_ids))
+	freeCStringArray(f.document_ids, int(f.num_document_ids))
+	C.free(unsafe.Pointer(f))
+}
+
+// cStringArray copies values into a C array of C strings (NULL if empty).
+func cStringArray(values []string) **C.char {
+	if len(values) == 0 {
+		return nil
+	}
+	ptrSize := unsafe.Sizeof((*C.char)(nil))
+	array := (**C.char)(C.malloc(C.size_t(uintptr(len(values)) * ptrSize)))
+	elems := unsafe.Slice(array, len(values))
+	for i, v := range values {
+		elems[i] = C.CString(v)
+	}
+	return array
+}
+
+// freeCStringArray releases an array allocated by cStringArray.
+func freeCStringArray(array **C.char, n int) {
+	if array == nil {
+		return
+	}
+	for _, v := range unsafe.Slice(array, n) {
+		C.free(unsafe.Pointer(v))
+	}
+	C.free(unsafe.Pointer(array))
+}
+
+// cStringOrNil returns a C copy of s, or nil if s is empty.
+func cStringOrNil(s string) *C.char {
+	if s == "" {
+		return nil
+	}
+	return C.CString(s)
+}
+
+// NativeSearch is the native search entry point of an open index, as C
+// pointers, for native components that search the index directly (the fused
+// hybrid engine in cgo/hybrid) instead of through Go.
+type NativeSearch struct {
+	// Index is the HnswIndex handle.
+	Index unsafe.Pointer
+	// Search is hnsw_search_visit.
+	Search unsafe.Pointer
+	// Options is the HnswSearchOptions for the search (nil = index defaults).
+	Options unsafe.Pointer
+	// Dimension is the vector dimension of the index.
+	Dimension int
+}
+
+// AcquireNative returns the native search entry point for searches with opts.
+// The index cannot be closed until release is called, which also frees the
+// native options; the pointers must not be used after that.
+func (idx *Index) AcquireNative(opts SearchOptions) (native NativeSearch, release func(), err error) {
+	idx.mu.RLock()
+
+	if idx.idx == nil {
+		idx.mu.RUnlock()
+		return NativeSearch{}, nil, errors.New("hnsw: index is closed")
+	}
+
+	native = NativeSearch{
+		Index:     unsafe.Pointer(idx.idx),
+		Search:    unsafe.Pointer(C.hnsw_search_visit),
+		Dimension: idx.dimension,
+	}
+
+	// Options are read on a native thread, so they live in C memory
+	var options *C.HnswSearchOptions
+	if opts != (SearchOptions{}) {
+		options = (*C.HnswSearchOptions)(C.calloc(1, C.size_t(unsafe.Sizeof(C.HnswSearchOptions{}))))
+		options.ef = C.int(opts.Ef)
+		options.rerank_factor = C.int(opts.RerankFactor)
+		if opts.Filter != nil {
+			options.filter = newCFilter(opts.Filter)
+		}
+		native.Options = unsafe.Pointer(options)
+	}
+
+	release = func() {
+		if options != nil {
+			if options.filter != nil {
+				freeCFilter(options.filter)
+			}
+			C.free(unsafe.Pointer(options))
+		}
+		idx.mu.RUnlock()
+	}
+	return native, release, nil
+}
+
+// SearchBatch finds the k nearest neighbours for each query vector in a single
+// native call. Queries run in parallel; results are returned per query, in order.
+func (idx *Index) SearchBatch(_ context.Context, queries [][]float32, k int) ([][]driven.VectorHit, error) {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return nil, errors.New("hnsw: index is closed")
+	}
+
+	if len(queries) == 0 || k <= 0 {
+		return make([][]driven.VectorHit, len(queries)), nil
+	}
+
+	// Flatten queries into one contiguous buffer
+	flat := make([]float32, 0, len(queries)*idx.dimension)
+	for _, query := range queries {
+		if len(query) != idx.dimension {
+			return nil, errors.New("hnsw: query dimension mismatch")
+		}
+		flat = append(flat, query...)
+	}
+
+	var results C.HnswBatchResults
+	rc := C.hnsw_search_batch(
 		idx.idx,
-		(*C.float)(unsafe.Pointer(&query[0])),
+		(*C.float)(unsafe.Pointer(&flat[0])),
+		C.int(len(queries)),
 		C.int(idx.dimension),
 		C.int(k),
+		C.int(0), // use all hardware threads
 		&results,
 	)
 
-	if count < 0 {
-		return nil, errors.New("hnsw: search failed")
+	if rc != 0 {
+		return nil, errors.New("hnsw: batch search failed")
 	}
 
-	if count == 0 || results == nil {
-		return nil, nil
-	}
+	defer C.hnsw_free_batch_results(&results)
 
-	defer C.hnsw_free_results(results, count)
-
-	// Convert C results to Go slice
-	hits := make([]driven.VectorHit, int(count))
-	cResults := unsafe.Slice(results, int(count))
+	offsets := unsafe.Slice(results.offsets, len(queries)+1)
+	total := int(offsets[len(queries)])
+	var chunkIDs []*C.char
+	var similarities []C.float
+	if total > 0 {
+		chunkIDs = unsafe.Slice(results.chunk_ids, total)
+		similarities = unsafe.Slice(results.similarities, total)
+	}
 
-	for i := 0; i < int(count); i++ {
-		hits[i] = driven.VectorHit{
-			ChunkID:    C.GoString(cResults[i].chunk_id),
-			Similarity: float64(cResults[i].similarity),
+	hits := make([][]driven.VectorHit, len(queries))
+	for q := range queries {
+		begin, end := int(offsets[q]), int(offsets[q+1])
+		if begin == end {
+			continue
+		}
+		hits[q] = make([]driven.VectorHit, 0, end-begin)
+		for i := begin; i < end; i++ {
+			hits[q] = append(hits[q], driven.VectorHit{
+				ChunkID:    C.GoString(chunkIDs[i]),
+				Similarity: float64(similarities[i]),
+			})
 		}
 	}
 
 	return hits, nil
 }
 
-// Close releases resources.
+// SetEfSearch changes the default search beam width.
+func (idx *Index) SetEfSearch(ef int) error {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return errors.New("hnsw: index is closed")
+	}
+
+	if C.hnsw_set_ef(idx.idx, C.int(ef)) != 0 {
+		return errors.New("hnsw: invalid ef")
+	}
+
+	return nil
+}
+
+// Compact rebuilds the index from its live vectors, dropping the tombstones
+// left by deletes and updates, and checkpoints the result. Searches keep
+// running against the old graph during the rebuild. It returns the number of
+// bytes of graph memory reclaimed.
+func (idx *Index) Compact(_ context.Context) (int64, error) {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return 0, errors.New("hnsw: index is closed")
+	}
+	if idx.readOnly {
+		return 0, errReadOnly
+	}
+
+	var reclaimed C.int64_t
+	if C.hnsw_compact(idx.idx, 0, &reclaimed) != 0 {
+		return 0, errors.New("hnsw: compaction failed")
+	}
+
+	return int64(reclaimed), nil
+}
+
+// Checkpoint writes a full snapshot of the index and truncates its
+// write-ahead log. Adds and deletes are already durable when they return;
+// checkpointing bounds the log size and the replay work done on open.
+func (idx *Index) Checkpoint(_ context.Context) error {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return errors.New("hnsw: index is closed")
+	}
+	if idx.readOnly {
+		return errReadOnly
+	}
+
+	if C.hnsw_checkpoint(idx.idx) != 0 {
+		return errors.New("hnsw: checkpoint failed")
+	}
+
+	return nil
+}
+
+// StartBackgroundFlush starts a maintenance thread that syncs the
+// write-ahead log and checkpoints off the add and delete path. Adds and
+// deletes survive a process crash when they return; they survive a power
+// loss once a round has run or Flush returns. A running schedule is
+// replaced.
+func (idx *Index) StartBackgroundFlush(opts FlushOptions) error {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return errors.New("hnsw: index is closed")
+	}
+	if idx.readOnly {
+		return errReadOnly
+	}
+
+	cOpts := C.HnswFlushOptions{
+		interval_ms:   C.int(opts.Interval.Milliseconds()),
+		max_unsynced:  C.int(opts.MaxUnsynced),
+		max_log_bytes: C.int64_t(opts.MaxLogBytes),
+	}
+	if C.hnsw_set_background_flush(idx.idx, &cOpts) != 0 {
+		return errors.New("hnsw: failed to start background flush")
+	}
+
+	return nil
+}
+
+// StopBackgroundFlush stops the maintenance thread, syncing the log first.
+func (idx *Index) StopBackgroundFlush() error {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return errors.New("hnsw: index is closed")
+	}
+	if idx.readOnly {
+		return nil
+	}
+
+	if C.hnsw_set_background_flush(idx.idx, nil) != 0 {
+		return errors.New("hnsw: failed to stop background flush")
+	}
+
+	return nil
+}
+
+// Flush makes every add and delete that has returned durable on stable
+// storage before it returns.
+func (idx *Index) Flush(_ context.Context) error {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return errors.New("hnsw: index is closed")
+	}
+
+	if C.hnsw_flush(idx.idx) != 0 {
+		return errors.New("hnsw: flush failed")
+	}
+
+	return nil
+}
+
+// Stats returns the index sizes and counters.
+func (idx *Index) Stats() (Stats, error) {
+	idx.mu.RLock()
+	defer idx.mu.RUnlock()
+
+	if idx.idx == nil {
+		return Stats{}, errors.New("hnsw: index is closed")
+	}
+
+	var s C.HnswStats
+	if C.hnsw_stats(idx.idx, &s) != 0 {
+		return Stats{}, errors.New("hnsw: failed to read stats")
+	}
+
+	stats := Stats{
+		LiveElements:         uint64(s.live_elements),
+		DeletedElements:      uint64(s.deleted_elements),
+		MaxElements:          uint64(s.max_elements),
+		Resizes:              uint64(s.resize_count),
+		UnsourcedElements:    uint64(s.unsourced_elements),
+		VectorBytes:          uint64(s.vector_bytes),
+		GraphBytes:           uint64(s.graph_bytes),
+		MappingBytes:         uint64(s.mapping_bytes),
+		WALBytes:             uint64(s.wal_bytes),
+		Searches:             uint64(s.searches),
+		DistanceComputations: uint64(s.distance_computations),
+		SearchTime:           time.Duration(s.search_ns),
+		LockWaits:            uint64(s.lock_waits),
+		ReadLockWait:         time.Duration(s.read_wait_ns),
+		ExclusiveLockWait:    time.Duration(s.exclusive_wait_ns),
+		WriterWait:           time.Duration(s.writer_wait_ns),
+	}
+	for i := range stats.DistanceHistogram {
+		stats.DistanceHistogram[i] = uint64(s.distance_histogram[i])
+		stats.LatencyHistogram[i] = uint64(s.latency_histogram[i])
+	}
+
+	return stats, nil
+}
+
+// Close releases resources. The write-ahead log is folded into the snapshot
+// first once it has grown to half the snapshot size.
 func (idx *Index) Close() error {
 	idx.mu.Lock()
 	defer idx.mu.Unlock()
@@ -190,6 +785,7 @@ func (idx *Index) Close() error {
 		C.hnsw_close(idx.idx)
 		idx.idx = nil
 	}
+	idx.buffers.close()
 
 	return nil
 }
@@ -0,0 +1,355 @@
+/*
+ * hnsw_ids.cpp - Compact chunk ID table for the HNSW wrapper
+ *
+ * Serialized block: four uint64 counts (labels, hash slots, arena bytes,
+ * mapped IDs), the label spans (uint64 each), the hash slots (uint64 each),
+ * then the arena, zero-padded to a multiple of 8 bytes. The slot hash is
+ * computed here rather than by std::hash, so a persisted table stays valid
+ * across builds. Lookups probe linearly; erase shifts the following entries
+ * back instead of leaving tombstones, so probe runs never degrade.
+ */
+
+#include "hnsw_ids.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+static const size_t kBlockHeaderSize = 4 * sizeof(uint64_t);
+static const size_t kMinSlots = 16;
+static const uint64_t kMaxLabel = UINT32_MAX - 1;     // Slots store label + 1 in 32 bits
+static const uint64_t kMaxArenaSize = uint64_t{1} << 40;  // Span offsets are 40 bits
+static const size_t kCompactMinDeadBytes = 64 * 1024;
+
+// Stable 64-bit hash: FNV-1a finished with the murmur3 mixer so the high
+// bits (used for both the tag and the probe start) are well distributed.
+static uint64_t hash_id(std::string_view id) {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : id) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint32_t slot_tag(uint64_t slot) {
+    return static_cast<uint32_t>(slot >> 32);
+}
+
+static uint64_t slot_label(uint64_t slot) {
+    return (slot & UINT32_MAX) - 1;
+}
+
+static size_t padded(size_t n) {
+    return (n + 7) & ~size_t{7};
+}
+
+ChunkIdTable& ChunkIdTable::operator=(ChunkIdTable&& other) noexcept {
+    ChunkIdTable moved(std::move(other));
+    swap(moved);
+    return *this;
+}
+
+bool ChunkIdTable::matches(uint64_t slot, uint32_t tag, std::string_view id) const {
+    return slot_tag(slot) == tag && this->id(slot_label(slot)) == id;
+}
+
+bool ChunkIdTable::find(std::string_view id, uint64_t* label) const {
+    if (num_slots_ == 0 || id.empty()) {
+        return false;
+    }
+    uint64_t hash = hash_id(id);
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    size_t mask = num_slots_ - 1;
+    for (size_t i = probe_start(hash >> 32), n = 0; n < num_slots_; i = (i + 1) & mask, n++) {
+        uint64_t slot = slots_[i];
+        if (slot == 0) {
+            return false;
+        }
+        if (matches(slot, tag, id)) {
+            *label = slot_label(slot);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ChunkIdTable::assign(uint64_t label, std::string_view id) {
+    ensure_mutable();
+    if (id.empty()) {
+        return false;
+    }
+    if (id.size() > kMaxIdLength) {
+        throw std::length_error("chunk ID too long");
+    }
+    if (label > kMaxLabel) {
+        throw std::length_error("label out of range");
+    }
+    uint64_t existing;
+    if (find(id, &existing)) {
+        return existing == label;
+    }
+    if (arena_store_.size() + id.size() > kMaxArenaSize) {
+        throw std::length_error("chunk ID arena full");
+    }
+
+    erase(label);
+    resize(label + 1);
+    uint64_t offset = arena_store_.size();
+    arena_store_.insert(arena_store_.end(), id.begin(), id.end());
+    span_store_[label] = offset << kLengthBits | id.size();
+    sync();
+    insert_slot(hash_id(id), label);
+    live_++;
+    return true;
+}
+
+void ChunkIdTable::erase(uint64_t label) {
+    ensure_mutable();
+    size_t length = id(label).size();
+    if (length == 0) {
+        return;
+    }
+    remove_slot(label);
+    span_store_[label] = 0;
+    live_--;
+    dead_bytes_ += length;
+    if (dead_bytes_ >= kCompactMinDeadBytes && dead_bytes_ > arena_size_ / 2) {
+        compact_arena();
+    }
+}
+
+void ChunkIdTable::resize(size_t labels) {
+    ensure_mutable();
+    if (labels > span_store_.size()) {
+        span_store_.resize(labels, 0);
+        sync();
+    }
+}
+
+void ChunkIdTable::reserve(size_t labels, size_t id_bytes) {
+    ensure_mutable();
+    span_store_.reserve(labels);
+    arena_store_.reserve(id_bytes);
+    size_t slots = std::max(num_slots_, kMinSlots);
+    while (labels * 4 > slots * 3) {
+        slots *= 2;
+    }
+    if (slots != num_slots_) {
+        rehash(slots);
+    }
+    sync();
+}
+
+void ChunkIdTable::clear() {
+    ChunkIdTable empty;
+    swap(empty);
+}
+
+size_t ChunkIdTable::memory_bytes() const {
+    return span_store_.capacity() * sizeof(uint64_t) + slot_store_.capacity() * sizeof(uint64_t) +
+           arena_store_.capacity();
+}
+
+// Helper: insert label into the hash table, growing it past 3/4 full
+void ChunkIdTable::insert_slot(uint64_t hash, uint64_t label) {
+    if ((live_ + 1) * 4 > num_slots_ * 3) {
+        rehash(std::max(kMinSlots, num_slots_ * 2));
+    }
+    size_t mask = num_slots_ - 1;
+    size_t i = probe_start(hash >> 32);
+    while (slot_store_[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    slot_store_[i] = (hash >> 32) << 32 | (label + 1);
+}
+
+// Helper: remove the slot of a mapped label, shifting later entries of the
+// probe run back into the hole
+void ChunkIdTable::remove_slot(uint64_t label) {
+    size_t mask = num_slots_ - 1;
+    size_t i = probe_start(hash_id(id(label)) >> 32);
+    while (slot_store_[i] != 0 && slot_label(slot_store_[i]) != label) {
+        i = (i + 1) & mask;
+    }
+    if (slot_store_[i] == 0) {
+        return;  // Not indexed (cannot happen for a consistent table)
+    }
+
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask; slot_store_[j] != 0; j = (j + 1) & mask) {
+        size_t home = probe_start(slot_tag(slot_store_[j]));
+        // An entry stays put if its home lies cyclically in (hole, j]
+        bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (!stays) {
+            slot_store_[hole] = slot_store_[j];
+            hole = j;
+        }
+    }
+    slot_store_[hole] = 0;
+}
+
+// Helper: rebuild the hash table with the given number of slots. Probe
+// starts come from the stored tags, so no ID is rehashed.
+void ChunkIdTable::rehash(size_t slots) {
+    std::vector<uint64_t> old;
+    old.swap(slot_store_);
+    slot_store_.assign(slots, 0);
+    sync();
+    size_t mask = slots - 1;
+    for (uint64_t slot : old) {
+        if (slot == 0) {
+            continue;
+        }
+        size_t i = probe_start(slot_tag(slot));
+        while (slot_store_[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        slot_store_[i] = slot;
+    }
+}
+
+// Helper: drop the bytes of erased IDs from the arena
+void ChunkIdTable::compact_arena() {
+    std::vector<char> arena;
+    arena.reserve(arena_store_.size() - dead_bytes_);
+    for (size_t label = 0; label < span_store_.size(); label++) {
+        std::string_view value = id(label);
+        uint64_t offset = arena.size();
+        arena.insert(arena.end(), value.begin(), value.end());
+        span_store_[label] = value.empty() ? 0 : offset << kLengthBits | value.size();
+    }
+    arena_store_.swap(arena);
+    dead_bytes_ = 0;
+    sync();
+}
+
+void ChunkIdTable::ensure_mutable() const {
+    if (attached_) {
+        throw std::logic_error("chunk ID table is read-only");
+    }
+}
+
+void ChunkIdTable::sync() {
+    spans_ = span_store_.data();
+    slots_ = slot_store_.data();
+    arena_ = arena_store_.data();
+    num_labels_ = span_store_.size();
+    num_slots_ = slot_store_.size();
+    arena_size_ = arena_store_.size();
+}
+
+bool ChunkIdTable::write(std::ostream& out) const {
+    uint64_t arena = 0;
+    for (size_t label = 0; label < num_labels_; label++) {
+        arena += id(label).size();
+    }
+    const uint64_t header[4] = {num_labels_, num_slots_, arena, live_};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    // Spans are renumbered as if the arena held only live IDs, in label order
+    uint64_t offset = 0;
+    uint64_t chunk[512];
+    size_t filled = 0;
+    for (size_t label = 0; label < num_labels_; label++) {
+        uint64_t length = id(label).size();
+        chunk[filled++] = length == 0 ? 0 : offset << kLengthBits | length;
+        offset += length;
+        if (filled == sizeof(chunk) / sizeof(chunk[0])) {
+            out.write(reinterpret_cast<const char*>(chunk), sizeof(chunk));
+            filled = 0;
+        }
+    }
+    out.write(reinterpret_cast<const char*>(chunk), filled * sizeof(chunk[0]));
+
+    // Slots name labels, not offsets, so they are written as they are
+    out.write(reinterpret_cast<const char*>(slots_), num_slots_ * sizeof(uint64_t));
+
+    for (size_t label = 0; label < num_labels_; label++) {
+        std::string_view value = id(label);
+        out.write(value.data(), value.size());
+    }
+    static const char zeros[8] = {};
+    out.write(zeros, padded(offset) - offset);
+    return out.good();
+}
+
+bool ChunkIdTable::load(const char* data, size_t size, size_t* consumed) {
+    return parse(data, size, consumed, true);
+}
+
+bool ChunkIdTable::attach(const char* data, size_t size, size_t* consumed) {
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0) {
+        return false;
+    }
+    return parse(data, size, consumed, false);
+}
+
+bool ChunkIdTable::parse(const char* data, size_t size, size_t* consumed, bool copy) {
+    if (size < kBlockHeaderSize) {
+        return false;
+    }
+    uint64_t header[4];
+    std::memcpy(header, data, sizeof(header));
+    const uint64_t labels = header[0], slots = header[1], arena = header[2];
+    if ((slots & (slots - 1)) != 0 || labels > kMaxLabel + 1 || slots > (size_t{1} << 40) ||
+        arena > kMaxArenaSize) {
+        return false;
+    }
+    const size_t spans_at = kBlockHeaderSize;
+    const size_t slots_at = spans_at + labels * sizeof(uint64_t);
+    const size_t arena_at = slots_at + slots * sizeof(uint64_t);
+    const size_t end = arena_at + padded(arena);
+    if (end > size) {
+        return false;
+    }
+
+    clear();
+    if (copy) {
+        span_store_.resize(labels);
+        slot_store_.resize(slots);
+        arena_store_.resize(arena);
+        std::memcpy(span_store_.data(), data + spans_at, labels * sizeof(uint64_t));
+        std::memcpy(slot_store_.data(), data + slots_at, slots * sizeof(uint64_t));
+        std::memcpy(arena_store_.data(), data + arena_at, arena);
+        sync();
+        // Inserts rely on the live count to keep a free slot, so recount it
+        // rather than trusting the header
+        live_ = static_cast<size_t>(std::count_if(slot_store_.begin(), slot_store_.end(),
+                                                  [](uint64_t slot) { return slot != 0; }));
+        if (live_ * 4 > num_slots_ * 3) {
+            rehash(num_slots_ * 2);
+        }
+    } else {
+        spans_ = reinterpret_cast<const uint64_t*>(data + spans_at);
+        slots_ = reinterpret_cast<const uint64_t*>(data + slots_at);
+        arena_ = data + arena_at;
+        num_labels_ = labels;
+        num_slots_ = slots;
+        arena_size_ = arena;
+        live_ = header[3];
+        attached_ = true;
+    }
+    *consumed = end;
+    return true;
+}
+
+void ChunkIdTable::swap(ChunkIdTable& other) noexcept {
+    std::swap(spans_, other.spans_);
+    std::swap(slots_, other.slots_);
+    std::swap(arena_, other.arena_);
+    std::swap(num_labels_, other.num_labels_);
+    std::swap(num_slots_, other.num_slots_);
+    std::swap(arena_size_, other.arena_size_);
+    std::swap(live_, other.live_);
+    std::swap(dead_bytes_, other.dead_bytes_);
+    std::swap(attached_, other.attached_);
+    span_store_.swap(other.span_store_);
+    slot_store_.swap(other.slot_store_);
+    arena_store_.swap(other.arena_store_);
+}
@@ -0,0 +1,710 @@
+/*
+ * hnsw_kernels.cpp - SIMD kernels for HNSW vector storage
+ *
+ * Each kernel has a portable scalar version plus AVX2 (with FMA/F16C) and
+ * AVX-512 versions on x86, compiled via target attributes so the library
+ * itself needs no -march flag, and a NEON version on AArch64 (baseline).
+ * hnsw_kernels() picks the widest set the running CPU supports.
+ */
+
+#include "hnsw_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SERCHA_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define SERCHA_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// =============================================================================
+// Scalar kernels
+// =============================================================================
+
+static float dot_f32_scalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static float dot_f16_scalar(const uint16_t* a, const uint16_t* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += half_to_float(a[i]) * half_to_float(b[i]);
+    }
+    return sum;
+}
+
+static int32_t dot_i8_scalar(const int8_t* a, const int8_t* b, size_t n) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    }
+    return sum;
+}
+
+static float dot_f16_f32_scalar(const uint16_t* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += half_to_float(a[i]) * b[i];
+    }
+    return sum;
+}
+
+static float dot_i8_f32_scalar(const int8_t* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += static_cast<float>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+// Helper: factor scaling a vector with the given squared norm to unit length
+// (1 for a zero vector, which is left as it is)
+static float inverse_norm(float sum_sq) {
+    float norm = std::sqrt(sum_sq);
+    return norm > 0.0f ? 1.0f / norm : 1.0f;
+}
+
+// Helper: round to nearest even without a libm call (|v| < 2^22, default
+// rounding mode)
+static inline float round_even(float v) {
+    const float magic = 12582912.0f;  // 1.5 * 2^23
+    return (v + magic) - magic;
+}
+
+static void scale_scalar(const float* in, float factor, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = in[i] * factor;
+    }
+}
+
+static void normalize_scalar(const float* in, float* out, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += in[i] * in[i];
+    }
+    scale_scalar(in, inverse_norm(sum), out, n);
+}
+
+static void f32_to_f16_scalar(const float* in, uint16_t* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = float_to_half(in[i]);
+    }
+}
+
+static void f16_to_f32_scalar(const uint16_t* in, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = half_to_float(in[i]);
+    }
+}
+
+// Helper: int8 scale for a vector whose largest magnitude is max_abs, and
+// the factor mapping values to codes
+static float int8_scale(float max_abs, float* inv_scale) {
+    *inv_scale = max_abs > 0.0f ? 127.0f / max_abs : 0.0f;
+    return max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+}
+
+static void quantize_codes_scalar(const float* in, float inv_scale, int8_t* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float v = std::max(-127.0f, std::min(127.0f, in[i] * inv_scale));
+        out[i] = static_cast<int8_t>(round_even(v));
+    }
+}
+
+static float quantize_i8_scalar(const float* in, int8_t* out, size_t n) {
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        max_abs = std::max(max_abs, std::fabs(in[i]));
+    }
+    float inv_scale;
+    float scale = int8_scale(max_abs, &inv_scale);
+    quantize_codes_scalar(in, inv_scale, out, n);
+    return scale;
+}
+
+static void dequantize_i8_scalar(const int8_t* in, float scale, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = static_cast<float>(in[i]) * scale;
+    }
+}
+
+#if defined(SERCHA_KERNELS_X86)
+
+// =============================================================================
+// AVX2 + FMA + F16C kernels
+// =============================================================================
+
+#define SERCHA_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#define SERCHA_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,fma,f16c")))
+
+SERCHA_TARGET_AVX2
+static inline float hsum256_ps(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x1));
+    return _mm_cvtss_f32(lo);
+}
+
+SERCHA_TARGET_AVX2
+static inline int32_t hsum256_epi32(__m256i v) {
+    __m128i lo = _mm256_castsi256_si128(v);
+    __m128i hi = _mm256_extracti128_si256(v, 1);
+    lo = _mm_add_epi32(lo, hi);
+    lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, 0x4E));
+    lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, 0xB1));
+    return _mm_cvtsi128_si32(lo);
+}
+
+SERCHA_TARGET_AVX2
+static float dot_f32_avx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float sum = hsum256_ps(_mm256_add_ps(acc0, acc1));
+    return sum + dot_f32_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX2
+static float dot_f16_avx2(const uint16_t* a, const uint16_t* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256 b0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        __m256 a1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 8)));
+        __m256 b1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 8)));
+        acc0 = _mm256_fmadd_ps(a0, b0, acc0);
+        acc1 = _mm256_fmadd_ps(a1, b1, acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 a0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256 b0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc0 = _mm256_fmadd_ps(a0, b0, acc0);
+    }
+    float sum = hsum256_ps(_mm256_add_ps(acc0, acc1));
+    return sum + dot_f16_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX2
+static int32_t dot_i8_avx2(const int8_t* a, const int8_t* b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+    return hsum256_epi32(acc) + dot_i8_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX2
+static float dot_f16_f32_avx2(const uint16_t* a, const float* b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        acc = _mm256_fmadd_ps(va, _mm256_loadu_ps(b + i), acc);
+    }
+    return hsum256_ps(acc) + dot_f16_f32_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX2
+static float dot_i8_f32_avx2(const int8_t* a, const float* b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i));
+        __m256 va = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+        acc = _mm256_fmadd_ps(va, _mm256_loadu_ps(b + i), acc);
+    }
+    return hsum256_ps(acc) + dot_i8_f32_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX2
+static inline float hmax256_ps(__m256 v) {
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 0x1));
+    return _mm_cvtss_f32(m);
+}
+
+SERCHA_TARGET_AVX2
+static void normalize_avx2(const float* in, float* out, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 v0 = _mm256_loadu_ps(in + i);
+        __m256 v1 = _mm256_loadu_ps(in + i + 8);
+        acc0 = _mm256_fmadd_ps(v0, v0, acc0);
+        acc1 = _mm256_fmadd_ps(v1, v1, acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 v0 = _mm256_loadu_ps(in + i);
+        acc0 = _mm256_fmadd_ps(v0, v0, acc0);
+    }
+    float sum = hsum256_ps(_mm256_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        sum += in[i] * in[i];
+    }
+
+    const float factor = inverse_norm(sum);
+    const __m256 vfactor = _mm256_set1_ps(factor);
+    i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), vfactor));
+    }
+    scale_scalar(in + i, factor, out + i, n - i);
+}
+
+SERCHA_TARGET_AVX2
+static void f32_to_f16_avx2(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i),
+                                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+    f32_to_f16_scalar(in + i, out + i, n - i);
+}
+
+SERCHA_TARGET_AVX2
+static void f16_to_f32_avx2(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+    f16_to_f32_scalar(in + i, out + i, n - i);
+}
+
+// Helper: int8 codes of 8 floats, widened to int32
+SERCHA_TARGET_AVX2
+static inline __m256i codes8_avx2(const float* in, __m256 inv_scale, __m256 lo, __m256 hi) {
+    __m256 v = _mm256_mul_ps(_mm256_loadu_ps(in), inv_scale);
+    return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+}
+
+SERCHA_TARGET_AVX2
+static float quantize_i8_avx2(const float* in, int8_t* out, size_t n) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 vmax = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        vmax = _mm256_max_ps(vmax, _mm256_andnot_ps(sign, _mm256_loadu_ps(in + i)));
+    }
+    float max_abs = hmax256_ps(vmax);
+    for (; i < n; i++) {
+        max_abs = std::max(max_abs, std::fabs(in[i]));
+    }
+    float inv_scale;
+    float scale = int8_scale(max_abs, &inv_scale);
+
+    const __m256 vinv = _mm256_set1_ps(inv_scale);
+    const __m256 lo = _mm256_set1_ps(-127.0f);
+    const __m256 hi = _mm256_set1_ps(127.0f);
+    // packs works within 128-bit lanes; this restores element order
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i w01 = _mm256_packs_epi32(codes8_avx2(in + i, vinv, lo, hi),
+                                         codes8_avx2(in + i + 8, vinv, lo, hi));
+        __m256i w23 = _mm256_packs_epi32(codes8_avx2(in + i + 16, vinv, lo, hi),
+                                         codes8_avx2(in + i + 24, vinv, lo, hi));
+        __m256i b = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(w01, w23), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), b);
+    }
+    quantize_codes_scalar(in + i, inv_scale, out + i, n - i);
+    return scale;
+}
+
+SERCHA_TARGET_AVX2
+static void dequantize_i8_avx2(const int8_t* in, float scale, float* out, size_t n) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+        __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(v, vscale));
+    }
+    dequantize_i8_scalar(in + i, scale, out + i, n - i);
+}
+
+// =============================================================================
+// AVX-512 kernels
+// =============================================================================
+
+SERCHA_TARGET_AVX512
+static float dot_f32_avx512(const float* a, const float* b, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    float sum = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+    return sum + dot_f32_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static float dot_f16_avx512(const uint16_t* a, const uint16_t* b, size_t n) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        __m512 vb = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        acc = _mm512_fmadd_ps(va, vb, acc);
+    }
+    return _mm512_reduce_add_ps(acc) + dot_f16_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static int32_t dot_i8_avx512(const int8_t* a, const int8_t* b, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512i va = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        __m512i vb = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+    }
+    return _mm512_reduce_add_epi32(acc) + dot_i8_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static float dot_f16_f32_avx512(const uint16_t* a, const float* b, size_t n) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        acc = _mm512_fmadd_ps(va, _mm512_loadu_ps(b + i), acc);
+    }
+    return _mm512_reduce_add_ps(acc) + dot_f16_f32_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static float dot_i8_f32_avx512(const int8_t* a, const float* b, size_t n) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m512 va = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(bytes));
+        acc = _mm512_fmadd_ps(va, _mm512_loadu_ps(b + i), acc);
+    }
+    return _mm512_reduce_add_ps(acc) + dot_i8_f32_scalar(a + i, b + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static void normalize_avx512(const float* in, float* out, size_t n) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(in + i);
+        acc = _mm512_fmadd_ps(v, v, acc);
+    }
+    float sum = _mm512_reduce_add_ps(acc);
+    for (; i < n; i++) {
+        sum += in[i] * in[i];
+    }
+
+    const float factor = inverse_norm(sum);
+    const __m512 vfactor = _mm512_set1_ps(factor);
+    i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(in + i), vfactor));
+    }
+    scale_scalar(in + i, factor, out + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static void f32_to_f16_avx512(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i h = _mm512_cvtps_ph(_mm512_loadu_ps(in + i),
+                                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), h);
+    }
+    f32_to_f16_scalar(in + i, out + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static void f16_to_f32_avx512(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm512_storeu_ps(out + i, _mm512_cvtph_ps(h));
+    }
+    f16_to_f32_scalar(in + i, out + i, n - i);
+}
+
+SERCHA_TARGET_AVX512
+static float quantize_i8_avx512(const float* in, int8_t* out, size_t n) {
+    __m512 vmax = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        vmax = _mm512_max_ps(vmax, _mm512_abs_ps(_mm512_loadu_ps(in + i)));
+    }
+    float max_abs = _mm512_reduce_max_ps(vmax);
+    for (; i < n; i++) {
+        max_abs = std::max(max_abs, std::fabs(in[i]));
+    }
+    float inv_scale;
+    float scale = int8_scale(max_abs, &inv_scale);
+
+    const __m512 vinv = _mm512_set1_ps(inv_scale);
+    const __m512 lo = _mm512_set1_ps(-127.0f);
+    const __m512 hi = _mm512_set1_ps(127.0f);
+    i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_mul_ps(_mm512_loadu_ps(in + i), vinv);
+        __m512i q = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(v, lo), hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm512_cvtsepi32_epi8(q));
+    }
+    quantize_codes_scalar(in + i, inv_scale, out + i, n - i);
+    return scale;
+}
+
+SERCHA_TARGET_AVX512
+static void dequantize_i8_avx512(const int8_t* in, float scale, float* out, size_t n) {
+    const __m512 vscale = _mm512_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m512 v = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(bytes));
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(v, vscale));
+    }
+    dequantize_i8_scalar(in + i, scale, out + i, n - i);
+}
+
+#endif // SERCHA_KERNELS_X86
+
+#if defined(SERCHA_KERNELS_NEON)
+
+// =============================================================================
+// NEON kernels (AArch64 baseline, no runtime check needed)
+// =============================================================================
+
+static float dot_f32_neon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + dot_f32_scalar(a + i, b + i, n - i);
+}
+
+static float dot_f16_neon(const uint16_t* a, const uint16_t* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float16x8_t va = vreinterpretq_f16_u16(vld1q_u16(a + i));
+        float16x8_t vb = vreinterpretq_f16_u16(vld1q_u16(b + i));
+        acc0 = vfmaq_f32(acc0, vcvt_f32_f16(vget_low_f16(va)), vcvt_f32_f16(vget_low_f16(vb)));
+        acc1 = vfmaq_f32(acc1, vcvt_high_f32_f16(va), vcvt_high_f32_f16(vb));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + dot_f16_scalar(a + i, b + i, n - i);
+}
+
+static int32_t dot_i8_neon(const int8_t* a, const int8_t* b, size_t n) {
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t va = vld1q_s8(a + i);
+        int8x16_t vb = vld1q_s8(b + i);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_high_s8(va, vb));
+    }
+    return vaddvq_s32(acc) + dot_i8_scalar(a + i, b + i, n - i);
+}
+
+static float dot_f16_f32_neon(const uint16_t* a, const float* b, size_t n) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t va = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(a + i)));
+        acc = vfmaq_f32(acc, va, vld1q_f32(b + i));
+    }
+    return vaddvq_f32(acc) + dot_f16_f32_scalar(a + i, b + i, n - i);
+}
+
+static float dot_i8_f32_neon(const int8_t* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t wide = vmovl_s8(vld1_s8(a + i));
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(wide)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_high_s16(wide));
+        acc0 = vfmaq_f32(acc0, lo, vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, hi, vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + dot_i8_f32_scalar(a + i, b + i, n - i);
+}
+
+static void normalize_neon(const float* in, float* out, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t v0 = vld1q_f32(in + i);
+        float32x4_t v1 = vld1q_f32(in + i + 4);
+        acc0 = vfmaq_f32(acc0, v0, v0);
+        acc1 = vfmaq_f32(acc1, v1, v1);
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; i++) {
+        sum += in[i] * in[i];
+    }
+
+    const float factor = inverse_norm(sum);
+    i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(in + i), factor));
+    }
+    scale_scalar(in + i, factor, out + i, n - i);
+}
+
+static void f32_to_f16_neon(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+    }
+    f32_to_f16_scalar(in + i, out + i, n - i);
+}
+
+static void f16_to_f32_neon(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+    }
+    f16_to_f32_scalar(in + i, out + i, n - i);
+}
+
+static float quantize_i8_neon(const float* in, int8_t* out, size_t n) {
+    float32x4_t vmax = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vmax = vmaxq_f32(vmax, vabsq_f32(vld1q_f32(in + i)));
+    }
+    float max_abs = vmaxvq_f32(vmax);
+    for (; i < n; i++) {
+        max_abs = std::max(max_abs, std::fabs(in[i]));
+    }
+    float inv_scale;
+    float scale = int8_scale(max_abs, &inv_scale);
+
+    const float32x4_t lo = vdupq_n_f32(-127.0f);
+    const float32x4_t hi = vdupq_n_f32(127.0f);
+    i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t v0 = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(in + i), inv_scale), lo), hi);
+        float32x4_t v1 =
+            vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(in + i + 4), inv_scale), lo), hi);
+        int16x8_t wide =
+            vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(v0)), vqmovn_s32(vcvtnq_s32_f32(v1)));
+        vst1_s8(out + i, vqmovn_s16(wide));
+    }
+    quantize_codes_scalar(in + i, inv_scale, out + i, n - i);
+    return scale;
+}
+
+static void dequantize_i8_neon(const int8_t* in, float scale, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t wide = vmovl_s8(vld1_s8(in + i));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(wide))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(wide)), scale));
+    }
+    dequantize_i8_scalar(in + i, scale, out + i, n - i);
+}
+
+#endif // SERCHA_KERNELS_NEON
+
+// =============================================================================
+// Dispatch
+// =============================================================================
+
+static HnswKernels select_kernels() {
+#if defined(SERCHA_KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return {dot_f32_avx512,       dot_f16_avx512,    dot_i8_avx512,
+                dot_f16_f32_avx512,   dot_i8_f32_avx512, normalize_avx512,
+                f32_to_f16_avx512,    f16_to_f32_avx512, quantize_i8_avx512,
+                dequantize_i8_avx512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+        __builtin_cpu_supports("f16c")) {
+        return {dot_f32_avx2,       dot_f16_avx2,    dot_i8_avx2,
+                dot_f16_f32_avx2,   dot_i8_f32_avx2, normalize_avx2,
+                f32_to_f16_avx2,    f16_to_f32_avx2, quantize_i8_avx2,
+                dequantize_i8_avx2, "avx2"};
+    }
+#elif defined(SERCHA_KERNELS_NEON)
+    return {dot_f32_neon,       dot_f16_neon,    dot_i8_neon,
+            dot_f16_f32_neon,   dot_i8_f32_neon, normalize_neon,
+            f32_to_f16_neon,    f16_to_f32_neon, quantize_i8_neon,
+            dequantize_i8_neon, "neon"};
+#endif
+    return {dot_f32_scalar,       dot_f16_scalar,    dot_i8_scalar,
+            dot_f16_f32_scalar,   dot_i8_f32_scalar, normalize_scalar,
+            f32_to_f16_scalar,    f16_to_f32_scalar, quantize_i8_scalar,
+            dequantize_i8_scalar, "scalar"};
+}
+
+const HnswKernels& hnsw_kernels() {
+    static const HnswKernels kernels = select_kernels();
+    return kernels;
+}
+
+void hnsw_normalize_batch(const float* in, float* out, size_t count, size_t dim) {
+    const HnswKernels& kernels = hnsw_kernels();
+    for (size_t i = 0; i < count; i++) {
+        kernels.normalize(in + i * dim, out + i * dim, dim);
+    }
+}
+
+void hnsw_quantize_i8_batch(const float* in, char* out, size_t count, size_t dim) {
+    const HnswKernels& kernels = hnsw_kernels();
+    const size_t record = sizeof(float) + dim;
+    for (size_t i = 0; i < count; i++) {
+        char* rec = out + i * record;
+        float scale =
+            kernels.quantize_i8(in + i * dim, reinterpret_cast<int8_t*>(rec + sizeof(float)), dim);
+        std::memcpy(rec, &scale, sizeof(float));
+    }
+}
+
+void hnsw_dequantize_i8_batch(const char* in, float* out, size_t count, size_t dim) {
+    const HnswKernels& kernels = hnsw_kernels();
+    const size_t record = sizeof(float) + dim;
+    for (size_t i = 0; i < count; i++) {
+        const char* rec = in + i * record;
+        float scale;
+        std::memcpy(&scale, rec, sizeof(float));
+        kernels.dequantize_i8(reinterpret_cast<const int8_t*>(rec + sizeof(float)), scale,
+                              out + i * dim, dim);
+    }
+}
@@ -0,0 +1,259 @@
+//go:build cgo
+
+package hnsw
+
+/*
+#include "hnsw_wrapper.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"errors"
+	"sync"
+	"unsafe"
+
+	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
+)
+
+const (
+	// maxPooledBuffers bounds the idle result buffers kept per index.
+	maxPooledBuffers = 8
+
+	// defaultIDBytes is the initial ID arena size per hit of a buffer.
+	defaultIDBytes = 48
+
+	// maxCachedLabels bounds the interned chunk IDs kept per index; the
+	// cache starts over once it is exceeded.
+	maxCachedLabels = 1 << 16
+)
+
+// resultBuffer is a reusable result buffer for hnsw_search_into. Its arrays
+// live in C memory so native code fills them directly, and they are kept
+// across searches so a steady-state search allocates nothing natively.
+type resultBuffer struct {
+	buf    C.HnswResultBuffer
+	ids    *C.char
+	idsCap int
+	// Labels of a search still to resolve, and the hits they belong to
+	missing []uint64
+	misses  []int
+}
+
+// newResultBuffer allocates a buffer for up to capacity hits.
+func newResultBuffer(capacity int) *resultBuffer {
+	b := &resultBuffer{}
+	b.buf.capacity = C.int(capacity)
+	b.buf.similarities = (*C.float)(C.malloc(C.size_t(capacity) * C.size_t(unsafe.Sizeof(C.float(0)))))
+	b.buf.labels = (*C.uint64_t)(C.malloc(C.size_t(capacity) * C.size_t(unsafe.Sizeof(C.uint64_t(0)))))
+	b.buf.id_offsets = (*C.uint32_t)(C.malloc(C.size_t(capacity+1) * C.size_t(unsafe.Sizeof(C.uint32_t(0)))))
+	b.growIDs(capacity * defaultIDBytes)
+	return b
+}
+
+// growIDs makes room for at least n bytes of chunk IDs.
+func (b *resultBuffer) growIDs(n int) {
+	if n <= b.idsCap {
+		return
+	}
+	C.free(unsafe.Pointer(b.ids))
+	b.ids = (*C.char)(C.malloc(C.size_t(n)))
+	b.idsCap = n
+}
+
+// free releases the native arrays.
+func (b *resultBuffer) free() {
+	C.free(unsafe.Pointer(b.buf.similarities))
+	C.free(unsafe.Pointer(b.buf.labels))
+	C.free(unsafe.Pointer(b.buf.id_offsets))
+	C.free(unsafe.Pointer(b.ids))
+	*b = resultBuffer{}
+}
+
+// id returns chunk ID i of the packed IDs in the buffer's arena.
+func (b *resultBuffer) id(i int) string {
+	offsets := unsafe.Slice(b.buf.id_offsets, i+2)
+	start, end := offsets[i], offsets[i+1]
+	return C.GoStringN((*C.char)(unsafe.Add(unsafe.Pointer(b.ids), start)), C.int(end-start))
+}
+
+// bufferPool keeps idle result buffers for reuse. Buffers are only taken
+// while the index is open, so Close can free the idle ones.
+type bufferPool struct {
+	mu   sync.Mutex
+	idle []*resultBuffer
+}
+
+// get returns a buffer with room for k hits.
+func (p *bufferPool) get(k int) *resultBuffer {
+	p.mu.Lock()
+	for n := len(p.idle); n > 0; n = len(p.idle) {
+		b := p.idle[n-1]
+		p.idle = p.idle[:n-1]
+		if int(b.buf.capacity) >= k {
+			p.mu.Unlock()
+			return b
+		}
+		b.free() // Too small for this search; replaced below
+	}
+	p.mu.Unlock()
+	return newResultBuffer(k)
+}
+
+// put returns a buffer to the pool, or frees it if the pool is full.
+func (p *bufferPool) put(b *resultBuffer) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	if len(p.idle) < maxPooledBuffers {
+		p.idle = append(p.idle, b)
+		return
+	}
+	b.free()
+}
+
+// close frees all idle buffers.
+func (p *bufferPool) close() {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	for _, b := range p.idle {
+		b.free()
+	}
+	p.idle = nil
+}
+
+// labelCache interns the chunk IDs of labels returned by label-mode
+// searches, so a repeated hit reuses one Go string instead of copying its ID
+// out of native memory. Entries belong to one label generation.
+type labelCache struct {
+	mu         sync.RWMutex
+	generation uint64
+	ids        map[uint64]string
+}
+
+// fill sets the chunk IDs of hits whose labels are cached at generation and
+// records the others in b.missing and b.misses.
+func (c *labelCache) fill(generation uint64, labels []uint64, hits []driven.VectorHit, b *resultBuffer) {
+	b.missing = b.missing[:0]
+	b.misses = b.misses[:0]
+
+	c.mu.RLock()
+	defer c.mu.RUnlock()
+	for i, label := range labels {
+		id, ok := c.ids[label]
+		if !ok || c.generation != generation {
+			b.missing = append(b.missing, label)
+			b.misses = append(b.misses, i)
+			continue
+		}
+		hits[i].ChunkID = id
+	}
+}
+
+// store caches id for label at generation, dropping entries of an older
+// generation.
+func (c *labelCache) store(generation, label uint64, id string) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if generation != c.generation || c.ids == nil || len(c.ids) >= maxCachedLabels {
+		if generation < c.generation {
+			return
+		}
+		c.ids = make(map[uint64]string)
+		c.generation = generation
+	}
+	c.ids[label] = id
+}
+
+// searchInto runs a search into a pooled buffer and converts the hits,
+// resolving chunk IDs through the label cache.
+// Caller must hold idx.mu (read).
+func (idx *Index) searchInto(query []float32, k int, options *C.HnswSearchOptions) ([]driven.VectorHit, error) {
+	b := idx.buffers.get(k)
+	defer idx.buffers.put(b)
+
+	// Label mode: chunk IDs are resolved only for labels not yet cached
+	b.buf.ids = nil
+	b.buf.ids_capacity = 0
+	count := C.hnsw_search_into(idx.idx, (*C.float)(unsafe.Pointer(&query[0])), C.int(idx.dimension),
+		C.int(k), options, &b.buf)
+	if count < 0 {
+		return nil, errors.New("hnsw: search failed")
+	}
+	if count == 0 {
+		return nil, nil
+	}
+
+	n := int(count)
+	generation := uint64(b.buf.label_generation)
+	labels := unsafe.Slice((*uint64)(unsafe.Pointer(b.buf.labels)), n)
+	similarities := unsafe.Slice((*float32)(unsafe.Pointer(b.buf.similarities)), n)
+	hits := make([]driven.VectorHit, n)
+	for i := range hits {
+		hits[i].Similarity = float64(similarities[i])
+	}
+
+	idx.labels.fill(generation, labels, hits, b)
+	if len(b.missing) == 0 {
+		return hits, nil
+	}
+
+	rc := idx.resolveMissing(b, generation)
+	if rc == C.HNSW_ERR_STALE_LABELS {
+		// Labels were reassigned since the search; search again with IDs
+		return idx.searchIDsInto(b, query, k, options)
+	}
+	if rc != 0 {
+		return nil, errors.New("hnsw: resolving labels failed")
+	}
+
+	for i, label := range b.missing {
+		hits[b.misses[i]].ChunkID = b.id(i)
+		idx.labels.store(generation, label, hits[b.misses[i]].ChunkID)
+	}
+	return hits, nil
+}
+
+// resolveMissing packs the chunk IDs of b.missing into b's arena, growing it
+// if needed. Caller must hold idx.mu (read).
+func (idx *Index) resolveMissing(b *resultBuffer, generation uint64) C.int {
+	for {
+		var needed C.size_t
+		rc := C.hnsw_resolve_labels(idx.idx, (*C.uint64_t)(unsafe.Pointer(&b.missing[0])),
+			C.int(len(b.missing)), C.uint64_t(generation), b.buf.id_offsets, b.ids,
+			C.size_t(b.idsCap), &needed)
+		if rc != C.HNSW_ERR_BUFFER_TOO_SMALL {
+			return rc
+		}
+		b.growIDs(int(needed))
+	}
+}
+
+// searchIDsInto runs a search into b returning chunk IDs rather than labels.
+// Caller must hold idx.mu (read).
+func (idx *Index) searchIDsInto(b *resultBuffer, query []float32, k int,
+	options *C.HnswSearchOptions) ([]driven.VectorHit, error) {
+	for {
+		b.buf.ids = b.ids
+		b.buf.ids_capacity = C.size_t(b.idsCap)
+		count := C.hnsw_search_into(idx.idx, (*C.float)(unsafe.Pointer(&query[0])), C.int(idx.dimension),
+			C.int(k), options, &b.buf)
+		if count == C.HNSW_ERR_BUFFER_TOO_SMALL {
+			b.growIDs(int(b.buf.ids_size))
+			continue
+		}
+		if count < 0 {
+			return nil, errors.New("hnsw: search failed")
+		}
+
+		n := int(count)
+		generation := uint64(b.buf.label_generation)
+		labels := unsafe.Slice((*uint64)(unsafe.Pointer(b.buf.labels)), n)
+		similarities := unsafe.Slice((*float32)(unsafe.Pointer(b.buf.similarities)), n)
+		hits := make([]driven.VectorHit, n)
+		for i := range hits {
+			hits[i] = driven.VectorHit{ChunkID: b.id(i), Similarity: float64(similarities[i])}
+			idx.labels.store(generation, labels[i], hits[i].ChunkID)
+		}
+		return hits, nil
+	}
+}
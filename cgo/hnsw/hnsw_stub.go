@@ -4,16 +4,23 @@ package hnsw
 
 import (
 	"context"
+	"time"
+	"unsafe"
 
 	"github.com/custodia-labs/sercha-cli/internal/core/domain"
 	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
 )
 
-// Ensure Index implements the interface.
-var _ driven.VectorIndex = (*Index)(nil)
+// Ensure Index implements the interfaces.
+var (
+	_ driven.VectorIndex           = (*Index)(nil)
+	_ driven.BatchVectorIndex      = (*Index)(nil)
+	_ driven.FilterableVectorIndex = (*Index)(nil)
+)
 
-// Precision defines the storage precision for vectors.
-// Runtime operations always use float32; this only affects disk storage.
+// Precision defines the storage precision for vectors, both in memory and on
+// disk. Compressed precisions are searched directly in their compressed form;
+// int8 results are re-ranked against the float32 query.
 type Precision int
 
 const (
@@ -33,9 +40,62 @@ type Index struct {
 	precision Precision
 }
 
+// Options tunes the HNSW graph. Zero fields use the library defaults.
+type Options struct {
+	M              int
+	EfConstruction int
+	EfSearch       int
+	MaxElements    int
+}
+
+// SearchOptions overrides index defaults for a single search.
+type SearchOptions struct {
+	Ef           int
+	RerankFactor int
+	Filter       *driven.VectorFilter
+}
+
+// FlushOptions schedules background maintenance of a writable index.
+type FlushOptions struct {
+	Interval    time.Duration
+	MaxUnsynced int
+	MaxLogBytes int64
+}
+
+// StatsBuckets is the number of buckets in each Stats histogram.
+const StatsBuckets = 32
+
+// Stats reports index sizes and counters.
+type Stats struct {
+	LiveElements         uint64
+	DeletedElements      uint64
+	MaxElements          uint64
+	Resizes              uint64
+	UnsourcedElements    uint64
+	VectorBytes          uint64
+	GraphBytes           uint64
+	MappingBytes         uint64
+	WALBytes             uint64
+	Searches             uint64
+	DistanceComputations uint64
+	SearchTime           time.Duration
+	DistanceHistogram    [StatsBuckets]uint64
+	LatencyHistogram     [StatsBuckets]uint64
+	LockWaits            uint64
+	ReadLockWait         time.Duration
+	ExclusiveLockWait    time.Duration
+	WriterWait           time.Duration
+}
+
 // New creates or opens an HNSW index with the specified storage precision.
 // This is a stub for builds without CGO.
 func New(path string, dimension int, precision Precision) (*Index, error) {
+	return NewWithOptions(path, dimension, precision, Options{})
+}
+
+// NewWithOptions creates or opens an HNSW index with explicit graph options.
+// This is a stub for builds without CGO.
+func NewWithOptions(path string, dimension int, precision Precision, _ Options) (*Index, error) {
 	return &Index{
 		path:      path,
 		dimension: dimension,
@@ -43,11 +103,38 @@ func New(path string, dimension int, precision Precision) (*Index, error) {
 	}, nil
 }
 
+// IndexExists reports whether path holds the files of an index.
+// This is a stub for builds without CGO.
+func IndexExists(_ string) bool {
+	return false
+}
+
+// OpenReadOnly opens an existing index by memory-mapping it.
+// This is a stub for builds without CGO.
+func OpenReadOnly(path string, dimension int) (*Index, error) {
+	return &Index{
+		path:      path,
+		dimension: dimension,
+	}, nil
+}
+
 // Add inserts a vector for the given chunk ID.
 func (idx *Index) Add(_ context.Context, _ string, _ []float32) error {
 	return domain.ErrNotImplemented
 }
 
+// AddBatch inserts vectors for many chunk IDs in a single native call.
+func (idx *Index) AddBatch(_ context.Context, _ []string, _ [][]float32) error {
+	return domain.ErrNotImplemented
+}
+
+// AddBatchWithAttributes inserts vectors with their filter attributes.
+func (idx *Index) AddBatchWithAttributes(
+	_ context.Context, _ []string, _ [][]float32, _ []driven.VectorAttributes,
+) error {
+	return domain.ErrNotImplemented
+}
+
 // Delete removes a vector from the index.
 func (idx *Index) Delete(_ context.Context, _ string) error {
 	return domain.ErrNotImplemented
@@ -58,6 +145,74 @@ func (idx *Index) Search(_ context.Context, _ []float32, _ int) ([]driven.Vector
 	return nil, domain.ErrNotImplemented
 }
 
+// SearchWithOptions finds the k nearest neighbours using per-call options.
+func (idx *Index) SearchWithOptions(
+	_ context.Context, _ []float32, _ int, _ SearchOptions,
+) ([]driven.VectorHit, error) {
+	return nil, domain.ErrNotImplemented
+}
+
+// SearchFiltered finds the k nearest neighbours that pass the filter.
+func (idx *Index) SearchFiltered(
+	_ context.Context, _ []float32, _ int, _ driven.VectorFilter,
+) ([]driven.VectorHit, error) {
+	return nil, domain.ErrNotImplemented
+}
+
+// SetEfSearch changes the default search beam width.
+func (idx *Index) SetEfSearch(_ int) error {
+	return domain.ErrNotImplemented
+}
+
+// NativeSearch is the native search entry point of an open index.
+type NativeSearch struct {
+	Index     unsafe.Pointer
+	Search    unsafe.Pointer
+	Options   unsafe.Pointer
+	Dimension int
+}
+
+// AcquireNative returns the native search entry point for searches with opts.
+func (idx *Index) AcquireNative(_ SearchOptions) (native NativeSearch, release func(), err error) {
+	return NativeSearch{}, nil, domain.ErrNotImplemented
+}
+
+// SearchBatch finds the k nearest neighbours for each query vector in a single
+// native call.
+func (idx *Index) SearchBatch(_ context.Context, _ [][]float32, _ int) ([][]driven.VectorHit, error) {
+	return nil, domain.ErrNotImplemented
+}
+
+// Compact rebuilds the index from its live vectors.
+func (idx *Index) Compact(_ context.Context) (int64, error) {
+	return 0, domain.ErrNotImplemented
+}
+
+// Checkpoint writes a full snapshot of the index and truncates its log.
+func (idx *Index) Checkpoint(_ context.Context) error {
+	return domain.ErrNotImplemented
+}
+
+// StartBackgroundFlush starts a background maintenance thread.
+func (idx *Index) StartBackgroundFlush(_ FlushOptions) error {
+	return domain.ErrNotImplemented
+}
+
+// StopBackgroundFlush stops the background maintenance thread.
+func (idx *Index) StopBackgroundFlush() error {
+	return nil
+}
+
+// Flush makes every returned add and delete durable.
+func (idx *Index) Flush(_ context.Context) error {
+	return domain.ErrNotImplemented
+}
+
+// Stats returns the index sizes and counters.
+func (idx *Index) Stats() (Stats, error) {
+	return Stats{}, domain.ErrNotImplemented
+}
+
 // Close releases resources.
 func (idx *Index) Close() error {
 	return nil
@@ -0,0 +1,80 @@
+//go:build cgo
+
+package hnsw
+
+import (
+	"bytes"
+	"context"
+	"encoding/binary"
+	"os"
+	"path/filepath"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+
+	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
+)
+
+// writeV3Mapping replaces the index's id_mapping.bin with a version 3 file,
+// which stores IDs but no filter attributes. ids[i] is mapped to label i.
+func writeV3Mapping(t *testing.T, dir string, ids []string) {
+	t.Helper()
+
+	var buf bytes.Buffer
+	put := func(v any) {
+		require.NoError(t, binary.Write(&buf, binary.LittleEndian, v))
+	}
+	put(uint32(0x4D4E4853)) // Magic
+	put(uint32(3))          // Version
+	put(int32(PrecisionFloat32))
+	put(uint64(1)) // Snapshot generation of the index's checkpoint
+	put(uint64(len(ids)))
+	put(uint64(len(ids))) // Next label
+	for label, id := range ids {
+		put(uint64(label))
+		put(uint64(len(id)))
+		buf.WriteString(id)
+	}
+	require.NoError(t, os.WriteFile(filepath.Join(dir, "id_mapping.bin"), buf.Bytes(), 0600))
+}
+
+func TestIndex_SearchFiltered_UpgradedMappingPassesSourceFilter(t *testing.T) {
+	ctx := context.Background()
+	dir := t.TempDir()
+
+	idx, err := New(dir, 3, PrecisionFloat32)
+	require.NoError(t, err)
+	require.NoError(t, idx.Add(ctx, "chunk-a", []float32{1, 0, 0}))
+	require.NoError(t, idx.Add(ctx, "chunk-b", []float32{0, 1, 0}))
+	require.NoError(t, idx.Close())
+
+	writeV3Mapping(t, dir, []string{"chunk-a", "chunk-b"})
+
+	idx, err = New(dir, 3, PrecisionFloat32)
+	require.NoError(t, err)
+	defer idx.Close()
+
+	stats, err := idx.Stats()
+	require.NoError(t, err)
+	assert.Equal(t, uint64(2), stats.UnsourcedElements)
+
+	// The upgraded vectors have no source, so they pass a source allow list
+	// even before any attributed vector exists
+	filter := driven.VectorFilter{SourceIDs: []string{"src-1"}}
+	hits, err := idx.SearchFiltered(ctx, []float32{1, 0, 0}, 2, filter)
+	require.NoError(t, err)
+	require.Len(t, hits, 2)
+	assert.Equal(t, "chunk-a", hits[0].ChunkID)
+
+	// A vector attributed to another source is still filtered out
+	require.NoError(t, idx.AddBatchWithAttributes(ctx, []string{"chunk-c"},
+		[][]float32{{1, 0, 0}}, []driven.VectorAttributes{{SourceID: "src-2"}}))
+	hits, err = idx.SearchFiltered(ctx, []float32{1, 0, 0}, 3, filter)
+	require.NoError(t, err)
+	ids := make([]string, len(hits))
+	for i, hit := range hits {
+		ids[i] = hit.ChunkID
+	}
+	assert.ElementsMatch(t, []string{"chunk-a", "chunk-b"}, ids)
+}
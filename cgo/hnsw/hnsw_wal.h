@@ -0,0 +1,80 @@
+/*
+ * hnsw_wal.h - Write-ahead log for HNSW index mutations
+ *
+ * Internal C++ header shared by the HNSW wrapper translation units.
+ * Adds and deletes are appended to wal.log next to the snapshot so a sync
+ * persists in O(delta) I/O; the full snapshot is only rewritten at a
+ * checkpoint. Each log belongs to one snapshot generation (seq): a log whose
+ * seq does not match the snapshot is stale and ignored.
+ */
+
+#ifndef SERCHA_HNSW_WAL_H
+#define SERCHA_HNSW_WAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class WalOp : uint8_t {
+    Add = 1,
+    Delete = 2,
+};
+
+struct WalRecord {
+    WalOp op;
+    uint64_t label;             // Add only
+    std::string_view id;
+    std::string_view vector;    // Add only: vector in storage format
+    std::string_view source;    // Add only: filter attributes (may be empty)
+    std::string_view document;
+};
+
+class HnswWal {
+public:
+    HnswWal() = default;
+    ~HnswWal();
+    HnswWal(const HnswWal&) = delete;
+    HnswWal& operator=(const HnswWal&) = delete;
+
+    // Calls apply for every intact record of the log at path if it belongs to
+    // generation seq. Sets *end to the byte length of the intact prefix (0 if
+    // the log is missing or stale, or written in an older format that cannot
+    // be appended to). A torn or corrupt tail ends the replay.
+    // Returns false only if the log exists but cannot be read.
+    static bool replay(const std::string& path, uint64_t seq,
+                       const std::function<void(const WalRecord&)>& apply, uint64_t* end);
+
+    // True if the log at path belongs to generation seq and holds records.
+    static bool has_records(const std::string& path, uint64_t seq);
+
+    // Opens the log for appending. end is the intact length from replay;
+    // anything after it is truncated, and 0 starts a fresh log for seq.
+    bool open(const std::string& path, uint64_t seq, uint64_t end);
+
+    // Appends records with a single write.
+    bool append(const WalRecord* records, size_t count);
+
+    // Flushes appended records to stable storage. Appends only reach the OS
+    // page cache, which survives a process crash but not a power loss.
+    bool sync();
+
+    // Discards all records and starts generation seq (after a checkpoint).
+    bool reset(uint64_t seq);
+
+    // Current log size in bytes, including the header.
+    uint64_t size() const { return size_; }
+
+    void close();
+
+private:
+    bool write_header(uint64_t seq);
+
+    int fd_ = -1;
+    uint64_t size_ = 0;
+    std::vector<char> buf_;
+};
+
+#endif // SERCHA_HNSW_WAL_H
@@ -17,7 +17,8 @@ typedef struct {
     float similarity;
 } HnswSearchResult;
 
-// Storage precision for vectors (runtime always uses float32).
+// Storage precision for vectors, in memory and on disk. Float16 and int8
+// indexes are searched in compressed form; int8 hits are re-ranked in float32.
 typedef enum {
     HNSW_PRECISION_FLOAT32 = 0,  // 4 bytes per dimension (no compression)
     HNSW_PRECISION_FLOAT16 = 1,  // 2 bytes per dimension (50% savings)
@@ -25,17 +26,69 @@ typedef enum {
 } HnswPrecision;
 
 // Create a new HNSW index with specified storage precision.
-// Returns NULL on error.
+// Returns NULL on error, including when path already holds index files.
 HnswIndex* hnsw_create(const char* path, int dimension, int max_elements, HnswPrecision precision);
 
+// Graph construction parameters. Zero fields use the defaults (M=16,
+// ef_construction=200, ef_search=50). M and ef_construction are persisted
+// with the graph; ef_search is the initial default search beam width.
+typedef struct {
+    int M;                // Connections per element (memory vs recall)
+    int ef_construction;  // Construction beam width (build time vs quality)
+    int ef_search;        // Default search beam width (latency vs recall)
+} HnswBuildParams;
+
+// Create a new HNSW index with explicit graph parameters (params may be NULL).
+// Nothing is written until the first checkpoint or close.
+// Returns NULL on error, including when path already holds index files.
+HnswIndex* hnsw_create_ex(const char* path, int dimension, int max_elements,
+                          HnswPrecision precision, const HnswBuildParams* params);
+
 // Open an existing HNSW index.
 // Returns NULL on error.
 HnswIndex* hnsw_open(const char* path, int dimension);
 
-// Add a vector to the index.
+// Report whether path holds any index files, so a failed open can be told
+// apart from a missing index.
+// Returns 1 if it does, 0 otherwise.
+int hnsw_index_exists(const char* path);
+
+// Open an existing HNSW index read-only by memory-mapping its graph and ID
+// table, so open cost does not grow with index size and pages are shared
+// between processes. Add and delete return -1; close saves nothing.
+// Returns NULL on error, including for legacy compressed indexes that have
+// no persisted graph (open those with hnsw_open once to upgrade them).
+HnswIndex* hnsw_open_readonly(const char* path, int dimension);
+
+// Add a vector to the index. Slots of deleted or replaced vectors are
+// reused before the index grows.
 // Returns 0 on success, -1 on error.
 int hnsw_add(HnswIndex* index, const char* chunk_id, const float* vector, int dimension);
 
+// Add n vectors to the index in one call.
+// vectors holds n * dimension floats (row i belongs to ids[i]). If an ID
+// appears more than once, the last occurrence wins. Graph insertion runs on
+// num_threads workers (<= 0 uses all hardware threads).
+// Returns 0 on success, -1 on error.
+int hnsw_add_batch(HnswIndex* index, const char** ids, const float* vectors, int n,
+                   int dimension, int num_threads);
+
+// Filterable attributes stored with a vector. NULL or empty fields are unset.
+typedef struct {
+    const char* source_id;
+    const char* document_id;
+} HnswAttributes;
+
+// Add a vector with filterable attributes (attrs may be NULL).
+// Returns 0 on success, -1 on error.
+int hnsw_add_ex(HnswIndex* index, const char* chunk_id, const float* vector, int dimension,
+                const HnswAttributes* attrs);
+
+// Add n vectors with per-vector attributes (attrs holds n entries or is NULL).
+// Returns 0 on success, -1 on error.
+int hnsw_add_batch_ex(HnswIndex* index, const char** ids, const float* vectors, int n,
+                      int dimension, int num_threads, const HnswAttributes* attrs);
+
 // Delete a vector from the index.
 // Returns 0 on success, -1 on error.
 int hnsw_delete(HnswIndex* index, const char* chunk_id);
@@ -45,10 +98,196 @@ int hnsw_delete(HnswIndex* index, const char* chunk_id);
 int hnsw_search(HnswIndex* index, const float* query, int dimension, int k,
                 HnswSearchResult** results);
 
+// Attribute filter applied during graph traversal, so a search returns the k
+// nearest eligible vectors rather than filtering the k nearest overall.
+// An allow filter admits a vector whose source is in source_ids and whose
+// document is in document_ids (an empty list does not restrict that field).
+// A vector stored without a source passes source_ids, so callers must check
+// the sources of such hits (see HnswStats.unsourced_elements).
+// With exclude set, a vector is rejected if its source or document is listed.
+typedef struct {
+    const char* const* source_ids;
+    int num_source_ids;
+    const char* const* document_ids;
+    int num_document_ids;
+    int exclude;
+} HnswFilter;
+
+// Per-call search options. Zero fields use the index defaults.
+typedef struct {
+    int ef;             // Search beam width; the effective value is at least k
+    int rerank_factor;  // Compressed indexes: candidates re-ranked per result
+                        // in float32 (1 disables re-ranking)
+    const HnswFilter* filter;  // Optional attribute filter (may be NULL)
+} HnswSearchOptions;
+
+// Search for the k nearest neighbors with per-call options (may be NULL).
+// Options only affect this call, so concurrent searches can use different
+// settings. Returns the number of results, or -1 on error.
+int hnsw_search_ex(HnswIndex* index, const float* query, int dimension, int k,
+                   const HnswSearchOptions* options, HnswSearchResult** results);
+
+// Receives one hit of hnsw_search_visit. chunk_id is not NUL-terminated and
+// is only valid during the call.
+typedef void (*hnsw_hit_visitor)(void* ctx, const char* chunk_id, size_t chunk_id_len,
+                                 float similarity);
+
+// Like hnsw_search_ex, but passes each hit to visit (closest first) instead
+// of allocating a results array, for native callers that consume the hits
+// directly (the hybrid engine in cgo/hybrid). visit runs under the index's
+// read lock and must not call back into the index.
+// Returns the number of hits visited, or -1 on error.
+int hnsw_search_visit(HnswIndex* index, const float* query, int dimension, int k,
+                      const HnswSearchOptions* options, hnsw_hit_visitor visit, void* ctx);
+
+// Returned by hnsw_search_into and hnsw_resolve_labels when the chunk IDs do
+// not fit in the caller's arena; ids_size then holds the bytes needed.
+#define HNSW_ERR_BUFFER_TOO_SMALL (-2)
+
+// Returned by hnsw_resolve_labels when labels may have been reassigned since
+// they were returned.
+#define HNSW_ERR_STALE_LABELS (-3)
+
+// Caller-owned result buffer for hnsw_search_into. The caller allocates the
+// arrays once and reuses the buffer across searches, so a search allocates
+// nothing for its results. Hit i's chunk ID is
+// ids[id_offsets[i] .. id_offsets[i + 1]) (not NUL-terminated).
+//
+// With ids NULL the search runs in label mode and returns only labels,
+// numeric IDs of the vectors. Labels are reused after deletes and renumbered
+// by compaction; label_generation changes whenever a label may come to name
+// a different chunk, so a cache of label -> chunk ID is valid for as long as
+// the generation is unchanged. Resolve unknown labels with
+// hnsw_resolve_labels.
+typedef struct {
+    int capacity;               // Hits the arrays hold (at least k)
+    float* similarities;        // capacity entries
+    uint64_t* labels;           // capacity entries, or NULL
+    uint32_t* id_offsets;       // capacity + 1 entries, or NULL in label mode
+    char* ids;                  // Packed chunk IDs, or NULL for label mode
+    size_t ids_capacity;        // Bytes available in ids
+    size_t ids_size;            // Out: bytes used (or needed) by the IDs
+    uint64_t label_generation;  // Out: label generation of the results
+} HnswResultBuffer;
+
+// Like hnsw_search_ex, but writes the results into buf.
+// Returns the number of hits, HNSW_ERR_BUFFER_TOO_SMALL if the IDs do not fit
+// (grow ids to ids_size and retry), or -1 on error.
+int hnsw_search_into(HnswIndex* index, const float* query, int dimension, int k,
+                     const HnswSearchOptions* options, HnswResultBuffer* buf);
+
+// Write the chunk IDs of count labels from a search in label mode into
+// ids/id_offsets (count + 1 entries), laid out as in HnswResultBuffer.
+// Returns 0 on success, HNSW_ERR_STALE_LABELS if label_generation is no
+// longer current (search again), HNSW_ERR_BUFFER_TOO_SMALL if the IDs do not
+// fit (*ids_size is then the bytes needed), or -1 on error.
+int hnsw_resolve_labels(HnswIndex* index, const uint64_t* labels, int count,
+                        uint64_t label_generation, uint32_t* id_offsets, char* ids,
+                        size_t ids_capacity, size_t* ids_size);
+
+// Set the default search beam width used when no per-call ef is given.
+// Returns 0 on success, -1 on error.
+int hnsw_set_ef(HnswIndex* index, int ef);
+
 // Free search results.
 void hnsw_free_results(HnswSearchResult* results, int count);
 
-// Close and free the index.
+// BatchResults holds the results of hnsw_search_batch in a single allocation.
+// Hits for query q are entries [offsets[q], offsets[q + 1]) of chunk_ids and
+// similarities, best first. The chunk_id strings live in the same allocation.
+typedef struct {
+    int num_queries;
+    int* offsets;             // num_queries + 1 entries
+    const char** chunk_ids;
+    float* similarities;
+} HnswBatchResults;
+
+// Search for the k nearest neighbors of each of num_queries query vectors.
+// queries holds num_queries * dimension floats. Queries run on num_threads
+// workers (<= 0 uses all hardware threads).
+// Returns 0 on success, -1 on error. Free with hnsw_free_batch_results.
+int hnsw_search_batch(HnswIndex* index, const float* queries, int num_queries, int dimension,
+                      int k, int num_threads, HnswBatchResults* results);
+
+// Free batched search results.
+void hnsw_free_batch_results(HnswBatchResults* results);
+
+// Rebuild the index densely from its live vectors, dropping tombstones left
+// by deletes and updates and renumbering labels, then checkpoint it.
+// Searches continue against the old graph while the new one is built.
+// num_threads <= 0 uses all hardware threads. If reclaimed_bytes is not NULL
+// it receives the graph memory freed. Returns 0 on success, -1 on error.
+int hnsw_compact(HnswIndex* index, int num_threads, int64_t* reclaimed_bytes);
+
+// Write a full snapshot of the index and truncate its write-ahead log.
+// Adds and deletes are durable once they return (they are appended to the
+// log), so checkpointing only bounds log size and replay time on open.
+// Returns 0 on success, -1 on error.
+int hnsw_checkpoint(HnswIndex* index);
+
+// Background maintenance schedule for hnsw_set_background_flush.
+typedef struct {
+    int interval_ms;        // Run at least this often (0 = 1000)
+    int max_unsynced;       // Run early once this many changes are unsynced (0 = 1000)
+    int64_t max_log_bytes;  // Checkpoint once the log reaches this size
+                            // (0 = half the snapshot size, as on close)
+} HnswFlushOptions;
+
+// Start (opts non-NULL) or stop (NULL) a background maintenance thread for
+// the index. Each round syncs newly logged changes to stable storage, and
+// checkpoints once the log is due, all off the add/delete path. Stopping or
+// replacing the schedule syncs the log first. Returns 0 on success, -1 on
+// error (read-only index).
+int hnsw_set_background_flush(HnswIndex* index, const HnswFlushOptions* opts);
+
+// Barrier: once it returns 0, every add and delete that returned before the
+// call survives a power loss, not only a process crash. Changes that could
+// not be logged are checkpointed instead. Returns 0 on success, -1 on error.
+int hnsw_flush(HnswIndex* index);
+
+// Instruction set of the distance and conversion kernels, selected once for
+// the running CPU: "avx512", "avx2", "neon" or "scalar".
+const char* hnsw_kernel_isa(void);
+
+// Buckets of the HnswStats histograms. Bucket 0 counts values below 2 and
+// bucket i (i > 0) values in [2^i, 2^(i+1)); the last bucket is open-ended.
+#define HNSW_STATS_BUCKETS 32
+
+// Counters and sizes reported by hnsw_stats. Counters cover the time since
+// the index was opened.
+typedef struct {
+    uint64_t live_elements;     // Mapped chunk IDs
+    uint64_t deleted_elements;  // Tombstoned graph slots awaiting reuse or compaction
+    uint64_t max_elements;      // Current capacity
+    uint64_t resize_count;      // Capacity growths
+    // Live elements without a source attribute (added without one, or indexed
+    // before attributes were stored). They pass every source allow list.
+    uint64_t unsourced_elements;
+
+    uint64_t vector_bytes;   // Stored vectors (allocated capacity)
+    uint64_t graph_bytes;    // Links and labels of all layers
+    uint64_t mapping_bytes;  // Chunk ID table and filter attributes
+    uint64_t wal_bytes;      // Write-ahead log on disk
+
+    uint64_t searches;
+    uint64_t distance_computations;  // Summed over searches
+    uint64_t search_ns;              // Summed search latency
+    uint64_t distance_histogram[HNSW_STATS_BUCKETS];  // Distance computations per search
+    uint64_t latency_histogram[HNSW_STATS_BUCKETS];   // Search latency in microseconds
+
+    uint64_t lock_waits;        // Contended acquisitions of the locks below
+    uint64_t read_wait_ns;      // Searches waiting for the index lock
+    uint64_t exclusive_wait_ns; // Graph mutations waiting for the index lock
+    uint64_t writer_wait_ns;    // Adds and deletes waiting for another writer
+} HnswStats;
+
+// Fill stats with the index's current counters and sizes. Counting is always
+// on: a search costs two clock reads and a few relaxed atomic adds, and an
+// uncontended lock costs nothing extra. Returns 0 on success, -1 on error.
+int hnsw_stats(HnswIndex* index, HnswStats* stats);
+
+// Close and free the index. The write-ahead log is checkpointed first if it
+// has grown to half the snapshot size or more.
 void hnsw_close(HnswIndex* index);
 
 #ifdef __cplusplus
@@ -0,0 +1,444 @@
+package hnsw
+
+import (
+	"context"
+	"encoding/hex"
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+
+	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
+)
+
+// Ensure PartitionedIndex implements the interfaces.
+var (
+	_ driven.VectorIndex            = (*PartitionedIndex)(nil)
+	_ driven.BatchVectorIndex       = (*PartitionedIndex)(nil)
+	_ driven.FilterableVectorIndex  = (*PartitionedIndex)(nil)
+	_ driven.PartitionedVectorIndex = (*PartitionedIndex)(nil)
+)
+
+// DefaultPartitionElements is the initial capacity of a new partition. It is
+// smaller than DefaultMaxElements since most sources hold far fewer vectors
+// than the whole store; a partition grows as needed.
+const DefaultPartitionElements = 10000
+
+// ErrLayoutMismatch is returned when a path already holds vectors in the
+// other layout: a single index opened as a partitioned store, or the reverse.
+// Opening it in the requested layout would hide those vectors.
+var ErrLayoutMismatch = errors.New("hnsw: vector index exists in the other layout")
+
+const (
+	// partitionsDir holds one index directory per partition.
+	partitionsDir = "partitions"
+	// defaultPartition holds vectors added without a source.
+	defaultPartition = "default"
+	// sourcePartitionPrefix precedes the hex-encoded source ID of a source's
+	// partition directory, so any source ID maps to a safe file name.
+	sourcePartitionPrefix = "s-"
+)
+
+// PartitionedIndex is a vector store with one Index per source, kept in
+// path/partitions. A search fans out to the partitions it can match in
+// parallel and merges their top k, so a source-filtered search only
+// traverses the graphs of those sources, and dropping a source removes its
+// directory instead of tombstoning its vectors.
+//
+// Partitions are opened on first use: a search filtered to some sources
+// opens only theirs, as does DeleteFromSource. An unfiltered search, an
+// exclusion filter and Delete, which cannot tell which source a chunk
+// belongs to, open every partition.
+//
+// mu guards the partition set against DropSource and Close, which hold it
+// exclusively; every other operation holds it shared. openMu guards parts
+// among those: lookups hold it shared and only opening a partition holds it
+// exclusively, so no operation waits on another partition's I/O.
+type PartitionedIndex struct {
+	mu        sync.RWMutex
+	openMu    sync.RWMutex
+	path      string
+	dimension int
+	precision Precision
+	opts      Options
+	parts     map[string]*Index // By source ID ("" = default partition)
+	closed    bool
+}
+
+// NewPartitioned creates or opens a partitioned vector store at path. New
+// partitions are created with precision and opts; opts.MaxElements defaults
+// to DefaultPartitionElements. No partition is opened until it is used.
+// A single index at path is reported as ErrLayoutMismatch.
+func NewPartitioned(path string, dimension int, precision Precision, opts Options) (*PartitionedIndex, error) {
+	if path == "" {
+		return nil, errors.New("hnsw: path cannot be empty")
+	}
+	if dimension <= 0 {
+		return nil, errors.New("hnsw: dimension must be positive")
+	}
+	if IndexExists(path) {
+		return nil, fmt.Errorf("%w: %s holds a single index", ErrLayoutMismatch, path)
+	}
+	if opts.MaxElements <= 0 {
+		opts.MaxElements = DefaultPartitionElements
+	}
+	if err := os.MkdirAll(filepath.Join(path, partitionsDir), 0700); err != nil {
+		return nil, fmt.Errorf("hnsw: create partitions directory: %w", err)
+	}
+
+	return &PartitionedIndex{
+		path:      path,
+		dimension: dimension,
+		precision: precision,
+		opts:      opts,
+		parts:     make(map[string]*Index),
+	}, nil
+}
+
+// hasPartitions reports whether path is a partitioned store with at least
+// one partition.
+func hasPartitions(path string) bool {
+	entries, err := os.ReadDir(filepath.Join(path, partitionsDir))
+	return err == nil && len(entries) > 0
+}
+
+// partitionDir is the index directory of a source's partition.
+func (p *PartitionedIndex) partitionDir(sourceID string) string {
+	name := defaultPartition
+	if sourceID != "" {
+		name = sourcePartitionPrefix + hex.EncodeToString([]byte(sourceID))
+	}
+	return filepath.Join(p.path, partitionsDir, name)
+}
+
+// Sources lists the source IDs that have a partition on disk; vectors added
+// without a source are listed as "".
+func (p *PartitionedIndex) Sources() ([]string, error) {
+	entries, err := os.ReadDir(filepath.Join(p.path, partitionsDir))
+	if err != nil {
+		return nil, fmt.Errorf("hnsw: list partitions: %w", err)
+	}
+
+	var sources []string
+	for _, entry := range entries {
+		if !entry.IsDir() {
+			continue
+		}
+		name := entry.Name()
+		if name == defaultPartition {
+			sources = append(sources, "")
+			continue
+		}
+		if encoded, ok := strings.CutPrefix(name, sourcePartitionPrefix); ok {
+			if id, err := hex.DecodeString(encoded); err == nil {
+				sources = append(sources, string(id))
+			}
+		}
+	}
+	return sources, nil
+}
+
+// partition returns the open partition of sourceID. A partition missing on
+// disk is created when create is set and reported as nil otherwise.
+// Caller holds p.mu shared.
+func (p *PartitionedIndex) partition(sourceID string, create bool) (*Index, error) {
+	if p.closed {
+		return nil, errors.New("hnsw: index is closed")
+	}
+
+	p.openMu.RLock()
+	idx, ok := p.parts[sourceID]
+	p.openMu.RUnlock()
+	if ok {
+		return idx, nil
+	}
+
+	p.openMu.Lock()
+	defer p.openMu.Unlock()
+
+	// Another caller may have opened it meanwhile
+	if existing, ok := p.parts[sourceID]; ok {
+		return existing, nil
+	}
+	dir := p.partitionDir(sourceID)
+	if !create {
+		if _, err := os.Stat(dir); errors.Is(err, os.ErrNotExist) {
+			return nil, nil
+		}
+	}
+	idx, err := NewWithOptions(dir, p.dimension, p.precision, p.opts)
+	if err != nil {
+		return nil, fmt.Errorf("hnsw: open partition %q: %w", sourceID, err)
+	}
+	p.parts[sourceID] = idx
+	return idx, nil
+}
+
+// partitions opens the partitions of sources that exist on disk.
+// Caller holds p.mu shared.
+func (p *PartitionedIndex) partitions(sources []string) ([]*Index, error) {
+	indexes := make([]*Index, 0, len(sources))
+	for _, sourceID := range sources {
+		idx, err := p.partition(sourceID, false)
+		if err != nil {
+			return nil, err
+		}
+		if idx != nil {
+			indexes = append(indexes, idx)
+		}
+	}
+	return indexes, nil
+}
+
+// Add inserts a vector into the default partition.
+func (p *PartitionedIndex) Add(ctx context.Context, chunkID string, embedding []float32) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	idx, err := p.partition("", true)
+	if err != nil {
+		return err
+	}
+	return idx.Add(ctx, chunkID, embedding)
+}
+
+// AddBatch inserts vectors into the default partition.
+func (p *PartitionedIndex) AddBatch(ctx context.Context, chunkIDs []string, embeddings [][]float32) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	idx, err := p.partition("", true)
+	if err != nil {
+		return err
+	}
+	return idx.AddBatch(ctx, chunkIDs, embeddings)
+}
+
+// AddBatchWithAttributes inserts each vector into the partition of its
+// source, one native batch per source.
+func (p *PartitionedIndex) AddBatchWithAttributes(
+	ctx context.Context, chunkIDs []string, embeddings [][]float32, attrs []driven.VectorAttributes,
+) error {
+	if len(chunkIDs) != len(embeddings) || len(chunkIDs) != len(attrs) {
+		return errors.New("hnsw: chunk ID, embedding and attribute counts differ")
+	}
+
+	type group struct {
+		ids        []string
+		embeddings [][]float32
+		attrs      []driven.VectorAttributes
+	}
+	var order []string
+	groups := make(map[string]*group)
+	for i, a := range attrs {
+		g, ok := groups[a.SourceID]
+		if !ok {
+			g = &group{}
+			groups[a.SourceID] = g
+			order = append(order, a.SourceID)
+		}
+		g.ids = append(g.ids, chunkIDs[i])
+		g.embeddings = append(g.embeddings, embeddings[i])
+		g.attrs = append(g.attrs, a)
+	}
+
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	for _, sourceID := range order {
+		idx, err := p.partition(sourceID, true)
+		if err != nil {
+			return err
+		}
+		g := groups[sourceID]
+		if err := idx.AddBatchWithAttributes(ctx, g.ids, g.embeddings, g.attrs); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// Delete removes a vector from whichever partition holds it. It opens every
+// partition; use DeleteFromSource when the chunk's source is known.
+func (p *PartitionedIndex) Delete(ctx context.Context, chunkID string) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	sources, err := p.Sources()
+	if err != nil {
+		return err
+	}
+	indexes, err := p.partitions(sources)
+	if err != nil {
+		return err
+	}
+	for _, idx := range indexes {
+		if err := idx.Delete(ctx, chunkID); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// DeleteFromSource removes a vector from the partition of sourceID only.
+func (p *PartitionedIndex) DeleteFromSource(ctx context.Context, sourceID, chunkID string) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	idx, err := p.partition(sourceID, false)
+	if err != nil || idx == nil {
+		return err
+	}
+	return idx.Delete(ctx, chunkID)
+}
+
+// Search finds the k nearest neighbours across all partitions.
+func (p *PartitionedIndex) Search(ctx context.Context, query []float32, k int) ([]driven.VectorHit, error) {
+	return p.SearchFiltered(ctx, query, k, driven.VectorFilter{})
+}
+
+// SearchFiltered finds the k nearest neighbours that pass the filter. Source
+// IDs select (or, with Exclude, skip) whole partitions; document IDs are
+// filtered during each partition's traversal.
+func (p *PartitionedIndex) SearchFiltered(
+	ctx context.Context, query []float32, k int, filter driven.VectorFilter,
+) ([]driven.VectorHit, error) {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	sources := filter.SourceIDs
+	if len(sources) == 0 || filter.Exclude {
+		all, err := p.Sources()
+		if err != nil {
+			return nil, err
+		}
+		sources = withoutSources(all, filter.SourceIDs)
+	}
+	indexes, err := p.partitions(sources)
+	if err != nil {
+		return nil, err
+	}
+
+	var opts SearchOptions
+	if len(filter.DocumentIDs) > 0 {
+		opts.Filter = &driven.VectorFilter{DocumentIDs: filter.DocumentIDs, Exclude: filter.Exclude}
+	}
+	if len(indexes) == 1 {
+		return indexes[0].SearchWithOptions(ctx, query, k, opts)
+	}
+	return fanOutSearch(ctx, indexes, query, k, opts)
+}
+
+// withoutSources returns sources minus the excluded ones.
+func withoutSources(sources, excluded []string) []string {
+	if len(excluded) == 0 {
+		return sources
+	}
+	skip := make(map[string]struct{}, len(excluded))
+	for _, id := range excluded {
+		skip[id] = struct{}{}
+	}
+	kept := sources[:0:0]
+	for _, id := range sources {
+		if _, ok := skip[id]; !ok {
+			kept = append(kept, id)
+		}
+	}
+	return kept
+}
+
+// fanOutSearch searches every index in parallel and merges the hits into the
+// overall top k.
+func fanOutSearch(
+	ctx context.Context, indexes []*Index, query []float32, k int, opts SearchOptions,
+) ([]driven.VectorHit, error) {
+	results := make([][]driven.VectorHit, len(indexes))
+	errs := make([]error, len(indexes))
+	var wg sync.WaitGroup
+	for i, idx := range indexes {
+		wg.Add(1)
+		go func(i int, idx *Index) {
+			defer wg.Done()
+			results[i], errs[i] = idx.SearchWithOptions(ctx, query, k, opts)
+		}(i, idx)
+	}
+	wg.Wait()
+
+	var merged []driven.VectorHit
+	for i, hits := range results {
+		if errs[i] != nil {
+			return nil, errs[i]
+		}
+		merged = append(merged, hits...)
+	}
+	sort.SliceStable(merged, func(a, b int) bool {
+		return merged[a].Similarity > merged[b].Similarity
+	})
+	if len(merged) > k {
+		merged = merged[:k]
+	}
+	return merged, nil
+}
+
+// DropSource removes a source's partition and all of its vectors. It waits
+// for operations in flight and does not depend on the partition's size.
+func (p *PartitionedIndex) DropSource(_ context.Context, sourceID string) error {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	if p.closed {
+		return errors.New("hnsw: index is closed")
+	}
+	if idx, ok := p.parts[sourceID]; ok {
+		delete(p.parts, sourceID)
+		if err := idx.Close(); err != nil {
+			return err
+		}
+	}
+	if err := os.RemoveAll(p.partitionDir(sourceID)); err != nil {
+		return fmt.Errorf("hnsw: remove partition %q: %w", sourceID, err)
+	}
+	return nil
+}
+
+// Flush makes every add and delete that has returned durable in all open
+// partitions.
+func (p *PartitionedIndex) Flush(ctx context.Context) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	// Flushing holds openMu for none of the fsyncs: p.mu keeps the copied
+	// partitions open
+	p.openMu.RLock()
+	indexes := make([]*Index, 0, len(p.parts))
+	for _, idx := range p.parts {
+		indexes = append(indexes, idx)
+	}
+	p.openMu.RUnlock()
+
+	for _, idx := range indexes {
+		if err := idx.Flush(ctx); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// Close closes every open partition.
+func (p *PartitionedIndex) Close() error {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	var firstErr error
+	for sourceID, idx := range p.parts {
+		if err := idx.Close(); err != nil && firstErr == nil {
+			firstErr = err
+		}
+		delete(p.parts, sourceID)
+	}
+	p.closed = true
+	return firstErr
+}
@@ -0,0 +1,7 @@
+// Package hybrid provides fused keyword + vector search over the xapian and
+// hnsw bindings. It implements the driven.HybridSearcher interface.
+//
+// Build requires:
+//   - The xapian and hnsw bindings (their headers are included directly)
+//   - C++17 compiler
+package hybrid
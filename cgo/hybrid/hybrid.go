@@ -0,0 +1,114 @@
+//go:build cgo
+
+package hybrid
+
+/*
+#cgo CFLAGS: -I${SRCDIR}/../xapian -I${SRCDIR}/../hnsw
+#cgo CXXFLAGS: -std=c++17 -O3 -I${SRCDIR}/../xapian -I${SRCDIR}/../hnsw
+#cgo LDFLAGS: -lstdc++ -lpthread
+
+#include "hybrid_wrapper.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"context"
+	"errors"
+	"unsafe"
+
+	"github.com/custodia-labs/sercha-cli/cgo/hnsw"
+	"github.com/custodia-labs/sercha-cli/cgo/xapian"
+	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
+)
+
+// Ensure Engine implements the interface.
+var _ driven.HybridSearcher = (*Engine)(nil)
+
+// Engine searches a Xapian engine and an HNSW index in one native call: the
+// two retrievals run concurrently on native threads and are fused in C++,
+// so no intermediate result list crosses into Go. It reaches the engines
+// through their native entry points and holds them open for each search.
+type Engine struct {
+	keyword *xapian.Engine
+	vector  *hnsw.Index
+}
+
+// New creates a hybrid engine over an open keyword engine and vector index.
+// Closing either one waits for in-flight hybrid searches.
+func New(keyword *xapian.Engine, vector *hnsw.Index) *Engine {
+	return &Engine{keyword: keyword, vector: vector}
+}
+
+// HybridSearch searches query and embedding concurrently and returns the
+// fused ranking. An empty query or embedding skips that side.
+func (e *Engine) HybridSearch(
+	_ context.Context, query string, embedding []float32, opts driven.HybridSearchOptions,
+) ([]driven.SearchHit, error) {
+	keyword, releaseKeyword, err := e.keyword.AcquireNative()
+	if err != nil {
+		return nil, err
+	}
+	defer releaseKeyword()
+
+	vector, releaseVector, err := e.vector.AcquireNative(hnsw.SearchOptions{Filter: opts.Filter})
+	if err != nil {
+		return nil, err
+	}
+	defer releaseVector()
+
+	if len(embedding) > 0 && len(embedding) != vector.Dimension {
+		return nil, errors.New("hybrid: query dimension mismatch")
+	}
+
+	engines := C.HybridEngines{
+		keyword_db:     C.xapian_db(keyword.DB),
+		keyword_search: (*[0]byte)(keyword.Search),
+		keyword_error:  (*[0]byte)(keyword.Error),
+		vector_index:   (*C.HnswIndex)(vector.Index),
+		vector_search:  (*[0]byte)(vector.Search),
+		vector_options: (*C.HnswSearchOptions)(vector.Options),
+	}
+
+	cOpts := C.HybridOptions{
+		keyword_limit:  C.int(opts.KeywordLimit),
+		vector_limit:   C.int(opts.VectorLimit),
+		limit:          C.int(opts.Limit),
+		fusion:         C.HybridFusion(opts.Fusion),
+		rrf_k:          C.int(opts.RRFK),
+		keyword_weight: C.double(opts.KeywordWeight),
+		vector_weight:  C.double(opts.VectorWeight),
+	}
+
+	var cQuery *C.char
+	if query != "" {
+		cQuery = C.CString(query)
+		defer C.free(unsafe.Pointer(cQuery))
+	}
+
+	var cVector *C.float
+	if len(embedding) > 0 {
+		cVector = (*C.float)(unsafe.Pointer(&embedding[0]))
+	}
+
+	var results C.HybridResults
+	if C.hybrid_search(&engines, cQuery, cVector, C.int(len(embedding)), &cOpts, &results) != 0 {
+		errMsg := C.GoString(C.hybrid_get_error())
+		return nil, errors.New("hybrid: search failed: " + errMsg)
+	}
+	defer C.hybrid_free_results(&results)
+
+	if results.count == 0 || results.hits == nil {
+		return nil, nil
+	}
+
+	hits := make([]driven.SearchHit, int(results.count))
+	for i, hit := range unsafe.Slice(results.hits, int(results.count)) {
+		hits[i] = driven.SearchHit{
+			ChunkID: C.GoString(hit.chunk_id),
+			Score:   float64(hit.score),
+		}
+	}
+
+	return hits, nil
+}
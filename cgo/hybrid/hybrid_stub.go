@@ -0,0 +1,32 @@
+//go:build !cgo
+
+package hybrid
+
+import (
+	"context"
+
+	"github.com/custodia-labs/sercha-cli/cgo/hnsw"
+	"github.com/custodia-labs/sercha-cli/cgo/xapian"
+	"github.com/custodia-labs/sercha-cli/internal/core/domain"
+	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
+)
+
+// Ensure Engine implements the interface.
+var _ driven.HybridSearcher = (*Engine)(nil)
+
+// Engine searches a Xapian engine and an HNSW index in one native call.
+// This is a stub for builds without CGO.
+type Engine struct{}
+
+// New creates a hybrid engine over an open keyword engine and vector index.
+func New(_ *xapian.Engine, _ *hnsw.Index) *Engine {
+	return &Engine{}
+}
+
+// HybridSearch searches query and embedding concurrently and returns the
+// fused ranking.
+func (e *Engine) HybridSearch(
+	_ context.Context, _ string, _ []float32, _ driven.HybridSearchOptions,
+) ([]driven.SearchHit, error) {
+	return nil, domain.ErrNotImplemented
+}
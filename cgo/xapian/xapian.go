@@ -14,21 +14,110 @@ import "C"
 import (
 	"context"
 	"errors"
+	"runtime"
 	"sync"
+	"sync/atomic"
+	"time"
 	"unsafe"
 
 	"github.com/custodia-labs/sercha-cli/internal/core/domain"
 	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
 )
 
-// Ensure Engine implements the interface.
-var _ driven.SearchEngine = (*Engine)(nil)
+// Ensure Engine implements the interfaces.
+var (
+	_ driven.SearchEngine            = (*Engine)(nil)
+	_ driven.BatchSearchEngine       = (*Engine)(nil)
+	_ driven.SnippetSearchEngine     = (*Engine)(nil)
+	_ driven.CollapsingSearchEngine  = (*Engine)(nil)
+	_ driven.CompactableSearchEngine = (*Engine)(nil)
+)
+
+// BatchCommitThreshold is the number of changes after which an open batch is
+// committed and continued in a new transaction, bounding memory use and the
+// work lost to a crash mid-batch.
+const BatchCommitThreshold = 10000
+
+// DefaultResultCacheSize is the number of distinct queries whose results are
+// cached by default. Cached results are dropped on the next commit.
+const DefaultResultCacheSize = 256
+
+// DefaultMaxHitsPerDocument is the number of chunks of one document a search
+// returns by default, keeping results diverse.
+const DefaultMaxHitsPerDocument = 3
+
+// CompactLevel trades compaction time for output size.
+type CompactLevel int
+
+const (
+	// CompactStandard leaves some free space in blocks for later updates.
+	CompactStandard CompactLevel = iota
+	// CompactFull packs blocks fully; best for indexes that rarely change.
+	CompactFull
+	// CompactFuller packs harder still, at extra cost.
+	CompactFuller
+)
+
+// CompactOptions controls compaction.
+type CompactOptions struct {
+	Level CompactLevel
+
+	// BlockSize is the output table block size in bytes (0 = default).
+	BlockSize int
+}
+
+// FlushOptions schedules background commits. Zero fields use the defaults.
+type FlushOptions struct {
+	// Interval is the longest time a change waits to be committed
+	// (default 1s).
+	Interval time.Duration
+	// MaxPending commits early once a shard has this many uncommitted
+	// changes (default 1000).
+	MaxPending int
+}
+
+// CacheStats reports the search result cache counters.
+type CacheStats struct {
+	Hits     uint64
+	Misses   uint64
+	Entries  int
+	Capacity int
+}
+
+// StatsBuckets is the number of buckets in each Stats histogram. Bucket 0
+// counts latencies below 2µs and bucket i (i > 0) those in [2^i, 2^(i+1))
+// µs; the last bucket is open-ended.
+const StatsBuckets = C.XAPIAN_STATS_BUCKETS
+
+// Stats reports the database size and the counters gathered since it was
+// opened.
+type Stats struct {
+	Documents      uint64 // Committed chunks, summed over shards
+	Revision       uint64 // Committed revisions, summed over shards
+	PendingChanges uint64 // Changes awaiting the background flusher
+
+	Commits         uint64
+	CommitTime      time.Duration // Summed over commits
+	CommitHistogram [StatsBuckets]uint64
+
+	// Searches includes those answered from the result cache.
+	Searches        uint64
+	SearchTime      time.Duration // Summed over searches
+	SearchHistogram [StatsBuckets]uint64
+}
 
 // Engine provides full-text search using Xapian.
+// The native database serialises writers itself (per shard, for an index
+// opened with NewSharded) and serves searches from a pool of read-only
+// handles, so searches run in parallel with each other and with indexing.
+// mu only guards the handle against Close: every operation holds it shared.
+// Searches see committed changes only.
 type Engine struct {
-	mu   sync.RWMutex
-	db   C.xapian_db
-	path string
+	mu          sync.RWMutex
+	db          C.xapian_db
+	path        string
+	perDocument atomic.Int32
+	buffers     bufferPool
 }
 
 // New creates a new Xapian search engine.
@@ -42,16 +131,56 @@ func New(path string) (*Engine, error) {
 		return nil, errors.New("xapian: failed to open database: " + errMsg)
 	}
 
-	return &Engine{
+	return newEngine(db, path), nil
+}
+
+// NewSharded creates a Xapian search engine whose index is split into shards
+// sub-databases, with chunks routed by a hash of their ID. Writes to
+// different shards run in parallel, so concurrent syncs of independent
+// sources do not serialise on one writer. The shard count is fixed when the
+// index is created; New also opens a sharded index.
+func NewSharded(path string, shards int) (*Engine, error) {
+	cpath := C.CString(path)
+	defer C.free(unsafe.Pointer(cpath))
+
+	db := C.xapian_open_sharded(cpath, C.int(shards))
+	if db == nil {
+		errMsg := C.GoString(C.xapian_get_error())
+		return nil, errors.New("xapian: failed to open sharded database: " + errMsg)
+	}
+
+	return newEngine(db, path), nil
+}
+
+// newEngine wraps an open database with the default search settings.
+func newEngine(db C.xapian_db, path string) *Engine {
+	// Agents re-issue identical queries; answer them without re-matching
+	C.xapian_set_cache_size(db, C.int(DefaultResultCacheSize))
+	C.xapian_set_collapse(db, C.int(DefaultMaxHitsPerDocument))
+
+	e := &Engine{
 		db:   db,
 		path: path,
-	}, nil
+	}
+	e.perDocument.Store(DefaultMaxHitsPerDocument)
+	return e
+}
+
+// ShardCount returns the number of shards of the index (1 if unsharded).
+func (e *Engine) ShardCount() int {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return 0
+	}
+	return int(C.xapian_shard_count(e.db))
 }
 
 // Index adds or updates a chunk in the search index.
 func (e *Engine) Index(_ context.Context, chunk domain.Chunk) error {
-	e.mu.Lock()
-	defer e.mu.Unlock()
+	e.mu.RLock()
+	defer e.mu.RUnlock()
 
 	if e.db == nil {
 		return errors.New("xapian: database is closed")
@@ -75,10 +204,59 @@ func (e *Engine) Index(_ context.Context, chunk domain.Chunk) error {
 	return nil
 }
 
+// IndexBatch adds or updates many chunks in a single native call. The
+// native side reads the Go strings in place (they are pinned for the call),
+// so no C copies are made.
+func (e *Engine) IndexBatch(_ context.Context, chunks []domain.Chunk) error {
+	if len(chunks) == 0 {
+		return nil
+	}
+
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	var pinner runtime.Pinner
+	defer pinner.Unpin()
+
+	docs := make([]C.XapianDocument, len(chunks))
+	for i := range chunks {
+		docs[i].chunk_id, docs[i].chunk_id_len = pinnedString(&pinner, chunks[i].ID)
+		docs[i].doc_id, docs[i].doc_id_len = pinnedString(&pinner, chunks[i].DocumentID)
+		docs[i].content, docs[i].content_len = pinnedString(&pinner, chunks[i].Content)
+	}
+
+	result := C.xapian_index_batch(e.db, &docs[0], C.int(len(docs)))
+	if result != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to index chunks: " + errMsg)
+	}
+
+	return nil
+}
+
+// pinnedString returns a pointer to the bytes of s and their length, pinning
+// them so the pointer may be stored in memory passed to C. Empty strings
+// use a pointer to a static empty C string.
+func pinnedString(pinner *runtime.Pinner, s string) (*C.char, C.size_t) {
+	if s == "" {
+		return emptyCString, 0
+	}
+	data := unsafe.StringData(s)
+	pinner.Pin(data)
+	return (*C.char)(unsafe.Pointer(data)), C.size_t(len(s))
+}
+
+// emptyCString is a static empty C string (never freed).
+var emptyCString = C.CString("")
+
 // Delete removes a chunk from the search index.
 func (e *Engine) Delete(_ context.Context, chunkID string) error {
-	e.mu.Lock()
-	defer e.mu.Unlock()
+	e.mu.RLock()
+	defer e.mu.RUnlock()
 
 	if e.db == nil {
 		return errors.New("xapian: database is closed")
@@ -96,6 +274,122 @@ func (e *Engine) Delete(_ context.Context, chunkID string) error {
 	return nil
 }
 
+// BeginBatch starts grouping Index and Delete calls into one transaction, so
+// bulk ingestion commits once instead of once per chunk. Batches nest; every
+// BeginBatch must be matched by CommitBatch.
+func (e *Engine) BeginBatch(_ context.Context) error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	if C.xapian_begin_batch(e.db, C.int(BatchCommitThreshold)) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to begin batch: " + errMsg)
+	}
+
+	return nil
+}
+
+// CommitBatch ends a batch started with BeginBatch. The outermost call
+// commits every change made since the batch began.
+func (e *Engine) CommitBatch(_ context.Context) error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	if C.xapian_commit_batch(e.db) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to commit batch: " + errMsg)
+	}
+
+	return nil
+}
+
+// CancelBatch discards the changes of the open batch since its last commit
+// and ends it at every nesting level.
+func (e *Engine) CancelBatch(_ context.Context) error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	if C.xapian_cancel_batch(e.db) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to cancel batch: " + errMsg)
+	}
+
+	return nil
+}
+
+// StartBackgroundFlush moves commits off the write path: Index, IndexBatch
+// and Delete outside a batch return without committing, and a background
+// thread commits their changes on the opts schedule. Changes become visible
+// to searches when committed; Flush commits them on demand. A running
+// schedule is replaced.
+func (e *Engine) StartBackgroundFlush(opts FlushOptions) error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	cOpts := C.XapianFlushOptions{
+		interval_ms: C.int(opts.Interval.Milliseconds()),
+		max_pending: C.int(opts.MaxPending),
+	}
+	if C.xapian_set_background_flush(e.db, &cOpts) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to start background flush: " + errMsg)
+	}
+
+	return nil
+}
+
+// StopBackgroundFlush commits pending changes and returns to committing on
+// every write.
+func (e *Engine) StopBackgroundFlush() error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	if C.xapian_set_background_flush(e.db, nil) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to stop background flush: " + errMsg)
+	}
+
+	return nil
+}
+
+// Flush commits every change left pending by background flushing, so it is
+// durable and searchable when Flush returns.
+func (e *Engine) Flush(_ context.Context) error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	if C.xapian_flush(e.db) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: flush failed: " + errMsg)
+	}
+
+	return nil
+}
+
 // Search performs a keyword search and returns matching chunk IDs with scores.
 func (e *Engine) Search(_ context.Context, query string, limit int) ([]driven.SearchHit, error) {
 	e.mu.RLock()
@@ -105,12 +399,50 @@ func (e *Engine) Search(_ context.Context, query string, limit int) ([]driven.Se
 		return nil, errors.New("xapian: database is closed")
 	}
 
+	if limit <= 0 {
+		return nil, errors.New("xapian: search failed: invalid arguments")
+	}
+
+	return e.searchInto(query, limit)
+}
+
+// SearchWithSnippets performs a keyword search and builds highlighted
+// snippets of the stored chunk text for the first opts.TopN hits.
+func (e *Engine) SearchWithSnippets(
+	_ context.Context, query string, limit int, opts driven.SnippetOptions,
+) ([]driven.SearchHit, error) {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return nil, errors.New("xapian: database is closed")
+	}
+
 	cQuery := C.CString(query)
 	defer C.free(unsafe.Pointer(cQuery))
 
-	results := C.xapian_search(e.db, cQuery, C.int(limit))
+	cOpts := C.XapianSnippetOptions{
+		length: C.int(opts.Length),
+		top_n:  C.int(opts.TopN),
+	}
+	if opts.HighlightStart != "" {
+		cOpts.hi_start = C.CString(opts.HighlightStart)
+		defer C.free(unsafe.Pointer(cOpts.hi_start))
+	}
+	if opts.HighlightEnd != "" {
+		cOpts.hi_end = C.CString(opts.HighlightEnd)
+		defer C.free(unsafe.Pointer(cOpts.hi_end))
+	}
+
+	results := C.xapian_search_snippets(e.db, cQuery, C.int(limit), &cOpts)
 	defer C.xapian_free_results(results)
 
+	return toSearchHits(results)
+}
+
+// toSearchHits copies C search results into Go. Empty results are checked
+// against the last error to tell failure from no matches.
+func toSearchHits(results C.SearchResults) ([]driven.SearchHit, error) {
 	if results.results == nil {
 		// Check if there was an error or just no results
 		errMsg := C.GoString(C.xapian_get_error())
@@ -131,12 +463,182 @@ func (e *Engine) Search(_ context.Context, query string, limit int) ([]driven.Se
 			ChunkID: C.GoString(cResults[i].chunk_id),
 			Score:   float64(cResults[i].score),
 		}
+		if cResults[i].snippet != nil {
+			hits[i].Snippet = C.GoString(cResults[i].snippet)
+		}
 	}
 
 	return hits, nil
 }
 
-// Close releases resources.
+// SetResultCacheSize changes how many distinct (query, limit) results are
+// cached. Zero disables the cache.
+func (e *Engine) SetResultCacheSize(size int) error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	if C.xapian_set_cache_size(e.db, C.int(size)) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to set cache size: " + errMsg)
+	}
+
+	return nil
+}
+
+// SetMaxHitsPerDocument caps the chunks of one document returned by a
+// search. Zero returns every matching chunk.
+func (e *Engine) SetMaxHitsPerDocument(n int) error {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return errors.New("xapian: database is closed")
+	}
+
+	if C.xapian_set_collapse(e.db, C.int(n)) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return errors.New("xapian: failed to set collapse: " + errMsg)
+	}
+
+	e.perDocument.Store(int32(n))
+	return nil
+}
+
+// MaxHitsPerDocument returns the per-document cap on search hits (0 = none).
+func (e *Engine) MaxHitsPerDocument() int {
+	return int(e.perDocument.Load())
+}
+
+// Compact rewrites the index in place at the standard level, reclaiming the
+// space left by re-synced and deleted chunks. Searches keep running on the
+// old files until each shard is swapped; writes wait, and a running batch is
+// waited for first.
+func (e *Engine) Compact(_ context.Context) (driven.CompactionStats, error) {
+	return e.compact(nil, CompactOptions{})
+}
+
+// CompactTo writes a compacted copy of the committed index to target, which
+// must be missing or empty. The live index is left as it is.
+func (e *Engine) CompactTo(_ context.Context, target string, opts CompactOptions) (driven.CompactionStats, error) {
+	cTarget := C.CString(target)
+	defer C.free(unsafe.Pointer(cTarget))
+
+	return e.compact(cTarget, opts)
+}
+
+func (e *Engine) compact(target *C.char, opts CompactOptions) (driven.CompactionStats, error) {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return driven.CompactionStats{}, errors.New("xapian: database is closed")
+	}
+
+	cOpts := C.XapianCompactOptions{
+		level:      C.int(opts.Level),
+		block_size: C.int(opts.BlockSize),
+	}
+	var stats C.XapianCompactStats
+	if C.xapian_compact(e.db, target, &cOpts, &stats) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return driven.CompactionStats{}, errors.New("xapian: compaction failed: " + errMsg)
+	}
+
+	return driven.CompactionStats{
+		BytesBefore: int64(stats.bytes_before),
+		BytesAfter:  int64(stats.bytes_after),
+	}, nil
+}
+
+// NativeSearch is the native search entry point of an open engine, as C
+// pointers, for native components that search the index directly (the fused
+// hybrid engine in cgo/hybrid) instead of through Go.
+type NativeSearch struct {
+	// DB is the xapian_db handle.
+	DB unsafe.Pointer
+	// Search is xapian_search_visit.
+	Search unsafe.Pointer
+	// Error is xapian_get_error.
+	Error unsafe.Pointer
+}
+
+// AcquireNative returns the native search entry point. The engine cannot be
+// closed until release is called; the pointers must not be used after that.
+func (e *Engine) AcquireNative() (native NativeSearch, release func(), err error) {
+	e.mu.RLock()
+
+	if e.db == nil {
+		e.mu.RUnlock()
+		return NativeSearch{}, nil, errors.New("xapian: database is closed")
+	}
+
+	return NativeSearch{
+		DB:     unsafe.Pointer(e.db),
+		Search: unsafe.Pointer(C.xapian_search_visit),
+		Error:  unsafe.Pointer(C.xapian_get_error),
+	}, e.mu.RUnlock, nil
+}
+
+// CacheStats returns the search result cache counters.
+func (e *Engine) CacheStats() (CacheStats, error) {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return CacheStats{}, errors.New("xapian: database is closed")
+	}
+
+	var stats C.XapianCacheStats
+	if C.xapian_cache_stats(e.db, &stats) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return CacheStats{}, errors.New("xapian: failed to read cache stats: " + errMsg)
+	}
+
+	return CacheStats{
+		Hits:     uint64(stats.hits),
+		Misses:   uint64(stats.misses),
+		Entries:  int(stats.entries),
+		Capacity: int(stats.capacity),
+	}, nil
+}
+
+// Stats returns the database size and engine counters.
+func (e *Engine) Stats() (Stats, error) {
+	e.mu.RLock()
+	defer e.mu.RUnlock()
+
+	if e.db == nil {
+		return Stats{}, errors.New("xapian: database is closed")
+	}
+
+	var s C.XapianStats
+	if C.xapian_stats(e.db, &s) != 0 {
+		errMsg := C.GoString(C.xapian_get_error())
+		return Stats{}, errors.New("xapian: failed to read stats: " + errMsg)
+	}
+
+	stats := Stats{
+		Documents:      uint64(s.documents),
+		Revision:       uint64(s.revision),
+		PendingChanges: uint64(s.pending_changes),
+		Commits:        uint64(s.commits),
+		CommitTime:     time.Duration(s.commit_ns),
+		Searches:       uint64(s.searches),
+		SearchTime:     time.Duration(s.search_ns),
+	}
+	for i := range stats.CommitHistogram {
+		stats.CommitHistogram[i] = uint64(s.commit_histogram[i])
+		stats.SearchHistogram[i] = uint64(s.search_histogram[i])
+	}
+
+	return stats, nil
+}
+
+// Close releases resources. An open batch is committed first.
 func (e *Engine) Close() error {
 	e.mu.Lock()
 	defer e.mu.Unlock()
@@ -145,6 +647,7 @@ func (e *Engine) Close() error {
 		C.xapian_close(e.db)
 		e.db = nil
 	}
+	e.buffers.close()
 
 	return nil
 }
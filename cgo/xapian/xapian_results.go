@@ -0,0 +1,160 @@
+//go:build cgo
+
+package xapian
+
+/*
+#include "xapian_wrapper.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"errors"
+	"sync"
+	"unsafe"
+
+	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
+)
+
+const (
+	// maxPooledBuffers bounds the idle result buffers kept per engine.
+	maxPooledBuffers = 8
+
+	// defaultIDBytes is the initial ID arena size per hit of a buffer.
+	defaultIDBytes = 48
+)
+
+// resultBuffer is a reusable result buffer for xapian_search_into. Its
+// arrays, and a copy of the query, live in C memory so native code reads and
+// fills them directly; they are kept across searches so a search answered
+// from the result cache allocates nothing natively.
+type resultBuffer struct {
+	buf      C.XapianResultBuffer
+	query    *C.char
+	queryCap int
+}
+
+// newResultBuffer allocates a buffer for up to capacity hits.
+func newResultBuffer(capacity int) *resultBuffer {
+	b := &resultBuffer{}
+	b.buf.capacity = C.int(capacity)
+	b.buf.scores = (*C.double)(C.malloc(C.size_t(capacity) * C.size_t(unsafe.Sizeof(C.double(0)))))
+	b.buf.id_offsets = (*C.uint32_t)(C.malloc(C.size_t(capacity+1) * C.size_t(unsafe.Sizeof(C.uint32_t(0)))))
+	b.growIDs(capacity * defaultIDBytes)
+	return b
+}
+
+// growIDs makes room for at least n bytes of chunk IDs.
+func (b *resultBuffer) growIDs(n int) {
+	if n <= int(b.buf.ids_capacity) {
+		return
+	}
+	C.free(unsafe.Pointer(b.buf.ids))
+	b.buf.ids = (*C.char)(C.malloc(C.size_t(n)))
+	b.buf.ids_capacity = C.size_t(n)
+}
+
+// setQuery copies query into the buffer as a C string.
+func (b *resultBuffer) setQuery(query string) *C.char {
+	if len(query)+1 > b.queryCap {
+		C.free(unsafe.Pointer(b.query))
+		b.queryCap = len(query) + 1
+		b.query = (*C.char)(C.malloc(C.size_t(b.queryCap)))
+	}
+	dst := unsafe.Slice((*byte)(unsafe.Pointer(b.query)), len(query)+1)
+	copy(dst, query)
+	dst[len(query)] = 0
+	return b.query
+}
+
+// free releases the native arrays.
+func (b *resultBuffer) free() {
+	C.free(unsafe.Pointer(b.buf.scores))
+	C.free(unsafe.Pointer(b.buf.id_offsets))
+	C.free(unsafe.Pointer(b.buf.ids))
+	C.free(unsafe.Pointer(b.query))
+	*b = resultBuffer{}
+}
+
+// hits converts the first n hits of the buffer.
+func (b *resultBuffer) hits(n int) []driven.SearchHit {
+	offsets := unsafe.Slice((*uint32)(unsafe.Pointer(b.buf.id_offsets)), n+1)
+	scores := unsafe.Slice((*float64)(unsafe.Pointer(b.buf.scores)), n)
+	hits := make([]driven.SearchHit, n)
+	for i := range hits {
+		start, end := offsets[i], offsets[i+1]
+		hits[i] = driven.SearchHit{
+			ChunkID: C.GoStringN((*C.char)(unsafe.Add(unsafe.Pointer(b.buf.ids), start)), C.int(end-start)),
+			Score:   scores[i],
+		}
+	}
+	return hits
+}
+
+// bufferPool keeps idle result buffers for reuse. Buffers are only taken
+// while the engine is open, so Close can free the idle ones.
+type bufferPool struct {
+	mu   sync.Mutex
+	idle []*resultBuffer
+}
+
+// get returns a buffer with room for limit hits.
+func (p *bufferPool) get(limit int) *resultBuffer {
+	p.mu.Lock()
+	for n := len(p.idle); n > 0; n = len(p.idle) {
+		b := p.idle[n-1]
+		p.idle = p.idle[:n-1]
+		if int(b.buf.capacity) >= limit {
+			p.mu.Unlock()
+			return b
+		}
+		b.free() // Too small for this search; replaced below
+	}
+	p.mu.Unlock()
+	return newResultBuffer(limit)
+}
+
+// put returns a buffer to the pool, or frees it if the pool is full.
+func (p *bufferPool) put(b *resultBuffer) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	if len(p.idle) < maxPooledBuffers {
+		p.idle = append(p.idle, b)
+		return
+	}
+	b.free()
+}
+
+// close frees all idle buffers.
+func (p *bufferPool) close() {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	for _, b := range p.idle {
+		b.free()
+	}
+	p.idle = nil
+}
+
+// searchInto runs a search into a pooled buffer and converts the hits.
+// Caller must hold e.mu (read).
+func (e *Engine) searchInto(query string, limit int) ([]driven.SearchHit, error) {
+	b := e.buffers.get(limit)
+	defer e.buffers.put(b)
+
+	cQuery := b.setQuery(query)
+	for {
+		count := C.xapian_search_into(e.db, cQuery, C.int(limit), &b.buf)
+		if count == C.XAPIAN_ERR_BUFFER_TOO_SMALL {
+			b.growIDs(int(b.buf.ids_size))
+			continue
+		}
+		if count < 0 {
+			errMsg := C.GoString(C.xapian_get_error())
+			return nil, errors.New("xapian: search failed: " + errMsg)
+		}
+		if count == 0 {
+			return nil, nil
+		}
+		return b.hits(int(count)), nil
+	}
+}
@@ -4,13 +4,83 @@ package xapian
 
 import (
 	"context"
+	"time"
+	"unsafe"
 
 	"github.com/custodia-labs/sercha-cli/internal/core/domain"
 	"github.com/custodia-labs/sercha-cli/internal/core/ports/driven"
 )
 
-// Ensure Engine implements the interface.
-var _ driven.SearchEngine = (*Engine)(nil)
+// Ensure Engine implements the interfaces.
+var (
+	_ driven.SearchEngine            = (*Engine)(nil)
+	_ driven.BatchSearchEngine       = (*Engine)(nil)
+	_ driven.SnippetSearchEngine     = (*Engine)(nil)
+	_ driven.CollapsingSearchEngine  = (*Engine)(nil)
+	_ driven.CompactableSearchEngine = (*Engine)(nil)
+)
+
+// BatchCommitThreshold is the number of changes after which an open batch is
+// committed and continued in a new transaction.
+const BatchCommitThreshold = 10000
+
+// DefaultResultCacheSize is the number of distinct queries whose results are
+// cached by default.
+const DefaultResultCacheSize = 256
+
+// DefaultMaxHitsPerDocument is the number of chunks of one document a search
+// returns by default, keeping results diverse.
+const DefaultMaxHitsPerDocument = 3
+
+// CompactLevel trades compaction time for output size.
+type CompactLevel int
+
+const (
+	// CompactStandard leaves some free space in blocks for later updates.
+	CompactStandard CompactLevel = iota
+	// CompactFull packs blocks fully; best for indexes that rarely change.
+	CompactFull
+	// CompactFuller packs harder still, at extra cost.
+	CompactFuller
+)
+
+// CompactOptions controls compaction.
+type CompactOptions struct {
+	Level CompactLevel
+
+	// BlockSize is the output table block size in bytes (0 = default).
+	BlockSize int
+}
+
+// FlushOptions schedules background commits.
+type FlushOptions struct {
+	Interval   time.Duration
+	MaxPending int
+}
+
+// CacheStats reports the search result cache counters.
+type CacheStats struct {
+	Hits     uint64
+	Misses   uint64
+	Entries  int
+	Capacity int
+}
+
+// StatsBuckets is the number of buckets in each Stats histogram.
+const StatsBuckets = 32
+
+// Stats reports the database size and engine counters.
+type Stats struct {
+	Documents       uint64
+	Revision        uint64
+	PendingChanges  uint64
+	Commits         uint64
+	CommitTime      time.Duration
+	CommitHistogram [StatsBuckets]uint64
+	Searches        uint64
+	SearchTime      time.Duration
+	SearchHistogram [StatsBuckets]uint64
+}
 
 // Engine provides full-text search using Xapian.
 // This is a stub for builds without CGO.
@@ -25,6 +95,18 @@ func New(path string) (*Engine, error) {
 	}, nil
 }
 
+// NewSharded creates a Xapian search engine whose index is split into shards.
+func NewSharded(path string, _ int) (*Engine, error) {
+	return &Engine{
+		path: path,
+	}, nil
+}
+
+// ShardCount returns the number of shards of the index.
+func (e *Engine) ShardCount() int {
+	return 0
+}
+
 // Index adds or updates a chunk in the search index.
 func (e *Engine) Index(_ context.Context, _ domain.Chunk) error {
 	return domain.ErrNotImplemented
@@ -35,11 +117,100 @@ func (e *Engine) Delete(_ context.Context, _ string) error {
 	return domain.ErrNotImplemented
 }
 
+// BeginBatch starts grouping Index and Delete calls into one transaction.
+func (e *Engine) BeginBatch(_ context.Context) error {
+	return domain.ErrNotImplemented
+}
+
+// CommitBatch ends a batch started with BeginBatch.
+func (e *Engine) CommitBatch(_ context.Context) error {
+	return domain.ErrNotImplemented
+}
+
+// IndexBatch adds or updates many chunks in a single native call.
+func (e *Engine) IndexBatch(_ context.Context, _ []domain.Chunk) error {
+	return domain.ErrNotImplemented
+}
+
+// CancelBatch discards the changes of the open batch.
+func (e *Engine) CancelBatch(_ context.Context) error {
+	return domain.ErrNotImplemented
+}
+
+// StartBackgroundFlush moves commits to a background thread.
+func (e *Engine) StartBackgroundFlush(_ FlushOptions) error {
+	return domain.ErrNotImplemented
+}
+
+// StopBackgroundFlush returns to committing on every write.
+func (e *Engine) StopBackgroundFlush() error {
+	return nil
+}
+
+// Flush commits every pending change.
+func (e *Engine) Flush(_ context.Context) error {
+	return domain.ErrNotImplemented
+}
+
 // Search performs a keyword search and returns matching chunk IDs with scores.
 func (e *Engine) Search(_ context.Context, _ string, _ int) ([]driven.SearchHit, error) {
 	return nil, domain.ErrNotImplemented
 }
 
+// SearchWithSnippets performs a keyword search with highlighted snippets.
+func (e *Engine) SearchWithSnippets(
+	_ context.Context, _ string, _ int, _ driven.SnippetOptions,
+) ([]driven.SearchHit, error) {
+	return nil, domain.ErrNotImplemented
+}
+
+// SetResultCacheSize changes how many distinct query results are cached.
+func (e *Engine) SetResultCacheSize(_ int) error {
+	return domain.ErrNotImplemented
+}
+
+// SetMaxHitsPerDocument caps the chunks of one document returned by a search.
+func (e *Engine) SetMaxHitsPerDocument(_ int) error {
+	return domain.ErrNotImplemented
+}
+
+// MaxHitsPerDocument returns the per-document cap on search hits.
+func (e *Engine) MaxHitsPerDocument() int {
+	return 0
+}
+
+// Compact rewrites the index in place.
+func (e *Engine) Compact(_ context.Context) (driven.CompactionStats, error) {
+	return driven.CompactionStats{}, domain.ErrNotImplemented
+}
+
+// CompactTo writes a compacted copy of the index to target.
+func (e *Engine) CompactTo(_ context.Context, _ string, _ CompactOptions) (driven.CompactionStats, error) {
+	return driven.CompactionStats{}, domain.ErrNotImplemented
+}
+
+// NativeSearch is the native search entry point of an open engine.
+type NativeSearch struct {
+	DB     unsafe.Pointer
+	Search unsafe.Pointer
+	Error  unsafe.Pointer
+}
+
+// AcquireNative returns the native search entry point.
+func (e *Engine) AcquireNative() (native NativeSearch, release func(), err error) {
+	return NativeSearch{}, nil, domain.ErrNotImplemented
+}
+
+// CacheStats returns the search result cache counters.
+func (e *Engine) CacheStats() (CacheStats, error) {
+	return CacheStats{}, domain.ErrNotImplemented
+}
+
+// Stats returns the database size and engine counters.
+func (e *Engine) Stats() (Stats, error) {
+	return Stats{}, domain.ErrNotImplemented
+}
+
 // Close releases resources.
 func (e *Engine) Close() error {
 	return nil
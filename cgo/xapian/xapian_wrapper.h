@@ -1,7 +1,8 @@
 /*
  * xapian_wrapper.h - C-compatible wrapper for Xapian C++ API
  *
- * This header provides a C interface to Xapian for use with CGO.
+ * This header provides a C interface to Xapian for use with CGO. The same
+ * sources build the sercha_xapian static library in clib/.
  * All functions use C types to ensure compatibility with Go.
  */
 
@@ -12,20 +13,51 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+#include <stdint.h>
+
 /* Opaque handle to Xapian database */
 typedef void* xapian_db;
 
 /*
  * xapian_open - Open or create a Xapian database
  *
+ * A sharded database created by xapian_open_sharded is opened with all its
+ * shards.
+ *
  * @param path: Directory path for the database
  * @return: Database handle, or NULL on error
  */
 xapian_db xapian_open(const char* path);
 
+/*
+ * xapian_open_sharded - Open or create a database split into shards
+ *
+ * Chunks are routed to one of num_shards sub-databases by a hash of their
+ * chunk_id. Each shard has its own writer, so writes to different shards
+ * run in parallel; searches cover all shards as one combined database.
+ * The shard count is fixed at creation.
+ *
+ * @param path: Directory for the shards (missing or empty to create)
+ * @param num_shards: Number of shards; must match an existing database
+ * @return: Database handle, or NULL on error (also if path holds an
+ *          unsharded database)
+ */
+xapian_db xapian_open_sharded(const char* path, int num_shards);
+
+/*
+ * xapian_shard_count - Number of shards of an open database
+ *
+ * @param db: Database handle
+ * @return: Shard count (1 for an unsharded database), -1 on error
+ */
+int xapian_shard_count(xapian_db db);
+
 /*
  * xapian_close - Close a Xapian database
  *
+ * An open batch is committed first.
+ *
  * @param db: Database handle
  */
 void xapian_close(xapian_db db);
@@ -41,6 +73,36 @@ void xapian_close(xapian_db db);
  */
 int xapian_index(xapian_db db, const char* chunk_id, const char* doc_id, const char* content);
 
+/*
+ * XapianDocument - One chunk for xapian_index_batch
+ *
+ * Fields are length-delimited and need not be NUL-terminated, so callers can
+ * pass pointers into their own buffers. doc_id may be NULL.
+ */
+typedef struct {
+    const char* chunk_id;
+    size_t chunk_id_len;
+    const char* doc_id;
+    size_t doc_id_len;
+    const char* content;
+    size_t content_len;
+} XapianDocument;
+
+/*
+ * xapian_index_batch - Add or update many documents in one call
+ *
+ * All n documents are indexed with the database's long-lived term generator
+ * and committed together: outside a batch they form one transaction of their
+ * own, inside one (xapian_begin_batch) they join it.
+ *
+ * @param db: Database handle
+ * @param docs: Array of n documents
+ * @param n: Number of documents
+ * @return: 0 on success, -1 on error (no document of the call is committed,
+ *          unless a commit fails after another shard committed)
+ */
+int xapian_index_batch(xapian_db db, const XapianDocument* docs, int n);
+
 /*
  * xapian_delete - Remove a document from the index
  *
@@ -50,12 +112,121 @@ int xapian_index(xapian_db db, const char* chunk_id, const char* doc_id, const c
  */
 int xapian_delete(xapian_db db, const char* chunk_id);
 
+/*
+ * xapian_begin_batch - Start grouping index and delete calls into one transaction
+ *
+ * Until the matching xapian_commit_batch, xapian_index and xapian_delete do
+ * not commit individually; the whole batch becomes durable in one commit, and
+ * a crash before it leaves the database as it was before the batch. Batches
+ * nest: only the outermost begin/commit pair starts and commits the
+ * transaction. A sharded database runs one transaction per shard, committed
+ * together at the end.
+ *
+ * @param db: Database handle
+ * @param max_changes: Commit and continue in a new transaction after this many
+ *                     changes, bounding memory use and lost work (0 = no limit)
+ * @return: 0 on success, -1 on error
+ */
+int xapian_begin_batch(xapian_db db, int max_changes);
+
+/*
+ * xapian_commit_batch - End a batch, committing it if it is the outermost one
+ *
+ * @param db: Database handle
+ * @return: 0 on success, -1 on error
+ */
+int xapian_commit_batch(xapian_db db);
+
+/*
+ * xapian_cancel_batch - Discard all changes since the last batch commit
+ *
+ * Ends the batch at every nesting level.
+ *
+ * @param db: Database handle
+ * @return: 0 on success, -1 on error
+ */
+int xapian_cancel_batch(xapian_db db);
+
+/*
+ * XapianFlushOptions - Options for xapian_set_background_flush
+ */
+typedef struct {
+    int interval_ms;  /* Commit deferred changes at least this often (0 = 1000) */
+    int max_pending;  /* Commit early once a shard has this many (0 = 1000) */
+} XapianFlushOptions;
+
+/*
+ * xapian_set_background_flush - Commit changes from a background thread
+ *
+ * While enabled, xapian_index, xapian_index_batch and xapian_delete outside a
+ * batch no longer commit (and fsync) before returning: their changes are
+ * committed by a per-handle thread every interval or once enough are
+ * pending, and become visible to searches then. A crash loses at most the
+ * changes since the last background commit; xapian_flush commits them on
+ * demand. xapian_index_batch stays all-or-nothing. Batches are unaffected.
+ *
+ * @param db: Database handle
+ * @param opts: Flush schedule, or NULL to stop the thread. Stopping (or
+ *              replacing the schedule) commits the pending changes first.
+ * @return: 0 on success, -1 on error
+ */
+int xapian_set_background_flush(xapian_db db, const XapianFlushOptions* opts);
+
+/*
+ * xapian_flush - Commit all changes deferred by background flushing
+ *
+ * A barrier: when it returns 0, every change that returned before the call
+ * is durable and visible to searches. A no-op without background flushing.
+ * A failed background commit is retried here and reported.
+ *
+ * @param db: Database handle
+ * @return: 0 on success, -1 on error
+ */
+int xapian_flush(xapian_db db);
+
+/*
+ * XapianCompactOptions - Options for xapian_compact
+ */
+typedef struct {
+    int level;       /* 0 = standard, 1 = full, 2 = fuller (smallest, slowest) */
+    int block_size;  /* Output table block size in bytes (0 = default) */
+} XapianCompactOptions;
+
+/*
+ * XapianCompactStats - Database size before and after compaction
+ */
+typedef struct {
+    uint64_t bytes_before;
+    uint64_t bytes_after;
+} XapianCompactStats;
+
+/*
+ * xapian_compact - Rewrite the database without the free space left by churn
+ *
+ * With a target_path, the committed state is compacted into that directory
+ * (which must be missing or empty) and the live database is left as it is.
+ * Without one, the database is compacted in place while the handle stays
+ * usable: a running batch is waited for, each shard is compacted with its
+ * writes blocked and then swapped in atomically for searches, which keep
+ * running throughout. An interrupted swap is completed or undone on the next
+ * open.
+ *
+ * @param db: Database handle
+ * @param target_path: Output directory, or NULL to compact in place
+ * @param opts: Compaction options, or NULL for defaults
+ * @param stats: Receives the sizes before and after (may be NULL)
+ * @return: 0 on success, -1 on error
+ */
+int xapian_compact(xapian_db db, const char* target_path, const XapianCompactOptions* opts,
+                   XapianCompactStats* stats);
+
 /*
  * SearchResult - Single search result
  */
 typedef struct {
     char* chunk_id;
     double score;
+    char* snippet;  /* Highlighted excerpt, or NULL if not requested */
 } SearchResult;
 
 /*
@@ -76,6 +247,107 @@ typedef struct {
  */
 SearchResults xapian_search(xapian_db db, const char* query, int limit);
 
+/*
+ * XapianResultBuffer - Caller-owned result buffer for xapian_search_into
+ *
+ * The caller allocates the arrays once and reuses the buffer across
+ * searches, so a search answered from the result cache allocates nothing.
+ * Hit i's chunk ID is ids[id_offsets[i] .. id_offsets[i + 1]) (not
+ * NUL-terminated).
+ */
+typedef struct {
+    int capacity;          /* Hits the arrays hold (at least limit) */
+    double* scores;        /* capacity entries */
+    uint32_t* id_offsets;  /* capacity + 1 entries */
+    char* ids;             /* Packed chunk IDs */
+    size_t ids_capacity;   /* Bytes available in ids */
+    size_t ids_size;       /* Out: bytes used (or needed) by the IDs */
+} XapianResultBuffer;
+
+/* Returned by xapian_search_into when the chunk IDs do not fit */
+#define XAPIAN_ERR_BUFFER_TOO_SMALL (-2)
+
+/*
+ * xapian_search_into - Perform a search query into a caller-owned buffer
+ *
+ * Like xapian_search, but writes the results into buf instead of allocating
+ * them.
+ *
+ * @param db: Database handle
+ * @param query: Search query string
+ * @param limit: Maximum number of results (at most buf->capacity)
+ * @param buf: Receives the results
+ * @return: Number of hits, XAPIAN_ERR_BUFFER_TOO_SMALL if the IDs do not fit
+ *          (grow ids to buf->ids_size and retry), or -1 on error
+ */
+int xapian_search_into(xapian_db db, const char* query, int limit, XapianResultBuffer* buf);
+
+/*
+ * xapian_hit_visitor - Receives one hit of xapian_search_visit
+ *
+ * chunk_id is not NUL-terminated and is only valid during the call.
+ */
+typedef void (*xapian_hit_visitor)(void* ctx, const char* chunk_id, size_t chunk_id_len,
+                                   double score);
+
+/*
+ * xapian_search_visit - Perform a search query without allocating results
+ *
+ * Like xapian_search, but each hit is passed to visit in rank order instead
+ * of being copied into a SearchResults array. Meant for native callers that
+ * consume the hits directly (the hybrid engine in cgo/hybrid).
+ *
+ * @param db: Database handle
+ * @param query: Search query string
+ * @param limit: Maximum number of results
+ * @param visit: Called once per hit, best first
+ * @param ctx: Passed through to visit
+ * @return: Number of hits visited, or -1 on error
+ */
+int xapian_search_visit(xapian_db db, const char* query, int limit,
+                        xapian_hit_visitor visit, void* ctx);
+
+/*
+ * XapianSnippetOptions - Snippet generation for xapian_search_snippets
+ */
+typedef struct {
+    int length;            /* Maximum snippet length in bytes (<= 0: 200) */
+    int top_n;             /* Snippets for the first top_n hits only (<= 0: all) */
+    const char* hi_start;  /* Inserted before each matched term (NULL: none) */
+    const char* hi_end;    /* Inserted after each matched term (NULL: none) */
+} XapianSnippetOptions;
+
+/*
+ * xapian_search_snippets - Perform a search query and build highlighted snippets
+ *
+ * Like xapian_search, but the first top_n results also carry a snippet of the
+ * stored chunk text, chosen and highlighted for the query in the same pass.
+ * Results beyond top_n have a NULL snippet. Results are cached with their
+ * snippets, keyed by the snippet options as well as the query and limit.
+ *
+ * @param db: Database handle
+ * @param query: Search query string
+ * @param limit: Maximum number of results
+ * @param opts: Snippet options
+ * @return: SearchResults struct (caller must free with xapian_free_results)
+ */
+SearchResults xapian_search_snippets(xapian_db db, const char* query, int limit,
+                                     const XapianSnippetOptions* opts);
+
+/*
+ * xapian_set_collapse - Cap the hits returned per parent document
+ *
+ * Applies to subsequent searches: only the best max_per_document chunks of a
+ * document (by the doc_id given at indexing) are returned, so one long
+ * document cannot fill the whole result limit. Chunks indexed without a
+ * doc_id are not collapsed.
+ *
+ * @param db: Database handle
+ * @param max_per_document: Hits kept per document (0 = no cap, the default)
+ * @return: 0 on success, -1 on error
+ */
+int xapian_set_collapse(xapian_db db, int max_per_document);
+
 /*
  * xapian_free_results - Free search results memory
  *
@@ -83,6 +355,73 @@ SearchResults xapian_search(xapian_db db, const char* query, int limit);
  */
 void xapian_free_results(SearchResults results);
 
+/*
+ * XapianCacheStats - Result cache counters
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    int entries;
+    int capacity;
+} XapianCacheStats;
+
+/*
+ * xapian_set_cache_size - Enable or resize the search result cache
+ *
+ * Results are cached per (normalized query, limit, snippet options) and
+ * dropped on the first search after a commit, so cached answers are never
+ * staler than a search would be. The cache is disabled (capacity 0) until
+ * this is called.
+ *
+ * @param db: Database handle
+ * @param capacity: Maximum cached queries, least recently used evicted first
+ *                  (0 disables the cache)
+ * @return: 0 on success, -1 on error
+ */
+int xapian_set_cache_size(xapian_db db, int capacity);
+
+/*
+ * xapian_cache_stats - Read the result cache counters
+ *
+ * @param db: Database handle
+ * @param stats: Receives the counters
+ * @return: 0 on success, -1 on error
+ */
+int xapian_cache_stats(xapian_db db, XapianCacheStats* stats);
+
+/*
+ * XapianStats - Engine counters and sizes
+ *
+ * Histograms have XAPIAN_STATS_BUCKETS log2 buckets of microseconds: bucket
+ * 0 counts values below 2 and bucket i (i > 0) values in [2^i, 2^(i+1)); the
+ * last bucket is open-ended. Counters cover the time since the database was
+ * opened.
+ */
+#define XAPIAN_STATS_BUCKETS 32
+
+typedef struct {
+    uint64_t documents;        /* Committed chunks, summed over shards */
+    uint64_t revision;         /* Committed revisions, summed over shards */
+    uint64_t pending_changes;  /* Changes awaiting the background flusher */
+    uint64_t commits;
+    uint64_t commit_ns;        /* Summed commit latency */
+    uint64_t commit_histogram[XAPIAN_STATS_BUCKETS];
+    uint64_t searches;         /* Including those answered from the cache */
+    uint64_t search_ns;        /* Summed search latency */
+    uint64_t search_histogram[XAPIAN_STATS_BUCKETS];
+} XapianStats;
+
+/*
+ * xapian_stats - Read the engine counters
+ *
+ * Waits for each shard's writer in turn, so a long commit delays the call.
+ *
+ * @param db: Database handle
+ * @param stats: Receives the counters
+ * @return: 0 on success, -1 on error
+ */
+int xapian_stats(xapian_db db, XapianStats* stats);
+
 /*
  * xapian_get_error - Get the last error message
  *
@@ -0,0 +1,299 @@
+/*
+ * bench_workloads.cpp - Reproducible workloads for the sercha_bench suite
+ *
+ * Synthetic data uses only mt19937_64 output and exact IEEE arithmetic
+ * (normal deviates are approximated by an Irwin-Hall sum of uniforms, term
+ * weights are 1/rank), so the same seed yields the same bytes everywhere.
+ */
+
+#include "bench_workloads.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+static const size_t kClusters = 64;
+static const float kClusterSpread = 0.5f;
+static const size_t kVocabulary = 5000;
+static const size_t kWordsPerDocument = 80;
+static const size_t kChunksPerDocument = 4;
+
+static size_t env_size(const char* name, size_t fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(value, &end, 10);
+    return end != value && *end == '\0' && parsed > 0 ? static_cast<size_t>(parsed) : fallback;
+}
+
+static std::string env_string(const char* name) {
+    const char* value = std::getenv(name);
+    return value != nullptr ? value : "";
+}
+
+BenchConfig config_from_env() {
+    BenchConfig config;
+    config.count = env_size("SERCHA_BENCH_COUNT", config.count);
+    config.queries = env_size("SERCHA_BENCH_QUERIES", config.queries);
+    config.dimension = static_cast<int>(env_size("SERCHA_BENCH_DIM", config.dimension));
+    config.seed = env_size("SERCHA_BENCH_SEED", config.seed);
+    config.vectors_path = env_string("SERCHA_BENCH_VECTORS");
+    config.queries_path = env_string("SERCHA_BENCH_QUERY_VECTORS");
+    config.work_dir = env_string("SERCHA_BENCH_DIR");
+    return config;
+}
+
+// Uniform double in [0, 1) from the top 53 bits
+static double uniform(std::mt19937_64& rng) {
+    return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+}
+
+// Approximately standard normal: the sum of four uniforms has variance 1/3
+static float gaussian(std::mt19937_64& rng) {
+    double sum = uniform(rng) + uniform(rng) + uniform(rng) + uniform(rng);
+    return static_cast<float>((sum - 2.0) * std::sqrt(3.0));
+}
+
+// Helper: append n points scattered around random cluster centres
+static void clustered_points(std::mt19937_64& rng, const std::vector<float>& centres,
+                             int dimension, size_t n, std::vector<float>* out) {
+    const size_t clusters = centres.size() / dimension;
+    out->reserve(out->size() + n * dimension);
+    for (size_t i = 0; i < n; i++) {
+        const float* centre = centres.data() + (rng() % clusters) * dimension;
+        for (int d = 0; d < dimension; d++) {
+            out->push_back(centre[d] + kClusterSpread * gaussian(rng));
+        }
+    }
+}
+
+// Helper: read up to max_count vectors of an .fvecs file ([int32 dim][dim
+// floats] per vector) into out. Sets *dimension from the first record.
+static size_t read_fvecs(const std::string& path, size_t max_count, int* dimension,
+                         std::vector<float>* out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    size_t count = 0;
+    int32_t dim = 0;
+    while (count < max_count && in.read(reinterpret_cast<char*>(&dim), sizeof(dim))) {
+        if (dim <= 0 || (*dimension != 0 && dim != *dimension)) {
+            throw std::runtime_error("inconsistent vector dimension in " + path);
+        }
+        *dimension = dim;
+        size_t start = out->size();
+        out->resize(start + dim);
+        if (!in.read(reinterpret_cast<char*>(out->data() + start), dim * sizeof(float))) {
+            throw std::runtime_error("truncated vector in " + path);
+        }
+        count++;
+    }
+    return count;
+}
+
+VectorSet load_vectors(const BenchConfig& config) {
+    VectorSet set;
+    if (config.vectors_path.empty()) {
+        set.name = "synthetic";
+        set.dimension = config.dimension;
+        std::mt19937_64 rng(config.seed);
+        std::vector<float> centres;
+        for (size_t i = 0; i < kClusters * set.dimension; i++) {
+            centres.push_back(gaussian(rng));
+        }
+        clustered_points(rng, centres, set.dimension, config.count, &set.base);
+        clustered_points(rng, centres, set.dimension, config.queries, &set.queries);
+        set.count = config.count;
+        set.num_queries = config.queries;
+    } else {
+        set.name = config.vectors_path;
+        const bool split = config.queries_path.empty();
+        size_t read = read_fvecs(config.vectors_path, config.count + (split ? config.queries : 0),
+                                 &set.dimension, &set.base);
+        if (split) {
+            if (read <= config.queries) {
+                throw std::runtime_error("too few vectors in " + config.vectors_path);
+            }
+            set.num_queries = config.queries;
+            set.count = read - config.queries;
+            set.queries.assign(set.base.begin() + set.count * set.dimension, set.base.end());
+            set.base.resize(set.count * set.dimension);
+        } else {
+            set.count = read;
+            set.num_queries = read_fvecs(config.queries_path, config.queries, &set.dimension,
+                                         &set.queries);
+        }
+        if (set.count == 0 || set.num_queries == 0) {
+            throw std::runtime_error("no vectors read from " + config.vectors_path);
+        }
+    }
+
+    char id[32];
+    set.ids.reserve(set.count);
+    for (size_t i = 0; i < set.count; i++) {
+        snprintf(id, sizeof(id), "v%08zu", i);
+        set.ids.emplace_back(id);
+    }
+    for (const std::string& s : set.ids) {
+        set.id_ptrs.push_back(s.c_str());
+    }
+    return set;
+}
+
+long vector_index_of(const char* id, size_t len) {
+    if (len < 2 || id[0] != 'v') {
+        return -1;
+    }
+    long index = 0;
+    for (size_t i = 1; i < len; i++) {
+        if (id[i] < '0' || id[i] > '9') {
+            return -1;
+        }
+        index = index * 10 + (id[i] - '0');
+    }
+    return index;
+}
+
+// Helper: unit-length copy of n vectors of set's dimension
+static std::vector<float> normalized(const float* data, size_t n, int dimension) {
+    std::vector<float> out(data, data + n * dimension);
+    for (size_t i = 0; i < n; i++) {
+        float* v = out.data() + i * dimension;
+        double norm = 0;
+        for (int d = 0; d < dimension; d++) {
+            norm += static_cast<double>(v[d]) * v[d];
+        }
+        float scale = norm > 0 ? static_cast<float>(1.0 / std::sqrt(norm)) : 0.0f;
+        for (int d = 0; d < dimension; d++) {
+            v[d] *= scale;
+        }
+    }
+    return out;
+}
+
+std::vector<std::vector<uint32_t>> exact_neighbours(const VectorSet& set, size_t k) {
+    const int dim = set.dimension;
+    const std::vector<float> base = normalized(set.base.data(), set.count, dim);
+    const std::vector<float> queries = normalized(set.queries.data(), set.num_queries, dim);
+    k = std::min(k, set.count);
+
+    std::vector<std::vector<uint32_t>> truth(set.num_queries);
+    auto solve = [&](size_t begin, size_t end) {
+        std::vector<std::pair<float, uint32_t>> scored(set.count);
+        for (size_t q = begin; q < end; q++) {
+            const float* query = queries.data() + q * dim;
+            for (size_t i = 0; i < set.count; i++) {
+                const float* v = base.data() + i * dim;
+                float dot = 0;
+                for (int d = 0; d < dim; d++) {
+                    dot += query[d] * v[d];
+                }
+                scored[i] = {-dot, static_cast<uint32_t>(i)};
+            }
+            std::partial_sort(scored.begin(), scored.begin() + k, scored.end());
+            for (size_t i = 0; i < k; i++) {
+                truth[q].push_back(scored[i].second);
+            }
+        }
+    };
+
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t per_worker = (set.num_queries + workers - 1) / workers;
+    std::vector<std::thread> threads;
+    for (size_t begin = 0; begin < set.num_queries; begin += per_worker) {
+        threads.emplace_back(solve, begin, std::min(set.num_queries, begin + per_worker));
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    return truth;
+}
+
+// Helper: pronounceable word for a vocabulary rank; distinct ranks give
+// distinct words
+static std::string word(size_t rank) {
+    static const char kConsonants[] = "bcdfghjklmnprstvz";
+    static const char kVowels[] = "aeiou";
+    const size_t syllables = (sizeof(kConsonants) - 1) * (sizeof(kVowels) - 1);
+    std::string w;
+    for (size_t r = rank, n = 0; n < 2 || r > 0; r /= syllables, n++) {
+        size_t s = r % syllables;
+        w += kConsonants[s / (sizeof(kVowels) - 1)];
+        w += kVowels[s % (sizeof(kVowels) - 1)];
+    }
+    return w;
+}
+
+DocumentSet make_documents(const BenchConfig& config) {
+    std::vector<std::string> vocabulary;
+    std::vector<double> cumulative;
+    double total = 0;
+    for (size_t r = 0; r < kVocabulary; r++) {
+        vocabulary.push_back(word(r));
+        total += 1.0 / static_cast<double>(r + 1);  // Zipf, s = 1
+        cumulative.push_back(total);
+    }
+
+    std::mt19937_64 rng(config.seed ^ 0x9e3779b97f4a7c15ull);
+    auto zipf_word = [&]() -> const std::string& {
+        double u = uniform(rng) * total;
+        size_t r = std::upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+        return vocabulary[std::min(r, kVocabulary - 1)];
+    };
+
+    DocumentSet docs;
+    char id[32];
+    for (size_t i = 0; i < config.count; i++) {
+        snprintf(id, sizeof(id), "c%08zu", i);
+        docs.ids.emplace_back(id);
+        snprintf(id, sizeof(id), "d%08zu", i / kChunksPerDocument);
+        docs.doc_ids.emplace_back(id);
+        std::string content;
+        for (size_t w = 0; w < kWordsPerDocument; w++) {
+            if (w > 0) {
+                content += ' ';
+            }
+            content += zipf_word();
+        }
+        docs.content_bytes += content.size();
+        docs.contents.push_back(std::move(content));
+    }
+
+    // Mid-frequency terms: common enough to match, rare enough to rank
+    for (size_t q = 0; q < config.queries; q++) {
+        size_t terms = 1 + q % 3;
+        std::string query;
+        for (size_t t = 0; t < terms; t++) {
+            if (t > 0) {
+                query += ' ';
+            }
+            query += vocabulary[20 + rng() % 480];
+        }
+        docs.queries.push_back(std::move(query));
+    }
+    return docs;
+}
+
+std::string make_temp_dir(const BenchConfig& config, const std::string& prefix) {
+    std::string parent = config.work_dir.empty()
+        ? std::filesystem::temp_directory_path().string() : config.work_dir;
+    std::string pattern = parent + "/sercha-bench-" + prefix + "-XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    if (mkdtemp(path.data()) == nullptr) {
+        throw std::runtime_error("cannot create a directory in " + parent + ": " +
+                                 std::strerror(errno));
+    }
+    return path.data();
+}
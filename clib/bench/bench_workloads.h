@@ -0,0 +1,71 @@
+/*
+ * bench_workloads.h - Reproducible workloads for the sercha_bench suite
+ *
+ * Vectors are either synthetic (clustered points drawn from a seeded
+ * generator with no platform-dependent maths, so every machine benchmarks
+ * the same data) or real embeddings read from .fvecs files. Documents for
+ * the Xapian benchmarks are synthetic text over a Zipf-distributed
+ * vocabulary.
+ */
+
+#ifndef SERCHA_BENCH_WORKLOADS_H
+#define SERCHA_BENCH_WORKLOADS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Benchmark configuration, read from SERCHA_BENCH_* environment variables
+struct BenchConfig {
+    size_t count = 20000;         // SERCHA_BENCH_COUNT: base vectors and documents
+    size_t queries = 200;         // SERCHA_BENCH_QUERIES
+    int dimension = 384;          // SERCHA_BENCH_DIM (synthetic vectors only)
+    uint64_t seed = 42;           // SERCHA_BENCH_SEED
+    std::string vectors_path;     // SERCHA_BENCH_VECTORS: base vectors (.fvecs)
+    std::string queries_path;     // SERCHA_BENCH_QUERY_VECTORS: queries (.fvecs)
+    std::string work_dir;         // SERCHA_BENCH_DIR: parent of the index directories
+};
+
+BenchConfig config_from_env();
+
+struct VectorSet {
+    std::string name;  // "synthetic" or the base file path
+    int dimension = 0;
+    size_t count = 0;
+    size_t num_queries = 0;
+    std::vector<float> base;     // count x dimension
+    std::vector<float> queries;  // num_queries x dimension
+    std::vector<std::string> ids;
+    std::vector<const char*> id_ptrs;  // ids[i].c_str(), for batch calls
+
+    const float* vector(size_t i) const { return base.data() + i * dimension; }
+    const float* query(size_t i) const { return queries.data() + i * dimension; }
+};
+
+// Builds the vector workload for config. A base file without a query file
+// keeps its last config.queries vectors as queries. Throws std::runtime_error
+// if a file cannot be read.
+VectorSet load_vectors(const BenchConfig& config);
+
+// Base vector index encoded in a chunk ID from VectorSet::ids, or -1
+long vector_index_of(const char* id, size_t len);
+
+// Exact cosine nearest neighbours of every query: row q holds the k closest
+// base indices, closest first.
+std::vector<std::vector<uint32_t>> exact_neighbours(const VectorSet& set, size_t k);
+
+struct DocumentSet {
+    std::vector<std::string> ids;
+    std::vector<std::string> doc_ids;
+    std::vector<std::string> contents;
+    std::vector<std::string> queries;  // One to three mid-frequency terms each
+    size_t content_bytes = 0;
+};
+
+DocumentSet make_documents(const BenchConfig& config);
+
+// Fresh directory below config.work_dir (or the system temporary directory)
+std::string make_temp_dir(const BenchConfig& config, const std::string& prefix);
+
+#endif // SERCHA_BENCH_WORKLOADS_H
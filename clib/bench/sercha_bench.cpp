@@ -0,0 +1,525 @@
+/*
+ * sercha_bench.cpp - Native benchmark suite for the clib engines
+ *
+ * Drives sercha_hnsw and sercha_xapian through their C APIs, as the Go
+ * bindings do. Covers HNSW add and batch-add throughput, search QPS with
+ * p50/p99 latency and recall@k against brute force at several k/ef values,
+ * open time for each precision, and Xapian index and search throughput.
+ *
+ * Workloads come from SERCHA_BENCH_* environment variables (see
+ * bench_workloads.h); everything else is a Google Benchmark flag. Use
+ * --benchmark_format=json or --benchmark_out=FILE for machine-readable
+ * results; the workload is recorded in the JSON context.
+ */
+
+#include "bench_workloads.h"
+#include "hnsw_wrapper.h"
+#include "xapian_wrapper.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const size_t kMaxK = 100;
+static const int kSearchKs[] = {10, 100};
+static const int kSearchEfs[] = {16, 64, 128, 256};
+static const int kAddBatchSizes[] = {64, 1024};
+static const int kIndexBatchSizes[] = {256};
+static const size_t kMaxSingleCommits = 2000;  // Each one fsyncs
+static const int kKeywordLimit = 10;
+
+struct PrecisionInfo {
+    HnswPrecision precision;
+    const char* name;
+};
+
+static const PrecisionInfo kPrecisions[] = {
+    {HNSW_PRECISION_FLOAT32, "f32"},
+    {HNSW_PRECISION_FLOAT16, "f16"},
+    {HNSW_PRECISION_INT8, "i8"},
+};
+
+// Shared workloads and the indexes built from them. Indexes used by more
+// than one benchmark are built on first use, outside any timed region.
+struct Suite {
+    BenchConfig config;
+    VectorSet vectors;
+    DocumentSet documents;
+    std::vector<std::vector<uint32_t>> truth;  // Exact top kMaxK per query
+    std::map<HnswPrecision, HnswIndex*> graphs;
+    std::map<HnswPrecision, std::string> graph_dirs;
+    std::map<HnswPrecision, std::string> closed_graphs;  // Copies for open benchmarks
+    xapian_db keyword_db = nullptr;
+    std::vector<std::string> dirs;
+
+    ~Suite() {
+        for (auto& entry : graphs) {
+            hnsw_close(entry.second);
+        }
+        if (keyword_db != nullptr) {
+            xapian_close(keyword_db);
+        }
+        for (const std::string& dir : dirs) {
+            std::error_code ec;
+            std::filesystem::remove_all(dir, ec);
+        }
+    }
+
+    std::string new_dir(const std::string& prefix) {
+        dirs.push_back(make_temp_dir(config, prefix));
+        return dirs.back();
+    }
+
+    // Searchable, checkpointed index over all base vectors
+    HnswIndex* graph(HnswPrecision precision) {
+        auto it = graphs.find(precision);
+        if (it != graphs.end()) {
+            return it->second;
+        }
+        std::string dir = new_dir("graph");
+        HnswIndex* idx = hnsw_create(dir.c_str(), vectors.dimension,
+                                     static_cast<int>(vectors.count), precision);
+        if (idx == nullptr) {
+            throw std::runtime_error("hnsw_create failed");
+        }
+        graphs[precision] = idx;
+        graph_dirs[precision] = dir;
+        if (hnsw_add_batch(idx, vectors.id_ptrs.data(), vectors.base.data(),
+                           static_cast<int>(vectors.count), vectors.dimension, 0) != 0 ||
+            hnsw_checkpoint(idx) != 0) {
+            throw std::runtime_error("building the index failed");
+        }
+        return idx;
+    }
+
+    // Directory holding a copy of graph(precision) that no handle has open
+    const std::string& closed_graph(HnswPrecision precision) {
+        auto it = closed_graphs.find(precision);
+        if (it != closed_graphs.end()) {
+            return it->second;
+        }
+        graph(precision);
+        std::string dir = new_dir("open");
+        std::filesystem::copy(graph_dirs.at(precision), dir,
+                              std::filesystem::copy_options::recursive |
+                                  std::filesystem::copy_options::overwrite_existing);
+        return closed_graphs[precision] = dir;
+    }
+
+    const std::vector<std::vector<uint32_t>>& neighbours() {
+        if (truth.empty()) {
+            truth = exact_neighbours(vectors, kMaxK);
+        }
+        return truth;
+    }
+
+    // Database holding every synthetic document
+    xapian_db keyword() {
+        if (keyword_db != nullptr) {
+            return keyword_db;
+        }
+        std::string dir = new_dir("keyword");
+        keyword_db = xapian_open(dir.c_str());
+        if (keyword_db == nullptr) {
+            throw std::runtime_error("xapian_open failed: " + std::string(xapian_get_error()));
+        }
+        std::vector<XapianDocument> docs = xapian_documents();
+        const size_t batch = 1000;
+        for (size_t i = 0; i < docs.size(); i += batch) {
+            int n = static_cast<int>(std::min(batch, docs.size() - i));
+            if (xapian_index_batch(keyword_db, docs.data() + i, n) != 0) {
+                throw std::runtime_error("indexing failed: " + std::string(xapian_get_error()));
+            }
+        }
+        return keyword_db;
+    }
+
+    std::vector<XapianDocument> xapian_documents() const {
+        std::vector<XapianDocument> docs(documents.ids.size());
+        for (size_t i = 0; i < docs.size(); i++) {
+            docs[i] = {documents.ids[i].data(), documents.ids[i].size(),
+                       documents.doc_ids[i].data(), documents.doc_ids[i].size(),
+                       documents.contents[i].data(), documents.contents[i].size()};
+        }
+        return docs;
+    }
+};
+
+static Suite* suite = nullptr;
+
+using Clock = std::chrono::steady_clock;
+
+static double micros_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Helper: report p50 and p99 of per-operation latencies (microseconds)
+static void report_latencies(benchmark::State& state, std::vector<double>* latencies) {
+    if (latencies->empty()) {
+        return;
+    }
+    std::sort(latencies->begin(), latencies->end());
+    const size_t n = latencies->size();
+    state.counters["p50_us"] = (*latencies)[n / 2];
+    state.counters["p99_us"] = (*latencies)[std::min(n - 1, n * 99 / 100)];
+}
+
+// =============================================================================
+// HNSW
+// =============================================================================
+
+// Inserts every base vector into a fresh index, one call per vector
+static void bench_hnsw_add(benchmark::State& state, HnswPrecision precision) {
+    const VectorSet& set = suite->vectors;
+    std::string dir = make_temp_dir(suite->config, "add");
+    HnswIndex* idx = hnsw_create(dir.c_str(), set.dimension, static_cast<int>(set.count),
+                                 precision);
+    if (idx == nullptr) {
+        state.SkipWithError("hnsw_create failed");
+        return;
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        if (hnsw_add(idx, set.id_ptrs[i], set.vector(i), set.dimension) != 0) {
+            state.SkipWithError("hnsw_add failed");
+            break;
+        }
+        i++;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(i));
+
+    hnsw_close(idx);
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// Inserts every base vector into a fresh index, batch vectors per call
+static void bench_hnsw_add_batch(benchmark::State& state, HnswPrecision precision, int batch) {
+    const VectorSet& set = suite->vectors;
+    std::string dir = make_temp_dir(suite->config, "add-batch");
+    HnswIndex* idx = hnsw_create(dir.c_str(), set.dimension, static_cast<int>(set.count),
+                                 precision);
+    if (idx == nullptr) {
+        state.SkipWithError("hnsw_create failed");
+        return;
+    }
+
+    size_t offset = 0;
+    for (auto _ : state) {
+        if (hnsw_add_batch(idx, const_cast<const char**>(set.id_ptrs.data()) + offset,
+                           set.vector(offset), batch, set.dimension, 0) != 0) {
+            state.SkipWithError("hnsw_add_batch failed");
+            break;
+        }
+        offset += batch;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(offset));
+
+    hnsw_close(idx);
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+struct HitIds {
+    std::vector<long> ids;
+};
+
+static void collect_vector_hit(void* ctx, const char* chunk_id, size_t chunk_id_len, float) {
+    static_cast<HitIds*>(ctx)->ids.push_back(vector_index_of(chunk_id, chunk_id_len));
+}
+
+static void count_vector_hit(void* ctx, const char*, size_t, float) {
+    ++*static_cast<size_t*>(ctx);
+}
+
+// One query per iteration, cycling through the query set. Recall is
+// measured on an untimed pass over every query afterwards.
+static void bench_hnsw_search(benchmark::State& state, HnswPrecision precision, int k, int ef) {
+    HnswIndex* idx;
+    try {
+        idx = suite->graph(precision);
+        suite->neighbours();
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    const VectorSet& set = suite->vectors;
+    const HnswSearchOptions options = {ef, 0, nullptr};
+
+    std::vector<double> latencies;
+    size_t q = 0;
+    size_t hits = 0;
+    for (auto _ : state) {
+        Clock::time_point start = Clock::now();
+        if (hnsw_search_visit(idx, set.query(q), set.dimension, k, &options, count_vector_hit,
+                              &hits) < 0) {
+            state.SkipWithError("hnsw_search_visit failed");
+            break;
+        }
+        latencies.push_back(micros_since(start));
+        q = q + 1 == set.num_queries ? 0 : q + 1;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    report_latencies(state, &latencies);
+
+    size_t found = 0;
+    const size_t depth = std::min<size_t>(k, set.count);
+    HitIds result;
+    for (size_t i = 0; i < set.num_queries; i++) {
+        result.ids.clear();
+        hnsw_search_visit(idx, set.query(i), set.dimension, k, &options, collect_vector_hit,
+                          &result);
+        std::vector<uint32_t> truth(suite->truth[i].begin(), suite->truth[i].begin() + depth);
+        std::sort(truth.begin(), truth.end());
+        for (long id : result.ids) {
+            found += id >= 0 && std::binary_search(truth.begin(), truth.end(),
+                                                   static_cast<uint32_t>(id));
+        }
+    }
+    state.counters["recall"] = static_cast<double>(found) / (depth * set.num_queries);
+}
+
+// Opens (and closes) an index no other handle has open. Only the open is
+// timed; files are in the page cache after the first iteration.
+static void bench_hnsw_open(benchmark::State& state, HnswPrecision precision, bool readonly) {
+    std::string dir;
+    try {
+        dir = suite->closed_graph(precision);
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    const int dimension = suite->vectors.dimension;
+
+    for (auto _ : state) {
+        Clock::time_point start = Clock::now();
+        HnswIndex* idx = readonly ? hnsw_open_readonly(dir.c_str(), dimension)
+                                  : hnsw_open(dir.c_str(), dimension);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (idx == nullptr) {
+            state.SkipWithError("open failed");
+            break;
+        }
+        state.SetIterationTime(seconds);
+        hnsw_close(idx);
+    }
+}
+
+// =============================================================================
+// Xapian
+// =============================================================================
+
+// Indexes documents one call at a time. Without background flushing every
+// call commits; deferred runs leave commits to the flusher and include the
+// final xapian_flush.
+static void bench_xapian_index(benchmark::State& state, bool deferred, size_t count) {
+    std::vector<XapianDocument> docs = suite->xapian_documents();
+    std::string dir = make_temp_dir(suite->config, "index");
+    xapian_db db = xapian_open(dir.c_str());
+    if (db == nullptr) {
+        state.SkipWithError("xapian_open failed");
+        return;
+    }
+    const XapianFlushOptions flush = {1000, 1000};
+    if (deferred && xapian_set_background_flush(db, &flush) != 0) {
+        state.SkipWithError("xapian_set_background_flush failed");
+        xapian_close(db);
+        return;
+    }
+
+    size_t i = 0;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        const XapianDocument& d = docs[i];
+        if (xapian_index(db, suite->documents.ids[i].c_str(), suite->documents.doc_ids[i].c_str(),
+                         suite->documents.contents[i].c_str()) != 0) {
+            state.SkipWithError("xapian_index failed");
+            break;
+        }
+        bytes += static_cast<int64_t>(d.content_len);
+        if (++i == count && deferred && xapian_flush(db) != 0) {
+            state.SkipWithError("xapian_flush failed");
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(i));
+    state.SetBytesProcessed(bytes);
+
+    xapian_close(db);
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// Indexes every document, batch documents (one commit) per call
+static void bench_xapian_index_batch(benchmark::State& state, int batch) {
+    std::vector<XapianDocument> docs = suite->xapian_documents();
+    std::string dir = make_temp_dir(suite->config, "index-batch");
+    xapian_db db = xapian_open(dir.c_str());
+    if (db == nullptr) {
+        state.SkipWithError("xapian_open failed");
+        return;
+    }
+
+    size_t offset = 0;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        if (xapian_index_batch(db, docs.data() + offset, batch) != 0) {
+            state.SkipWithError("xapian_index_batch failed");
+            break;
+        }
+        for (int j = 0; j < batch; j++) {
+            bytes += static_cast<int64_t>(docs[offset + j].content_len);
+        }
+        offset += batch;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(offset));
+    state.SetBytesProcessed(bytes);
+
+    xapian_close(db);
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+static void count_keyword_hit(void* ctx, const char*, size_t, double) {
+    ++*static_cast<size_t*>(ctx);
+}
+
+// One query per iteration, cycling through the query set (the result cache
+// is off, so every search runs the matcher)
+static void bench_xapian_search(benchmark::State& state) {
+    xapian_db db;
+    try {
+        db = suite->keyword();
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    const std::vector<std::string>& queries = suite->documents.queries;
+
+    std::vector<double> latencies;
+    size_t q = 0;
+    size_t hits = 0;
+    for (auto _ : state) {
+        Clock::time_point start = Clock::now();
+        if (xapian_search_visit(db, queries[q].c_str(), kKeywordLimit, count_keyword_hit,
+                                &hits) < 0) {
+            state.SkipWithError("xapian_search_visit failed");
+            break;
+        }
+        latencies.push_back(micros_since(start));
+        q = q + 1 == queries.size() ? 0 : q + 1;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["hits_per_query"] =
+        state.iterations() > 0 ? static_cast<double>(hits) / state.iterations() : 0.0;
+    report_latencies(state, &latencies);
+}
+
+// =============================================================================
+// Registration
+// =============================================================================
+
+static void register_benchmarks(const Suite& s) {
+    const auto count = static_cast<benchmark::IterationCount>(s.vectors.count);
+
+    for (const PrecisionInfo& p : kPrecisions) {
+        const HnswPrecision precision = p.precision;
+        std::string name = std::string("hnsw/add/") + p.name;
+        benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State& state) {
+            bench_hnsw_add(state, precision);
+        })->Iterations(count)->Unit(benchmark::kMicrosecond);
+
+        for (int batch : kAddBatchSizes) {
+            if (static_cast<size_t>(batch) > s.vectors.count) {
+                continue;
+            }
+            name = std::string("hnsw/add_batch/") + p.name + "/batch:" + std::to_string(batch);
+            benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State& state) {
+                bench_hnsw_add_batch(state, precision, batch);
+            })->Iterations(count / batch)->Unit(benchmark::kMillisecond);
+        }
+
+        for (int k : kSearchKs) {
+            for (int ef : kSearchEfs) {
+                if (ef < k) {
+                    continue;  // The effective ef is at least k
+                }
+                name = std::string("hnsw/search/") + p.name + "/k:" + std::to_string(k) +
+                       "/ef:" + std::to_string(ef);
+                benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State& state) {
+                    bench_hnsw_search(state, precision, k, ef);
+                })->Unit(benchmark::kMicrosecond);
+            }
+        }
+
+        for (bool readonly : {false, true}) {
+            name = std::string(readonly ? "hnsw/open_readonly/" : "hnsw/open/") + p.name;
+            benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State& state) {
+                bench_hnsw_open(state, precision, readonly);
+            })->UseManualTime()->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    const size_t documents = s.documents.ids.size();
+    const size_t singles = std::min(documents, kMaxSingleCommits);
+    for (bool deferred : {false, true}) {
+        std::string name = deferred ? "xapian/index/deferred" : "xapian/index/commit_each";
+        benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State& state) {
+            bench_xapian_index(state, deferred, singles);
+        })->Iterations(static_cast<benchmark::IterationCount>(singles))
+          ->Unit(benchmark::kMicrosecond);
+    }
+    for (int batch : kIndexBatchSizes) {
+        if (static_cast<size_t>(batch) > documents) {
+            continue;
+        }
+        std::string name = "xapian/index_batch/batch:" + std::to_string(batch);
+        benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State& state) {
+            bench_xapian_index_batch(state, batch);
+        })->Iterations(static_cast<benchmark::IterationCount>(documents / batch))
+          ->Unit(benchmark::kMillisecond);
+    }
+    std::string name = "xapian/search/limit:" + std::to_string(kKeywordLimit);
+    benchmark::RegisterBenchmark(name.c_str(), bench_xapian_search)
+        ->Unit(benchmark::kMicrosecond);
+}
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    try {
+        std::unique_ptr<Suite> owned(new Suite());
+        suite = owned.get();
+        suite->config = config_from_env();
+        suite->vectors = load_vectors(suite->config);
+        suite->documents = make_documents(suite->config);
+
+        // Recorded in the JSON context so results can be compared between runs
+        benchmark::AddCustomContext("workload", suite->vectors.name);
+        benchmark::AddCustomContext("vectors", std::to_string(suite->vectors.count));
+        benchmark::AddCustomContext("dimension", std::to_string(suite->vectors.dimension));
+        benchmark::AddCustomContext("queries", std::to_string(suite->vectors.num_queries));
+        benchmark::AddCustomContext("documents", std::to_string(suite->documents.ids.size()));
+        benchmark::AddCustomContext("seed", std::to_string(suite->config.seed));
+        benchmark::AddCustomContext("hnsw_kernels", hnsw_kernel_isa());
+
+        register_benchmarks(*suite);
+        benchmark::RunSpecifiedBenchmarks();
+        suite = nullptr;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "sercha_bench: %s\n", e.what());
+        return 1;
+    }
+
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * hnsw_ids.h - Compact chunk ID table for the HNSW wrapper
+ *
+ * Internal C++ header shared by the HNSW wrapper translation units.
+ * Maps string chunk IDs to numeric labels and back without a heap string or
+ * hash node per ID: the IDs live in one character arena, each label holds a
+ * packed (offset, length) span into it, and the reverse lookup is an
+ * open-addressing table of labels keyed by a stable hash of the ID. All three
+ * are flat arrays, so the table is written as three blocks and loaded with
+ * one copy each, or used in place from a read-only mapping.
+ */
+
+#ifndef SERCHA_HNSW_IDS_H
+#define SERCHA_HNSW_IDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+class ChunkIdTable {
+public:
+    // Longest chunk ID a span can hold
+    static const size_t kMaxIdLength = (size_t{1} << 24) - 1;
+
+    ChunkIdTable() = default;
+    ChunkIdTable(const ChunkIdTable&) = delete;
+    ChunkIdTable& operator=(const ChunkIdTable&) = delete;
+    ChunkIdTable(ChunkIdTable&& other) noexcept { swap(other); }
+    ChunkIdTable& operator=(ChunkIdTable&& other) noexcept;
+
+    // Chunk ID of label, or an empty view if the label is unmapped. The view
+    // is valid until the next mutation.
+    std::string_view id(uint64_t label) const {
+        if (label >= num_labels_) {
+            return std::string_view();
+        }
+        uint64_t span = spans_[label];
+        uint64_t offset = span >> kLengthBits;
+        uint64_t length = span & kLengthMask;
+        if (length == 0 || offset + length > arena_size_) {
+            return std::string_view();  // Unmapped, or a corrupt mapped span
+        }
+        return std::string_view(arena_ + offset, length);
+    }
+
+    // Sets *label to the label of id. Returns false if id is not mapped.
+    bool find(std::string_view id, uint64_t* label) const;
+
+    bool contains(std::string_view id) const {
+        uint64_t label;
+        return find(id, &label);
+    }
+
+    // Maps an unmapped label to id, growing the label range if needed.
+    // Returns false (and changes nothing) if id already names a label.
+    // Throws std::length_error for an ID longer than kMaxIdLength.
+    bool assign(uint64_t label, std::string_view id);
+
+    // Unmaps label; a no-op if it is unmapped. The ID's arena bytes are
+    // reclaimed once enough of the arena is dead.
+    void erase(uint64_t label);
+
+    // Grows the label range to at least labels; new labels are unmapped
+    void resize(size_t labels);
+
+    // Pre-sizes for labels labels holding id_bytes bytes of IDs in total
+    void reserve(size_t labels, size_t id_bytes);
+
+    void clear();
+
+    // Number of labels (mapped or not)
+    size_t size() const { return num_labels_; }
+
+    // Number of mapped IDs
+    size_t count() const { return live_; }
+
+    // Bytes of ID content held by live labels
+    size_t id_bytes() const { return arena_size_ - dead_bytes_; }
+
+    // Heap bytes owned by the table (0 for a table attached to a mapping)
+    size_t memory_bytes() const;
+
+    // True if the table points into a mapping and cannot be mutated
+    bool attached() const { return attached_; }
+
+    // Writes the table with a compacted arena. The block is a multiple of 8
+    // bytes long and, if it starts 8-byte aligned, keeps its arrays aligned.
+    bool write(std::ostream& out) const;
+
+    // Reads a block written by write() from data, copying it (load) or
+    // pointing into it (attach; data must outlive the table and be 8-byte
+    // aligned). Sets *consumed to the block length.
+    bool load(const char* data, size_t size, size_t* consumed);
+    bool attach(const char* data, size_t size, size_t* consumed);
+
+    void swap(ChunkIdTable& other) noexcept;
+
+private:
+    static const unsigned kLengthBits = 24;
+    static const uint64_t kLengthMask = (uint64_t{1} << kLengthBits) - 1;
+
+    bool parse(const char* data, size_t size, size_t* consumed, bool copy);
+    size_t probe_start(uint64_t hash) const { return static_cast<size_t>(hash) & (num_slots_ - 1); }
+    bool matches(uint64_t slot, uint32_t tag, std::string_view id) const;
+    void insert_slot(uint64_t hash, uint64_t label);
+    void remove_slot(uint64_t label);
+    void rehash(size_t slots);
+    void compact_arena();
+    void ensure_mutable() const;
+    void sync();
+
+    // Views used by lookups: the owned vectors below, or a mapping
+    const uint64_t* spans_ = nullptr;  // label -> offset << 24 | length
+    const uint64_t* slots_ = nullptr;  // tag << 32 | (label + 1); 0 = empty
+    const char* arena_ = nullptr;
+    size_t num_labels_ = 0;
+    size_t num_slots_ = 0;  // Power of two, or 0
+    size_t arena_size_ = 0;
+    size_t live_ = 0;
+    size_t dead_bytes_ = 0;  // Arena bytes of erased IDs
+    bool attached_ = false;
+
+    std::vector<uint64_t> span_store_;
+    std::vector<uint64_t> slot_store_;
+    std::vector<char> arena_store_;
+};
+
+#endif // SERCHA_HNSW_IDS_H
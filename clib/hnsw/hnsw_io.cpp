@@ -0,0 +1,189 @@
+/*
+ * hnsw_io.cpp - Buffered, atomic snapshot writer for HNSW index files
+ *
+ * The I/O thread is only started once a first buffer fills, so small files
+ * are written inline at commit. Commit fsyncs the file before the rename and
+ * the directory after it, so the rename is durable and never exposes a
+ * partially written file.
+ */
+
+#include "hnsw_io.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <unistd.h>
+
+// Helper: write all of data, retrying on partial writes and EINTR
+static bool write_all(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, data, n);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+// Helper: make a rename in the directory of path durable
+static void sync_parent_dir(const std::string& path) {
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+bool rename_durably(const std::string& from, const std::string& to) {
+    if (::rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+    sync_parent_dir(to);
+    return true;
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    abort();
+}
+
+bool SnapshotWriter::open(const std::string& path) {
+    abort();
+    path_ = path;
+    tmp_path_ = path + ".tmp";
+    fd_ = ::open(tmp_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    if (!buffers_[0]) {
+        buffers_[0].reset(new char[kBufferSize]);
+    }
+    filling_ = 0;
+    used_ = 0;
+    pending_ = false;
+    stop_ = false;
+    failed_ = false;
+    return true;
+}
+
+bool SnapshotWriter::write(const void* data, size_t n) {
+    if (fd_ < 0) {
+        return false;
+    }
+    const char* p = static_cast<const char*>(data);
+    while (n > 0) {
+        size_t take = std::min(n, kBufferSize - used_);
+        std::memcpy(buffers_[filling_].get() + used_, p, take);
+        used_ += take;
+        p += take;
+        n -= take;
+        if (used_ == kBufferSize && !submit()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper: hand the filled buffer to the I/O thread and switch to the other
+// one once the thread is done with it
+bool SnapshotWriter::submit() {
+    if (!thread_.joinable()) {
+        if (!buffers_[1]) {
+            buffers_[1].reset(new char[kBufferSize]);
+        }
+        thread_ = std::thread(&SnapshotWriter::run, this);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !pending_; });
+    if (failed_) {
+        return false;
+    }
+    pending_ = true;
+    pending_buffer_ = filling_;
+    pending_bytes_ = used_;
+    filling_ ^= 1;
+    used_ = 0;
+    cv_.notify_all();
+    return true;
+}
+
+void SnapshotWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return pending_ || stop_; });
+        if (!pending_) {
+            return;
+        }
+        const char* data = buffers_[pending_buffer_].get();
+        size_t n = pending_bytes_;
+        lock.unlock();
+        bool ok = write_all(fd_, data, n);
+        lock.lock();
+        failed_ = failed_ || !ok;
+        pending_ = false;
+        cv_.notify_all();
+    }
+}
+
+// Helper: write out everything buffered and stop the I/O thread
+bool SnapshotWriter::finish() {
+    if (!thread_.joinable()) {
+        bool ok = write_all(fd_, buffers_[filling_].get(), used_);
+        used_ = 0;
+        return ok;
+    }
+    bool ok = used_ == 0 || submit();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !pending_; });
+        ok = ok && !failed_;
+        stop_ = true;
+        cv_.notify_all();
+    }
+    thread_.join();
+    used_ = 0;
+    return ok;
+}
+
+bool SnapshotWriter::commit() {
+    if (fd_ < 0) {
+        return false;
+    }
+    bool ok = finish() && ::fsync(fd_) == 0;
+    ok = ::close(fd_) == 0 && ok;
+    fd_ = -1;
+    if (!ok || ::rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+        ::unlink(tmp_path_.c_str());
+        return false;
+    }
+    sync_parent_dir(path_);
+    return true;
+}
+
+void SnapshotWriter::abort() {
+    if (fd_ < 0) {
+        return;
+    }
+    finish();
+    ::close(fd_);
+    fd_ = -1;
+    ::unlink(tmp_path_.c_str());
+}
+
+std::streamsize SnapshotWriter::xsputn(const char* s, std::streamsize n) {
+    return write(s, static_cast<size_t>(n)) ? n : 0;
+}
+
+SnapshotWriter::int_type SnapshotWriter::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+    }
+    char ch = traits_type::to_char_type(c);
+    return write(&ch, 1) ? c : traits_type::eof();
+}
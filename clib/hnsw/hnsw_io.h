@@ -0,0 +1,82 @@
+/*
+ * hnsw_io.h - Buffered, atomic snapshot writer for HNSW index files
+ *
+ * Internal C++ header shared by the HNSW wrapper translation units.
+ * Snapshot files (the graph and id_mapping.bin) are written to a temporary
+ * file next to their final path and renamed over it once complete and
+ * synced, so a crash mid-save leaves the previous snapshot intact. Writes
+ * are gathered into large buffers and handed to a background thread, which
+ * writes one buffer while the caller fills the other.
+ */
+
+#ifndef SERCHA_HNSW_IO_H
+#define SERCHA_HNSW_IO_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+// A std::streambuf, so it can also back a std::ostream.
+class SnapshotWriter : public std::streambuf {
+public:
+    // Size of each of the two I/O buffers
+    static const size_t kBufferSize = 4 << 20;
+
+    SnapshotWriter() = default;
+    ~SnapshotWriter() override;
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Starts writing a new version of the file at path (path + ".tmp").
+    bool open(const std::string& path);
+
+    // Appends n bytes. Returns false once any write has failed.
+    bool write(const void* data, size_t n);
+
+    template <typename T>
+    bool put(const T& value) {
+        return write(&value, sizeof(T));
+    }
+
+    // Flushes and syncs the temporary file and renames it over the target.
+    // On failure the target is left untouched.
+    bool commit();
+
+    // Discards the temporary file (a no-op after commit).
+    void abort();
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int_type overflow(int_type c) override;
+
+private:
+    bool submit();
+    bool finish();
+    void run();
+
+    int fd_ = -1;
+    std::string path_;
+    std::string tmp_path_;
+    std::unique_ptr<char[]> buffers_[2];  // Allocated on first use
+    size_t filling_ = 0;  // Buffer the caller is filling
+    size_t used_ = 0;     // Bytes in that buffer
+
+    // Hand-off to the I/O thread
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_ = false;  // buffers_[pending_buffer_] holds pending_bytes_ to write
+    size_t pending_buffer_ = 0;
+    size_t pending_bytes_ = 0;
+    bool stop_ = false;
+    bool failed_ = false;
+};
+
+// Renames from over to and syncs the directory so the rename is durable.
+bool rename_durably(const std::string& from, const std::string& to);
+
+#endif // SERCHA_HNSW_IO_H
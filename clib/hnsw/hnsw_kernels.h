@@ -0,0 +1,118 @@
+/*
+ * hnsw_kernels.h - SIMD kernels for HNSW vector storage
+ *
+ * Internal C++ header shared by the HNSW wrapper translation units.
+ * Distance kernels for the quantized layouts plus the preprocessing every add
+ * and query goes through (normalization, float16 and int8 conversion), each
+ * with a bulk form over whole buffers. Kernels are selected once at runtime
+ * for the best instruction set the CPU supports (AVX-512, AVX2/F16C, NEON)
+ * and fall back to portable scalar code, so a portable build still runs the
+ * widest kernels available.
+ */
+
+#ifndef SERCHA_HNSW_KERNELS_H
+#define SERCHA_HNSW_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// =============================================================================
+// Float16 (IEEE 754 half-precision) scalar conversion
+// =============================================================================
+
+// Convert float32 to float16 (IEEE 754 half-precision), rounding to nearest
+// even like the F16C and NEON conversions so every kernel set stores the same
+// bits. Overflow saturates to infinity; NaN stays NaN.
+static inline uint16_t float_to_half(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(float));
+    const uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint32_t h;
+    if (x >= 0x47800000u) {  // |f| >= 65536, inf or NaN
+        h = x > 0x7F800000u ? 0x7E00u : 0x7C00u;
+    } else if (x < 0x38800000u) {  // Below the smallest normal half: denormal or zero
+        // Adding 0.5 aligns the mantissa so the FPU does the rounding
+        float shifted;
+        std::memcpy(&shifted, &x, sizeof(float));
+        shifted += 0.5f;
+        std::memcpy(&h, &shifted, sizeof(float));
+        h -= 0x3F000000u;
+    } else {
+        const uint32_t mantissa_odd = (x >> 13) & 1;
+        x += 0xC8000FFFu;  // Rebias the exponent and add the rounding bias
+        x += mantissa_odd;
+        h = x >> 13;
+    }
+    return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+// Convert float16 to float32 (exact)
+static inline float half_to_float(uint16_t h) {
+    const uint32_t shifted_exp = 0x7C00u << 13;
+    uint32_t x = (static_cast<uint32_t>(h) & 0x7FFFu) << 13;
+    const uint32_t exp = x & shifted_exp;
+    x += (127 - 15) << 23;  // Rebias the exponent
+
+    float f;
+    if (exp == shifted_exp) {  // inf or NaN
+        x += (128 - 16) << 23;
+        std::memcpy(&f, &x, sizeof(float));
+    } else if (exp == 0) {  // zero or denormalized: renormalize through the FPU
+        x += 1u << 23;
+        std::memcpy(&f, &x, sizeof(float));
+        f -= 6.103515625e-05f;  // 2^-14
+    } else {
+        std::memcpy(&f, &x, sizeof(float));
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(float));
+    bits |= (static_cast<uint32_t>(h) & 0x8000u) << 16;
+    std::memcpy(&f, &bits, sizeof(float));
+    return f;
+}
+
+// =============================================================================
+// Runtime-dispatched kernels
+// =============================================================================
+
+struct HnswKernels {
+    // Dot product of two float32 vectors.
+    float (*dot_f32)(const float* a, const float* b, size_t n);
+    // Dot product of two float16 vectors.
+    float (*dot_f16)(const uint16_t* a, const uint16_t* b, size_t n);
+    // Dot product of two int8 vectors (exact, accumulated in int32).
+    int32_t (*dot_i8)(const int8_t* a, const int8_t* b, size_t n);
+    // Dot product of a float16 vector with a float32 vector (re-ranking).
+    float (*dot_f16_f32)(const uint16_t* a, const float* b, size_t n);
+    // Dot product of an int8 vector with a float32 vector (re-ranking).
+    float (*dot_i8_f32)(const int8_t* a, const float* b, size_t n);
+    // Scales in to unit length into out (which may be in); a zero vector is
+    // copied unchanged.
+    void (*normalize)(const float* in, float* out, size_t n);
+    // Float32 <-> float16 over whole buffers (rounding to nearest even).
+    void (*f32_to_f16)(const float* in, uint16_t* out, size_t n);
+    void (*f16_to_f32)(const uint16_t* in, float* out, size_t n);
+    // Symmetric int8 quantization: the largest magnitude maps to 127 and the
+    // returned scale maps a code back (value = code * scale).
+    float (*quantize_i8)(const float* in, int8_t* out, size_t n);
+    void (*dequantize_i8)(const int8_t* in, float scale, float* out, size_t n);
+    // Name of the selected instruction set ("avx512", "avx2", "neon", "scalar").
+    const char* isa;
+};
+
+// Returns the kernels for the best instruction set supported by this CPU.
+// Selection happens once; the returned table is immutable.
+const HnswKernels& hnsw_kernels();
+
+// Bulk forms over count vectors of dim floats stored back to back. An int8
+// record is the float scale followed by dim codes, the vector data of each
+// element in an int8 graph (graph.i8).
+void hnsw_normalize_batch(const float* in, float* out, size_t count, size_t dim);
+void hnsw_quantize_i8_batch(const float* in, char* out, size_t count, size_t dim);
+void hnsw_dequantize_i8_batch(const char* in, float* out, size_t count, size_t dim);
+
+#endif // SERCHA_HNSW_KERNELS_H
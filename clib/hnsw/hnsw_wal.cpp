@@ -0,0 +1,267 @@
+/*
+ * hnsw_wal.cpp - Write-ahead log for HNSW index mutations
+ *
+ * Layout: a 16-byte header (magic, format version, snapshot seq) followed by
+ * records of [uint32 payload length][uint32 FNV-1a checksum][payload]. The
+ * payload is [uint8 op][uint64 label][uint32 id length][id], followed (format
+ * version 2) by the length-prefixed source and document attributes, then the
+ * vector bytes. Version 1 logs have no attributes and are still replayed.
+ * Records are only ever appended, so a crash can at worst leave a torn final
+ * record, which replay detects by length or checksum and drops.
+ */
+
+#include "hnsw_wal.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint32_t kWalMagic = 0x574E4853;  // "SHNW"
+static const uint32_t kWalVersion = 2;
+static const size_t kWalHeaderSize = 16;
+static const size_t kRecordHeaderSize = 8;
+static const size_t kPayloadFixedSize = 1 + 8 + 4;
+
+static uint32_t fnv1a(const char* data, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+template <typename T>
+static void put(std::vector<char>& buf, const T& value) {
+    const char* p = reinterpret_cast<const char*>(&value);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static T get(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+// Helper: write all of buf, retrying on partial writes and EINTR
+static bool write_all(int fd, const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, data, n);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+// Helper: read the whole file at path into out. Returns false if it exists
+// but cannot be read; a missing file yields an empty buffer.
+static bool read_file(const std::string& path, std::vector<char>* out) {
+    out->clear();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    out->resize(static_cast<size_t>(st.st_size));
+    size_t pos = 0;
+    while (pos < out->size()) {
+        ssize_t r = ::read(fd, out->data() + pos, out->size() - pos);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            break;
+        }
+        pos += static_cast<size_t>(r);
+    }
+    out->resize(pos);
+    ::close(fd);
+    return true;
+}
+
+// Helper: format version of the log header if it belongs to generation seq,
+// or 0 if it is missing, foreign or stale
+static uint32_t header_version(const char* data, size_t size, uint64_t seq) {
+    if (size < kWalHeaderSize || get<uint32_t>(data) != kWalMagic ||
+        get<uint64_t>(data + 8) != seq) {
+        return 0;
+    }
+    uint32_t version = get<uint32_t>(data + 4);
+    return version >= 1 && version <= kWalVersion ? version : 0;
+}
+
+// Helper: split a length-prefixed field off the front of rest
+static bool take_field(std::string_view* rest, std::string_view* field) {
+    if (rest->size() < sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t len = get<uint32_t>(rest->data());
+    if (len > rest->size() - sizeof(uint32_t)) {
+        return false;
+    }
+    *field = rest->substr(sizeof(uint32_t), len);
+    rest->remove_prefix(sizeof(uint32_t) + len);
+    return true;
+}
+
+HnswWal::~HnswWal() {
+    close();
+}
+
+bool HnswWal::replay(const std::string& path, uint64_t seq,
+                     const std::function<void(const WalRecord&)>& apply, uint64_t* end) {
+    *end = 0;
+
+    std::vector<char> data;
+    if (!read_file(path, &data)) {
+        return false;
+    }
+    uint32_t version = header_version(data.data(), data.size(), seq);
+    if (version == 0) {
+        return true;  // Missing or stale log: nothing to replay
+    }
+
+    size_t pos = kWalHeaderSize;
+    while (data.size() - pos >= kRecordHeaderSize) {
+        uint32_t len = get<uint32_t>(data.data() + pos);
+        uint32_t sum = get<uint32_t>(data.data() + pos + 4);
+        const char* payload = data.data() + pos + kRecordHeaderSize;
+        if (len < kPayloadFixedSize || data.size() - pos - kRecordHeaderSize < len ||
+            fnv1a(payload, len) != sum) {
+            break;  // Torn or corrupt tail
+        }
+
+        WalRecord rec{};
+        rec.op = static_cast<WalOp>(static_cast<uint8_t>(payload[0]));
+        rec.label = get<uint64_t>(payload + 1);
+        std::string_view rest(payload + 9, len - 9);
+        if (!take_field(&rest, &rec.id) ||
+            (version >= 2 && (!take_field(&rest, &rec.source) ||
+                              !take_field(&rest, &rec.document)))) {
+            break;
+        }
+        rec.vector = rest;
+        apply(rec);
+
+        pos += kRecordHeaderSize + len;
+    }
+
+    // Records are appended in the current format only
+    *end = version == kWalVersion ? pos : 0;
+    return true;
+}
+
+bool HnswWal::has_records(const std::string& path, uint64_t seq) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    char header[kWalHeaderSize];
+    struct stat st;
+    bool pending = fstat(fd, &st) == 0 &&
+                   static_cast<size_t>(st.st_size) > kWalHeaderSize &&
+                   ::pread(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                   header_version(header, sizeof(header), seq) != 0;
+    ::close(fd);
+    return pending;
+}
+
+bool HnswWal::open(const std::string& path, uint64_t seq, uint64_t end) {
+    close();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    if (end < kWalHeaderSize) {
+        return reset(seq);
+    }
+    // Drop any torn tail so new records follow the last intact one
+    if (ftruncate(fd_, static_cast<off_t>(end)) != 0 ||
+        lseek(fd_, static_cast<off_t>(end), SEEK_SET) < 0) {
+        close();
+        return false;
+    }
+    size_ = end;
+    return true;
+}
+
+bool HnswWal::append(const WalRecord* records, size_t count) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    buf_.clear();
+    for (size_t i = 0; i < count; i++) {
+        const WalRecord& rec = records[i];
+        uint32_t len = static_cast<uint32_t>(kPayloadFixedSize + rec.id.size() +
+                                             2 * sizeof(uint32_t) + rec.source.size() +
+                                             rec.document.size() + rec.vector.size());
+        size_t start = buf_.size();
+        put(buf_, len);
+        put(buf_, uint32_t{0});  // Checksum, filled in below
+        buf_.push_back(static_cast<char>(rec.op));
+        put(buf_, rec.label);
+        put(buf_, static_cast<uint32_t>(rec.id.size()));
+        buf_.insert(buf_.end(), rec.id.begin(), rec.id.end());
+        put(buf_, static_cast<uint32_t>(rec.source.size()));
+        buf_.insert(buf_.end(), rec.source.begin(), rec.source.end());
+        put(buf_, static_cast<uint32_t>(rec.document.size()));
+        buf_.insert(buf_.end(), rec.document.begin(), rec.document.end());
+        buf_.insert(buf_.end(), rec.vector.begin(), rec.vector.end());
+        uint32_t sum = fnv1a(buf_.data() + start + kRecordHeaderSize, len);
+        std::memcpy(buf_.data() + start + 4, &sum, sizeof(sum));
+    }
+
+    if (!write_all(fd_, buf_.data(), buf_.size())) {
+        return false;
+    }
+    size_ += buf_.size();
+    return true;
+}
+
+bool HnswWal::reset(uint64_t seq) {
+    if (fd_ < 0) {
+        return false;
+    }
+    if (ftruncate(fd_, 0) != 0 || lseek(fd_, 0, SEEK_SET) < 0) {
+        return false;
+    }
+    size_ = 0;
+    return write_header(seq);
+}
+
+bool HnswWal::write_header(uint64_t seq) {
+    std::vector<char> header;
+    put(header, kWalMagic);
+    put(header, kWalVersion);
+    put(header, seq);
+    if (!write_all(fd_, header.data(), header.size())) {
+        return false;
+    }
+    size_ = header.size();
+    return true;
+}
+
+bool HnswWal::sync() {
+    return fd_ >= 0 && ::fsync(fd_) == 0;
+}
+
+void HnswWal::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
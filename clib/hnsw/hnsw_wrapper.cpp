@@ -3,532 +3,2450 @@
  *
  * This wrapper provides a C-compatible interface to HNSWlib for use with CGO.
  * It manages string chunk ID to numeric label mapping internally.
- * Supports configurable storage precision (float32/float16/int8) while
- * keeping float32 for HNSW runtime operations.
+ * Supports configurable precision (float32/float16/int8). Float16 and int8
+ * vectors stay compressed in memory and are searched with SIMD kernels that
+ * work on the compressed form directly, optionally re-ranked in float32.
+ * Mutations are appended to a write-ahead log and folded into the snapshot
+ * at checkpoints.
  */
 
 #include "hnsw_wrapper.h"
+#include "hnsw_ids.h"
+#include "hnsw_io.h"
+#include "hnsw_kernels.h"
+#include "hnsw_wal.h"
 #include <hnswlib/hnswlib.h>
 #include <unordered_map>
 #include <vector>
+#include <functional>
 #include <string>
 #include <fstream>
 #include <cstring>
 #include <cstdlib>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
 #include <filesystem>
 #include <cmath>
 #include <algorithm>
+#include <string_view>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // =============================================================================
-// Float16 (IEEE 754 half-precision) conversion
+// Quantized inner-product spaces
 // =============================================================================
 
-// Convert float32 to float16 (IEEE 754 half-precision)
-static uint16_t float_to_half(float f) {
-    uint32_t x;
-    std::memcpy(&x, &f, sizeof(float));
+// Distance computations made by this thread. Every space's distance
+// function bumps it, so a search reads it before and after to count its work.
+static thread_local uint64_t t_distance_computations = 0;
 
-    uint32_t sign = (x >> 31) & 0x1;
-    int32_t exp = ((x >> 23) & 0xFF) - 127;
-    uint32_t mantissa = x & 0x7FFFFF;
-
-    // Handle special cases
-    if (exp == 128) {  // inf or NaN
-        if (mantissa == 0) {
-            return static_cast<uint16_t>((sign << 15) | 0x7C00);  // inf
-        }
-        return static_cast<uint16_t>((sign << 15) | 0x7E00);  // NaN
-    }
+// Distance parameters shared by the spaces.
+struct SpaceParam {
+    size_t dim;
+    const HnswKernels* kernels;
+};
 
-    if (exp < -24) {  // too small, flush to zero
-        return static_cast<uint16_t>(sign << 15);
-    }
+// Float16 layout: dim half-precision values.
+static float f16_ip_distance(const void* a, const void* b, const void* param) {
+    auto* p = static_cast<const SpaceParam*>(param);
+    t_distance_computations++;
+    return 1.0f - p->kernels->dot_f16(static_cast<const uint16_t*>(a),
+                                      static_cast<const uint16_t*>(b), p->dim);
+}
 
-    if (exp < -14) {  // denormalized
-        mantissa |= 0x800000;  // add implicit bit
-        int shift = -14 - exp;
-        mantissa >>= shift;
-        return static_cast<uint16_t>((sign << 15) | (mantissa >> 13));
-    }
+// Int8 layout: float scale followed by dim int8 values, as each element stores
+// its vector in the int8 graph (graph.i8).
+static float i8_ip_distance(const void* a, const void* b, const void* param) {
+    auto* p = static_cast<const SpaceParam*>(param);
+    t_distance_computations++;
+    float scale_a, scale_b;
+    std::memcpy(&scale_a, a, sizeof(float));
+    std::memcpy(&scale_b, b, sizeof(float));
+    int32_t dot = p->kernels->dot_i8(
+        reinterpret_cast<const int8_t*>(static_cast<const char*>(a) + sizeof(float)),
+        reinterpret_cast<const int8_t*>(static_cast<const char*>(b) + sizeof(float)), p->dim);
+    return 1.0f - scale_a * scale_b * static_cast<float>(dot);
+}
 
-    if (exp > 15) {  // overflow to inf
-        return static_cast<uint16_t>((sign << 15) | 0x7C00);
-    }
+// Inner-product space over compressed vectors, so HierarchicalNSW stores and
+// compares float16/int8 data without expanding it to float32.
+class QuantizedInnerProductSpace : public hnswlib::SpaceInterface<float> {
+public:
+    QuantizedInnerProductSpace(HnswPrecision precision, size_t dim)
+        : param_{dim, &hnsw_kernels()},
+          data_size_(precision == HNSW_PRECISION_FLOAT16 ? dim * sizeof(uint16_t)
+                                                         : sizeof(float) + dim),
+          dist_(precision == HNSW_PRECISION_FLOAT16 ? f16_ip_distance : i8_ip_distance) {}
+
+    size_t get_data_size() override { return data_size_; }
+    hnswlib::DISTFUNC<float> get_dist_func() override { return dist_; }
+    void* get_dist_func_param() override { return &param_; }
+
+private:
+    SpaceParam param_;
+    size_t data_size_;
+    hnswlib::DISTFUNC<float> dist_;
+};
 
-    // Normalized
-    uint16_t h_exp = static_cast<uint16_t>(exp + 15);
-    uint16_t h_mantissa = static_cast<uint16_t>(mantissa >> 13);
-    return static_cast<uint16_t>((sign << 15) | (h_exp << 10) | h_mantissa);
+// Float32 layout: dim floats.
+static float f32_ip_distance(const void* a, const void* b, const void* param) {
+    auto* p = static_cast<const SpaceParam*>(param);
+    t_distance_computations++;
+    return 1.0f - p->kernels->dot_f32(static_cast<const float*>(a),
+                                      static_cast<const float*>(b), p->dim);
 }
 
-// Convert float16 to float32
-static float half_to_float(uint16_t h) {
-    uint32_t sign = (h >> 15) & 0x1;
-    uint32_t exp = (h >> 10) & 0x1F;
-    uint32_t mantissa = h & 0x3FF;
+// Inner-product space over float32 vectors. Stores the same bytes as
+// hnswlib::InnerProductSpace, whose SIMD variant is fixed by the flags the
+// wrapper is compiled with, but uses the runtime-selected kernel instead.
+class Float32InnerProductSpace : public hnswlib::SpaceInterface<float> {
+public:
+    explicit Float32InnerProductSpace(size_t dim) : param_{dim, &hnsw_kernels()} {}
 
-    uint32_t result;
+    size_t get_data_size() override { return param_.dim * sizeof(float); }
+    hnswlib::DISTFUNC<float> get_dist_func() override { return f32_ip_distance; }
+    void* get_dist_func_param() override { return &param_; }
 
-    if (exp == 0) {  // zero or denormalized
-        if (mantissa == 0) {
-            result = sign << 31;
-        } else {
-            // Denormalized: normalize it
-            exp = 1;
-            while ((mantissa & 0x400) == 0) {
-                mantissa <<= 1;
-                exp--;
-            }
-            mantissa &= 0x3FF;
-            result = (sign << 31) | ((exp + 127 - 15) << 23) | (mantissa << 13);
-        }
-    } else if (exp == 31) {  // inf or NaN
-        result = (sign << 31) | 0x7F800000 | (mantissa << 13);
-    } else {  // normalized
-        result = (sign << 31) | ((exp + 127 - 15) << 23) | (mantissa << 13);
+private:
+    SpaceParam param_;
+};
+
+// Helper: create the space for a storage precision
+static hnswlib::SpaceInterface<float>* make_space(HnswPrecision precision, int dim) {
+    if (precision == HNSW_PRECISION_FLOAT32) {
+        return new Float32InnerProductSpace(static_cast<size_t>(dim));
     }
+    return new QuantizedInnerProductSpace(precision, static_cast<size_t>(dim));
+}
 
-    float f;
-    std::memcpy(&f, &result, sizeof(float));
-    return f;
+static bool valid_precision(int32_t precision) {
+    return precision == HNSW_PRECISION_FLOAT32 || precision == HNSW_PRECISION_FLOAT16 ||
+           precision == HNSW_PRECISION_INT8;
 }
 
+// Default re-rank factor: int8 search fetches k * factor candidates and
+// re-scores them against the float32 query. Float16 error is small enough that
+// re-ranking is off by default.
+static const int kDefaultInt8RerankFactor = 4;
+
+// Default graph parameters: connections per element, construction beam width
+// and search beam width. M and ef_construction are fixed at creation and
+// persisted in the graph file; the search ef can be changed at any time.
+static const size_t kDefaultM = 16;
+static const size_t kDefaultEfConstruction = 200;
+static const size_t kDefaultEfSearch = 50;
+
+// Rows a batch add normalizes and encodes per work item
+static const size_t kEncodeBlockRows = 64;
+
 // =============================================================================
-// Int8 symmetric quantization (per-vector scale)
+// Read-only memory mapping
 // =============================================================================
 
-// Quantize a float32 vector to int8 with per-vector symmetric scaling
-// Returns the scale factor used
-static float quantize_vector_int8(const float* in, int8_t* out, int dim) {
-    // Find max absolute value
-    float max_abs = 0.0f;
-    for (int i = 0; i < dim; i++) {
-        max_abs = std::max(max_abs, std::abs(in[i]));
+// A file mapped read-only. Pages are shared through the page cache and only
+// faulted in when touched.
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+static bool map_file(const std::string& path, MappedFile* out) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    out->data = static_cast<const char*>(addr);
+    out->size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+static void unmap_file(MappedFile* file) {
+    if (file->data != nullptr) {
+        munmap(const_cast<char*>(file->data), file->size);
+        file->data = nullptr;
+        file->size = 0;
     }
+}
 
-    // Compute scale (map max_abs to 127)
-    float scale = (max_abs > 0) ? max_abs / 127.0f : 1.0f;
-    float inv_scale = (max_abs > 0) ? 127.0f / max_abs : 0.0f;
+// Bounds-checked sequential reader over a mapped file
+struct MappedReader {
+    const char* pos;
+    const char* end;
 
-    // Quantize
-    for (int i = 0; i < dim; i++) {
-        float val = in[i] * inv_scale;
-        val = std::max(-127.0f, std::min(127.0f, val));
-        out[i] = static_cast<int8_t>(std::round(val));
+    template <typename T>
+    bool read(T* value) {
+        if (static_cast<size_t>(end - pos) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(value, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
     }
 
-    return scale;
-}
+    // Returns a pointer to the next n bytes and skips them, or nullptr
+    const char* take(size_t n) {
+        if (static_cast<size_t>(end - pos) < n) {
+            return nullptr;
+        }
+        const char* p = pos;
+        pos += n;
+        return p;
+    }
+};
+
+// =============================================================================
+// Filter attributes
+// =============================================================================
+
+// Ordinal of an unset attribute
+static const uint32_t kNoAttribute = UINT32_MAX;
 
-// Dequantize an int8 vector back to float32
-static void dequantize_vector_int8(const int8_t* in, float* out, int dim, float scale) {
-    for (int i = 0; i < dim; i++) {
-        out[i] = static_cast<float>(in[i]) * scale;
+// Interned attribute values. Labels store ordinals, so the per-label
+// attribute array stays at 8 bytes per vector however long the IDs are.
+struct AttributeDict {
+    std::vector<std::string> values;
+    std::unordered_map<std::string, uint32_t> ordinals;
+
+    uint32_t intern(std::string_view value) {
+        if (value.empty()) {
+            return kNoAttribute;
+        }
+        std::string key(value);
+        auto it = ordinals.find(key);
+        if (it != ordinals.end()) {
+            return it->second;
+        }
+        uint32_t ordinal = static_cast<uint32_t>(values.size());
+        values.push_back(key);
+        ordinals.emplace(std::move(key), ordinal);
+        return ordinal;
     }
-}
+
+    uint32_t find(const char* value) const {
+        auto it = ordinals.find(value);
+        return it != ordinals.end() ? it->second : kNoAttribute;
+    }
+};
+
+struct LabelAttributes {
+    uint32_t source = kNoAttribute;
+    uint32_t document = kNoAttribute;
+};
 
 // =============================================================================
 // Internal structure holding the HNSW index and ID mappings
 // =============================================================================
 
+using Clock = std::chrono::steady_clock;
+
+static uint64_t nanos_since(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+// Log2 histogram with the HNSW_STATS_BUCKETS bucketing
+struct HnswHistogram {
+    std::atomic<uint64_t> buckets[HNSW_STATS_BUCKETS] = {};
+
+    void add(uint64_t value) {
+        size_t bucket = value < 2 ? 0 : static_cast<size_t>(63 - __builtin_clzll(value));
+        buckets[std::min<size_t>(bucket, HNSW_STATS_BUCKETS - 1)].fetch_add(
+            1, std::memory_order_relaxed);
+    }
+
+    void copy_to(uint64_t* out) const {
+        for (size_t i = 0; i < HNSW_STATS_BUCKETS; i++) {
+            out[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Counters behind hnsw_stats, updated with relaxed atomics
+struct IndexStats {
+    std::atomic<uint64_t> resizes{0};
+    std::atomic<uint64_t> searches{0};
+    std::atomic<uint64_t> distance_computations{0};
+    std::atomic<uint64_t> search_ns{0};
+    HnswHistogram distances;
+    HnswHistogram latency_us;
+    std::atomic<uint64_t> lock_waits{0};
+    std::atomic<uint64_t> read_wait_ns{0};
+    std::atomic<uint64_t> exclusive_wait_ns{0};
+    std::atomic<uint64_t> writer_wait_ns{0};
+};
+
+// Background maintenance thread of an index (hnsw_set_background_flush).
+// Lock order: write_mutex may be held while taking mutex, never the reverse.
+struct HnswFlusher {
+    std::mutex control_mutex;  // Serializes starting and stopping
+    std::thread thread;
+    std::mutex mutex;          // Guards stop and requested
+    std::condition_variable wake;
+    bool stop = false;
+    bool requested = false;    // max_unsynced was reached
+    std::atomic<bool> active{false};
+    std::atomic<int> interval_ms{1000};
+    std::atomic<int> max_unsynced{1000};
+    std::atomic<int64_t> max_log_bytes{0};
+};
+
+// Locking:
+//   write_mutex serializes writers (add/delete/checkpoint/close) and guards the
+//   writer-only state (next_label, free_labels, modified, wal, unsynced), so that
+//   normalization and bookkeeping happen without holding the index lock.
+//   mutex is a reader/writer lock over the graph and ids. Searches take
+//   it shared and run in parallel; graph and mapping mutations take it
+//   exclusively. hnswlib does not allow addPoint concurrently with searchKnn,
+//   so inserts hold it exclusively per vector (or per slice in a batch) rather
+//   than for a whole burst.
+//
+// A read-only index (hnsw_open_readonly) maps the graph and the ID table
+// instead of loading them: the level-0 graph and upper-layer link lists point
+// into graph_map, and the ID table points into mapping_map. All mutations are
+// rejected.
 struct HnswIndex {
-    hnswlib::InnerProductSpace* space;
+    hnswlib::SpaceInterface<float>* space;
     hnswlib::HierarchicalNSW<float>* hnsw;
-    std::unordered_map<std::string, hnswlib::labeltype> id_to_label;
-    std::vector<std::string> label_to_id;
+    ChunkIdTable ids;  // chunk ID <-> label
     std::string path;
     int dimension;
     size_t max_elements;
     hnswlib::labeltype next_label;
-    std::mutex mutex;
-    bool modified;
-    HnswPrecision precision;  // Storage precision
+    std::vector<hnswlib::labeltype> free_labels;  // Tombstoned labels to revive
+    std::mutex write_mutex;
+    std::shared_mutex mutex;
+    bool modified;            // Changed since the last checkpoint
+    bool snapshot_required;   // Changes not covered by the WAL; checkpoint on close
+    HnswWal wal;
+    uint64_t checkpoint_seq;  // Snapshot generation the WAL belongs to
+    uint64_t unsynced = 0;    // Changes logged since the WAL was last synced
+    HnswFlusher flusher;
+    HnswPrecision precision;  // Storage precision (in memory and on disk)
+    int rerank_factor;        // Float32 re-rank candidates per result (0 = off)
+    bool readonly = false;
+    bool staged = false;      // Read-only: mapped a snapshot not yet installed
+    MappedFile graph_map;
+    MappedFile mapping_map;
+    AttributeDict sources;                     // Filter attribute values
+    AttributeDict documents;
+    std::vector<LabelAttributes> label_attrs;  // label -> attribute ordinals
+    size_t unsourced_count = 0;  // Live labels without a source (see AttributeFilter)
+    uint64_t label_generation = 0;  // Bumped when a label may name another chunk
+    IndexStats stats;
+};
+
+// Helper: acquire mutex as Lock, adding the time spent blocked to *wait_ns.
+// An uncontended acquisition is one try_lock with no clock reads.
+template <typename Lock, typename Mutex>
+static Lock timed_lock(HnswIndex* idx, Mutex& mutex, std::atomic<uint64_t>* wait_ns) {
+    Lock lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        Clock::time_point start = Clock::now();
+        lock.lock();
+        wait_ns->fetch_add(nanos_since(start), std::memory_order_relaxed);
+        idx->stats.lock_waits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return lock;
+}
+
+// index->mutex, shared (searches)
+static std::shared_lock<std::shared_mutex> read_lock(HnswIndex* idx) {
+    return timed_lock<std::shared_lock<std::shared_mutex>>(idx, idx->mutex,
+                                                           &idx->stats.read_wait_ns);
+}
+
+// index->mutex, exclusive (graph and mapping mutations)
+static std::unique_lock<std::shared_mutex> exclusive_lock(HnswIndex* idx) {
+    return timed_lock<std::unique_lock<std::shared_mutex>>(idx, idx->mutex,
+                                                           &idx->stats.exclusive_wait_ns);
+}
+
+// index->write_mutex (adds and deletes)
+static std::unique_lock<std::mutex> writer_lock(HnswIndex* idx) {
+    return timed_lock<std::unique_lock<std::mutex>>(idx, idx->write_mutex,
+                                                    &idx->stats.writer_wait_ns);
+}
+
+// Helper: records one search in the index stats when it goes out of scope.
+// Must live on the searching thread.
+class SearchRecorder {
+public:
+    explicit SearchRecorder(HnswIndex* idx)
+        : idx_(idx), start_(Clock::now()), distances_(t_distance_computations) {}
+    SearchRecorder(const SearchRecorder&) = delete;
+    SearchRecorder& operator=(const SearchRecorder&) = delete;
+
+    ~SearchRecorder() {
+        IndexStats& stats = idx_->stats;
+        uint64_t ns = nanos_since(start_);
+        uint64_t distances = t_distance_computations - distances_;
+        stats.searches.fetch_add(1, std::memory_order_relaxed);
+        stats.distance_computations.fetch_add(distances, std::memory_order_relaxed);
+        stats.search_ns.fetch_add(ns, std::memory_order_relaxed);
+        stats.distances.add(distances);
+        stats.latency_us.add(ns / 1000);
+    }
+
+private:
+    HnswIndex* idx_;
+    Clock::time_point start_;
+    uint64_t distances_;
+};
+
+// Helper: chunk ID for a label, or an empty view if the label is unmapped
+static std::string_view chunk_id_of(const HnswIndex* idx, hnswlib::labeltype label) {
+    return idx->ids.id(label);
+}
+
+// Helper: filter attributes of a label (unset if the label has none)
+static LabelAttributes attributes_of(const HnswIndex* idx, hnswlib::labeltype label) {
+    return label < idx->label_attrs.size() ? idx->label_attrs[label] : LabelAttributes();
+}
+
+// Helper: whether label has no source attribute: it was added without one or
+// loaded from a mapping older than version 4, which stored no attributes
+static bool unsourced(const HnswIndex* idx, hnswlib::labeltype label) {
+    return attributes_of(idx, label).source == kNoAttribute;
+}
+
+// Helper: hnswlib filter over label attributes. The listed IDs are resolved
+// to ordinal sets once per search, so each visited element costs two array
+// lookups. A vector without a source passes a source allow list, since its
+// source is unknown rather than different; callers check the sources of the
+// hits they keep. Caller must hold index->mutex (shared) while it is in use.
+class AttributeFilter : public hnswlib::BaseFilterFunctor {
+public:
+    AttributeFilter(const HnswIndex* idx, const HnswFilter& filter)
+        : idx_(idx), exclude_(filter.exclude != 0),
+          restrict_sources_(filter.num_source_ids > 0),
+          restrict_documents_(filter.num_document_ids > 0),
+          any_unsourced_(idx->unsourced_count > 0) {
+        matched_sources_ = resolve(idx->sources, filter.source_ids, filter.num_source_ids,
+                                   &sources_);
+        matched_documents_ = resolve(idx->documents, filter.document_ids,
+                                     filter.num_document_ids, &documents_);
+    }
+
+    // True if no vector can pass: an allow list names only unknown values
+    // (and, for sources, every vector has one)
+    bool rejects_all() const {
+        return !exclude_ &&
+               ((restrict_sources_ && matched_sources_ == 0 && !any_unsourced_) ||
+                (restrict_documents_ && matched_documents_ == 0));
+    }
+
+    bool operator()(hnswlib::labeltype label) override {
+        LabelAttributes attrs = attributes_of(idx_, label);
+        bool source_listed = listed(sources_, attrs.source);
+        bool document_listed = listed(documents_, attrs.document);
+        if (exclude_) {
+            return !source_listed && !document_listed;
+        }
+        return (!restrict_sources_ || source_listed || attrs.source == kNoAttribute) &&
+               (!restrict_documents_ || document_listed);
+    }
+
+private:
+    static size_t resolve(const AttributeDict& dict, const char* const* ids, int count,
+                          std::vector<char>* set) {
+        size_t matched = 0;
+        set->assign(dict.values.size(), 0);
+        for (int i = 0; i < count; i++) {
+            uint32_t ordinal = ids[i] != nullptr ? dict.find(ids[i]) : kNoAttribute;
+            if (ordinal != kNoAttribute && !(*set)[ordinal]) {
+                (*set)[ordinal] = 1;
+                matched++;
+            }
+        }
+        return matched;
+    }
+
+    static bool listed(const std::vector<char>& set, uint32_t ordinal) {
+        return ordinal < set.size() && set[ordinal];
+    }
+
+    const HnswIndex* idx_;
+    bool exclude_;
+    bool restrict_sources_;
+    bool restrict_documents_;
+    bool any_unsourced_;
+    size_t matched_sources_;
+    size_t matched_documents_;
+    std::vector<char> sources_;
+    std::vector<char> documents_;
 };
 
 // Helper: normalize vector for cosine similarity via inner product
 static void normalize_vector(float* vec, int dim) {
-    float norm = 0.0f;
-    for (int i = 0; i < dim; i++) {
-        norm += vec[i] * vec[i];
+    hnsw_kernels().normalize(vec, vec, static_cast<size_t>(dim));
+}
+
+// Helper: encode count normalized float32 vectors, stored back to back, into
+// the index's storage format. out must hold count * space->get_data_size()
+// bytes.
+static void encode_vectors(const HnswIndex* idx, const float* vecs, size_t count, char* out) {
+    const size_t dim = static_cast<size_t>(idx->dimension);
+    switch (idx->precision) {
+    case HNSW_PRECISION_FLOAT16:
+        // Records are bare halves, so the whole buffer converts in one pass
+        hnsw_kernels().f32_to_f16(vecs, reinterpret_cast<uint16_t*>(out), count * dim);
+        break;
+    case HNSW_PRECISION_INT8:
+        hnsw_quantize_i8_batch(vecs, out, count, dim);
+        break;
+    default:
+        std::memcpy(out, vecs, count * dim * sizeof(float));
+        break;
+    }
+}
+
+// Helper: encode one normalized float32 vector (see encode_vectors)
+static void encode_vector(const HnswIndex* idx, const float* vec, char* out) {
+    encode_vectors(idx, vec, 1, out);
+}
+
+// Helper: similarity between a float32 query and a stored compressed vector.
+static float rescore(const HnswIndex* idx, const float* query, const char* stored) {
+    const HnswKernels& kernels = hnsw_kernels();
+    t_distance_computations++;
+    const size_t dim = static_cast<size_t>(idx->dimension);
+    if (idx->precision == HNSW_PRECISION_FLOAT16) {
+        return kernels.dot_f16_f32(reinterpret_cast<const uint16_t*>(stored), query, dim);
+    }
+    float scale;
+    std::memcpy(&scale, stored, sizeof(float));
+    return scale * kernels.dot_i8_f32(reinterpret_cast<const int8_t*>(stored + sizeof(float)),
+                                      query, dim);
+}
+
+// Number of vectors inserted per exclusive lock hold in hnsw_add_batch.
+// Searches waiting on the lock get a turn between slices.
+static const size_t kBatchSliceSize = 256;
+
+// Helper: grow the index so that labels below required fit.
+// Caller must hold index->mutex exclusively.
+static void ensure_capacity(HnswIndex* idx, size_t required) {
+    if (required <= idx->max_elements) {
+        return;
+    }
+    size_t new_max = idx->max_elements;
+    while (new_max < required) {
+        new_max *= 2;
+    }
+    idx->hnsw->resizeIndex(new_max);
+    idx->max_elements = new_max;
+    idx->stats.resizes.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Helper: mark label deleted in the graph unless it is absent or already
+// deleted (WAL replay may revisit labels the snapshot already retired), and
+// queue its slot for reuse. Caller must hold write_mutex and index->mutex
+// exclusively.
+static void retire_label(HnswIndex* idx, hnswlib::labeltype label) {
+    {
+        std::lock_guard<std::mutex> lock(idx->hnsw->label_lookup_lock);
+        auto it = idx->hnsw->label_lookup_.find(label);
+        if (it == idx->hnsw->label_lookup_.end()) {
+            return;
+        }
+        if (idx->hnsw->isMarkedDeleted(it->second)) {
+            idx->free_labels.push_back(label);
+            return;
+        }
+    }
+    idx->hnsw->markDelete(label);
+    idx->free_labels.push_back(label);
+}
+
+// Helper: label for a new vector. A tombstoned label is reused first: adding
+// a point under a deleted label revives that graph slot in place (hnswlib
+// unmarks it and repairs its links), so deletes and updates do not grow the
+// graph or the ID table. Otherwise a fresh label is taken.
+// Caller must hold write_mutex.
+static hnswlib::labeltype allocate_label(HnswIndex* idx) {
+    if (!idx->free_labels.empty()) {
+        hnswlib::labeltype label = idx->free_labels.back();
+        idx->free_labels.pop_back();
+        return label;
+    }
+    return idx->next_label++;
+}
+
+// Helper: give back a label allocate_label handed out for a vector that was
+// never published, so its slot is not lost. A label the graph knows (a
+// tombstone, or one whose addPoint failed part way) is retired again; a fresh
+// label never reached the graph and is queued for reuse as it is.
+// Caller must hold write_mutex and index->mutex exclusively.
+static void release_label(HnswIndex* idx, hnswlib::labeltype label) {
+    bool in_graph;
+    {
+        std::lock_guard<std::mutex> lock(idx->hnsw->label_lookup_lock);
+        in_graph = idx->hnsw->label_lookup_.count(label) > 0;
+    }
+    if (in_graph) {
+        retire_label(idx, label);
+    } else {
+        idx->free_labels.push_back(label);
+    }
+}
+
+// Helper: collect the tombstoned labels of a freshly loaded index.
+static void rebuild_free_labels(HnswIndex* idx) {
+    idx->free_labels.clear();
+    std::lock_guard<std::mutex> lock(idx->hnsw->label_lookup_lock);
+    for (const auto& entry : idx->hnsw->label_lookup_) {
+        hnswlib::labeltype label = entry.first;
+        if (idx->hnsw->isMarkedDeleted(entry.second) && idx->ids.id(label).empty()) {
+            idx->free_labels.push_back(label);
+        }
+    }
+    std::sort(idx->free_labels.rbegin(), idx->free_labels.rend());  // Lowest reused first
+}
+
+// Helper: point id at label with the given filter attributes, retiring any
+// label it previously held.
+// Caller must hold write_mutex and index->mutex exclusively.
+static void publish_mapping(HnswIndex* idx, const std::string& id, hnswlib::labeltype label,
+                            std::string_view source, std::string_view document) {
+    uint64_t previous;
+    if (idx->ids.find(id, &previous) && previous != label) {
+        retire_label(idx, previous);
+        idx->unsourced_count -= unsourced(idx, previous) ? 1 : 0;
+        idx->ids.erase(previous);
+        idx->label_attrs[previous] = LabelAttributes();
+    }
+
+    if (label < idx->ids.size() && !idx->ids.id(label).empty()) {
+        idx->unsourced_count -= unsourced(idx, label) ? 1 : 0;
+    }
+    if (label < idx->ids.size() && idx->ids.id(label) != id) {
+        // A revived label may still be cached under the chunk it used to name
+        idx->label_generation++;
+    }
+    idx->ids.assign(label, id);
+    idx->label_attrs.resize(idx->ids.size());
+    idx->label_attrs[label] = {idx->sources.intern(source), idx->documents.intern(document)};
+    idx->unsourced_count += unsourced(idx, label) ? 1 : 0;
+}
+
+// Helper: remove id from the graph and mappings. Returns false if id is not
+// in the index. Caller must hold write_mutex and index->mutex exclusively.
+static bool remove_mapping(HnswIndex* idx, const std::string& id) {
+    uint64_t label;
+    if (!idx->ids.find(id, &label)) {
+        return false;
+    }
+
+    retire_label(idx, label);
+    idx->unsourced_count -= unsourced(idx, label) ? 1 : 0;
+    idx->ids.erase(label);  // Clear but keep slot
+    if (label < idx->label_attrs.size()) {
+        idx->label_attrs[label] = LabelAttributes();
+    }
+    return true;
+}
+
+// Helper: run fn(i) for every i in [0, n) on a pool of worker threads.
+// num_threads <= 0 uses the hardware concurrency. Work is handed out through a
+// shared counter so uneven per-item cost still balances across workers.
+// Returns false if any invocation threw (remaining items are skipped).
+template <typename Fn>
+static bool parallel_for(size_t n, int num_threads, Fn fn) {
+    size_t workers = num_threads > 0 ? static_cast<size_t>(num_threads)
+                                     : std::thread::hardware_concurrency();
+    workers = std::max<size_t>(1, std::min(workers, n));
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    auto run = [&]() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= n) {
+                break;
+            }
+            try {
+                fn(i);
+            } catch (...) {
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t t = 1; t < workers; t++) {
+        threads.emplace_back(run);
+    }
+    run();  // The calling thread works too
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    return !failed;
+}
+
+// Helper: parallel_for over a worker pool that outlives a single call. The
+// threads are started once and wait between rounds, so a batch that runs many
+// short rounds (one per insert slice) does not create and join threads for
+// each. The calling thread works in every round too.
+class WorkerPool {
+public:
+    // num_threads <= 0 uses the hardware concurrency; no more than max_items
+    // workers are started. A thread that fails to start leaves fewer workers.
+    WorkerPool(int num_threads, size_t max_items) {
+        size_t workers = num_threads > 0 ? static_cast<size_t>(num_threads)
+                                         : std::thread::hardware_concurrency();
+        workers = std::max<size_t>(1, std::min(workers, max_items));
+        threads_.reserve(workers - 1);
+        for (size_t t = 1; t < workers; t++) {
+            try {
+                threads_.emplace_back([this] { serve(); });
+            } catch (...) {
+                break;
+            }
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs fn(i) for every i in [0, n) as parallel_for does, returning once
+    // all workers are done. Returns false if any invocation threw (remaining
+    // items are skipped).
+    bool run(size_t n, std::function<void(size_t)> fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = std::move(fn);
+            n_ = n;
+            next_ = 0;
+            failed_ = false;
+            busy_ = threads_.size();
+            round_++;
+        }
+        wake_.notify_all();
+        work();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        job_ = nullptr;
+        return !failed_;
+    }
+
+private:
+    void serve() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || round_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = round_;
+            }
+            work();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    void work() {
+        while (!failed_.load(std::memory_order_relaxed)) {
+            size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+            if (i >= n_) {
+                break;
+            }
+            try {
+                job_(i);
+            } catch (...) {
+                failed_ = true;
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;  // A round started or the pool is stopping
+    std::condition_variable done_;  // The last worker finished its round
+    std::function<void(size_t)> job_;
+    size_t n_ = 0;
+    std::atomic<size_t> next_{0};
+    std::atomic<bool> failed_{false};
+    size_t busy_ = 0;     // Workers (other than the caller) still in this round
+    uint64_t round_ = 0;  // Bumped for each run
+    bool stop_ = false;
+};
+
+// Helper: k-NN search as in HierarchicalNSW::searchKnn (greedy descent,
+// then a beam search of width max(ef, k) on the base layer), but returning
+// internal ids so stored vectors can be read for re-ranking. Results are
+// best first. skip_deleted excludes deleted elements from the results, and
+// filter (may be NULL) restricts them to the labels it accepts; traversal
+// still passes through rejected elements, so the k best eligible ones are
+// found rather than the eligible subset of the k best. Results replace the
+// contents of out. Caller must hold index->mutex (shared).
+static void search_candidates(
+        const hnswlib::HierarchicalNSW<float>* hnsw, const void* query, size_t k, size_t ef,
+        bool skip_deleted, hnswlib::BaseFilterFunctor* filter,
+        std::vector<std::pair<float, hnswlib::tableint>>* out) {
+    out->clear();
+    if (hnsw->cur_element_count == 0) {
+        return;
+    }
+
+    hnswlib::tableint curr = hnsw->enterpoint_node_;
+    float curdist = hnsw->fstdistfunc_(query, hnsw->getDataByInternalId(curr),
+                                       hnsw->dist_func_param_);
+    for (int level = hnsw->maxlevel_; level > 0; level--) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            hnswlib::linklistsizeint* data = hnsw->get_linklist(curr, level);
+            int size = hnsw->getListCount(data);
+            hnswlib::tableint* neighbors = reinterpret_cast<hnswlib::tableint*>(data + 1);
+            for (int i = 0; i < size; i++) {
+                hnswlib::tableint cand = neighbors[i];
+                float d = hnsw->fstdistfunc_(query, hnsw->getDataByInternalId(cand),
+                                             hnsw->dist_func_param_);
+                if (d < curdist) {
+                    curdist = d;
+                    curr = cand;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // The non-bare-bone variant skips deleted and filtered-out elements when
+    // collecting results
+    auto top = skip_deleted || filter != nullptr
+        ? hnsw->searchBaseLayerST<false>(curr, query, std::max(ef, k), filter)
+        : hnsw->searchBaseLayerST<true>(curr, query, std::max(ef, k));
+    while (top.size() > k) {
+        top.pop();
+    }
+
+    out->resize(top.size());
+    for (size_t i = out->size(); i-- > 0;) {
+        (*out)[i] = top.top();  // heap yields the farthest first
+        top.pop();
     }
-    norm = std::sqrt(norm);
-    if (norm > 0) {
-        for (int i = 0; i < dim; i++) {
-            vec[i] /= norm;
+}
+
+// Helper: k-NN search returning live (mapped) hits as (distance, label),
+// best first. query must already be normalized. Compressed precisions search
+// in their storage format and, if enabled, re-rank k * rerank_factor
+// candidates against the float32 query. options (may be NULL) overrides the
+// index's ef and re-rank factor for this call only and may add an attribute
+// filter. Results replace the contents of hits, and the scratch buffers are
+// reused per thread, so steady-state searches allocate only inside hnswlib.
+// Caller must hold index->mutex (shared).
+static void search_live(HnswIndex* idx, const float* query, size_t k,
+                        const HnswSearchOptions* options,
+                        std::vector<std::pair<float, hnswlib::labeltype>>* hits) {
+    SearchRecorder recorder(idx);
+    hits->clear();
+    std::unique_ptr<AttributeFilter> filter;
+    if (options != nullptr && options->filter != nullptr) {
+        filter.reset(new AttributeFilter(idx, *options->filter));
+        if (filter->rejects_all()) {
+            return;
+        }
+    }
+
+    thread_local std::vector<char> encoded;
+    thread_local std::vector<std::pair<float, hnswlib::tableint>> candidates;
+    encoded.resize(idx->space->get_data_size());
+    encode_vector(idx, query, encoded.data());
+
+    const size_t ef = options != nullptr && options->ef > 0 ? static_cast<size_t>(options->ef)
+                                                            : idx->hnsw->ef_;
+    const int rerank_factor = options != nullptr && options->rerank_factor > 0
+        ? options->rerank_factor : idx->rerank_factor;
+    const bool rerank = idx->precision != HNSW_PRECISION_FLOAT32 && rerank_factor > 1;
+    const size_t fetch = rerank ? k * static_cast<size_t>(rerank_factor) : k;
+    // A mapped index does not count its deleted elements (that would touch
+    // every page), so it always checks the delete marks
+    const bool skip_deleted = idx->readonly || idx->hnsw->num_deleted_ > 0;
+    search_candidates(idx->hnsw, encoded.data(), fetch, ef, skip_deleted, filter.get(),
+                      &candidates);
+
+    hits->reserve(candidates.size());
+    for (const auto& cand : candidates) {
+        hnswlib::labeltype label = idx->hnsw->getExternalLabel(cand.second);
+        if (chunk_id_of(idx, label).empty()) {
+            continue;
+        }
+        float dist = cand.first;
+        if (rerank) {
+            dist = 1.0f - rescore(idx, query, idx->hnsw->getDataByInternalId(cand.second));
+        }
+        hits->emplace_back(dist, label);
+    }
+
+    if (rerank) {
+        std::stable_sort(hits->begin(), hits->end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+    }
+    if (hits->size() > k) {
+        hits->resize(k);
+    }
+}
+
+// id_mapping.bin layout. Version 1 files start directly with the int32
+// precision (0..2); later versions start with a magic and a version number.
+// Version 2 means the graph was persisted for every precision; version 3
+// adds the snapshot generation (uint64) after the precision; version 4
+// appends the filter attributes: the source and document dictionaries
+// (uint32 count, then uint32 length and bytes per value) followed by one
+// (uint32 source, uint32 document) ordinal pair per label.
+// Versions 1-4 store one (label, length, bytes) record per ID. Version 5
+// replaces them with the ChunkIdTable block (see hnsw_ids.cpp), which is
+// copied in a few memcpys or used in place by a read-only open; its header is
+// magic, version, int32 precision, uint32 zero, uint64 seq, uint64 next_label
+// so the block starts 8-byte aligned. The attributes follow the block as in
+// version 4.
+static const uint32_t kMappingMagic = 0x4D4E4853;  // "SHNM"
+static const uint32_t kMappingVersion = 5;
+
+// Helper: write an attribute dictionary
+static void save_dict(std::ostream& out, const AttributeDict& dict) {
+    uint32_t count = static_cast<uint32_t>(dict.values.size());
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& value : dict.values) {
+        uint32_t len = static_cast<uint32_t>(value.size());
+        out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        out.write(value.data(), len);
+    }
+}
+
+// Helper: read an attribute dictionary written by save_dict
+static bool map_dict(MappedReader& in, AttributeDict* dict) {
+    uint32_t count;
+    if (!in.read(&count)) {
+        return false;
+    }
+    *dict = AttributeDict();
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t len;
+        const char* value;
+        if (!in.read(&len) || (value = in.take(len)) == nullptr) {
+            return false;
         }
+        dict->values.emplace_back(value, len);
+        dict->ordinals.emplace(dict->values.back(), i);
     }
+    return true;
 }
 
-// Helper: save ID mappings to file (includes precision metadata)
-static bool save_id_mappings(HnswIndex* idx) {
-    std::string mapping_path = idx->path + "/id_mapping.bin";
-    std::ofstream out(mapping_path, std::ios::binary);
-    if (!out.is_open()) {
+// Helper: save ID mappings to file (includes precision metadata) as
+// snapshot generation seq
+static bool save_id_mappings(HnswIndex* idx, uint64_t seq, const std::string& file) {
+    SnapshotWriter writer;
+    if (!writer.open(file)) {
         return false;
     }
+    std::ostream out(&writer);
+
+    // Write format header
+    out.write(reinterpret_cast<const char*>(&kMappingMagic), sizeof(kMappingMagic));
+    out.write(reinterpret_cast<const char*>(&kMappingVersion), sizeof(kMappingVersion));
 
-    // Write precision (new field)
+    // Write precision, padding, snapshot generation and next_label
     int32_t prec = static_cast<int32_t>(idx->precision);
+    uint32_t reserved = 0;
+    uint64_t next_label = idx->next_label;
     out.write(reinterpret_cast<const char*>(&prec), sizeof(prec));
+    out.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+    out.write(reinterpret_cast<const char*>(&seq), sizeof(seq));
+    out.write(reinterpret_cast<const char*>(&next_label), sizeof(next_label));
 
-    // Write number of mappings
-    size_t count = idx->label_to_id.size();
-    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
-
-    // Write next_label
-    out.write(reinterpret_cast<const char*>(&idx->next_label), sizeof(idx->next_label));
+    // Write the ID table
+    if (!idx->ids.write(out)) {
+        return false;
+    }
+    size_t count = idx->ids.size();
 
-    // Write each mapping: label, string length, string data
+    // Write filter attributes
+    save_dict(out, idx->sources);
+    save_dict(out, idx->documents);
     for (size_t i = 0; i < count; i++) {
-        hnswlib::labeltype label = static_cast<hnswlib::labeltype>(i);
-        const std::string& id = idx->label_to_id[i];
-        size_t len = id.size();
-        out.write(reinterpret_cast<const char*>(&label), sizeof(label));
-        out.write(reinterpret_cast<const char*>(&len), sizeof(len));
-        out.write(id.data(), len);
+        LabelAttributes attrs = attributes_of(idx, static_cast<hnswlib::labeltype>(i));
+        out.write(reinterpret_cast<const char*>(&attrs.source), sizeof(attrs.source));
+        out.write(reinterpret_cast<const char*>(&attrs.document), sizeof(attrs.document));
+    }
+
+    return out.good() && writer.commit();
+}
+
+// Helper: path of the persisted HNSW graph. Float32 keeps the original
+// index.bin; compressed precisions use their own file so the stored vector
+// format is clear from the name.
+static std::string graph_path(const HnswIndex* idx) {
+    switch (idx->precision) {
+    case HNSW_PRECISION_FLOAT16:
+        return idx->path + "/graph.f16";
+    case HNSW_PRECISION_INT8:
+        return idx->path + "/graph.i8";
+    default:
+        return idx->path + "/index.bin";
     }
+}
 
-    return out.good();
+// Files an index directory may hold, in any precision or format version
+static const char* const kIndexFiles[] = {
+    "id_mapping.bin", "index.bin", "graph.f16", "graph.i8", "vectors.f16", "vectors.i8",
+    "wal.log",
+};
+
+// Graph files, one per precision
+static const char* const kGraphFiles[] = {"index.bin", "graph.f16", "graph.i8"};
+
+// Suffix of a snapshot file written by a checkpoint but not yet renamed into
+// place. The staged id_mapping.bin commits the generation (see checkpoint).
+static const char kStagedSuffix[] = ".next";
+
+// Helper: whether path holds any file of an index
+static bool index_files_exist(const std::string& path) {
+    std::error_code ec;
+    for (const char* name : kIndexFiles) {
+        const std::string file = path + "/" + name;
+        if (std::filesystem::exists(file, ec) ||
+            std::filesystem::exists(file + kStagedSuffix, ec)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-// Helper: save vectors in compressed format (float16 or int8)
-static bool save_compressed_vectors(HnswIndex* idx) {
-    if (idx->precision == HNSW_PRECISION_FLOAT32) {
-        return true;  // No separate file needed for float32
+// Helper: finish installing a staged snapshot. A staged id_mapping.bin means
+// the generation was committed, so the staged graph (unless already moved)
+// and then the mapping are renamed into place. A staged graph without a
+// staged mapping is from an unfinished checkpoint and is discarded.
+// Caller must have write access to path.
+static bool install_staged_snapshot(const std::string& path) {
+    std::error_code ec;
+    const std::string mapping = path + "/id_mapping.bin";
+    const bool committed = std::filesystem::exists(mapping + kStagedSuffix, ec);
+    for (const char* name : kGraphFiles) {
+        const std::string file = path + "/" + name;
+        if (!std::filesystem::exists(file + kStagedSuffix, ec)) {
+            continue;
+        }
+        if (!committed) {
+            std::filesystem::remove(file + kStagedSuffix, ec);
+        } else if (!rename_durably(file + kStagedSuffix, file)) {
+            return false;
+        }
     }
+    return !committed || rename_durably(mapping + kStagedSuffix, mapping);
+}
 
+// Helper: load legacy (version 1) compressed vectors and rebuild the HNSW
+// graph from them
+static bool load_compressed_vectors(HnswIndex* idx) {
     std::string vec_path;
     if (idx->precision == HNSW_PRECISION_FLOAT16) {
         vec_path = idx->path + "/vectors.f16";
-    } else {
+    } else if (idx->precision == HNSW_PRECISION_INT8) {
         vec_path = idx->path + "/vectors.i8";
+    } else {
+        return true;  // Float32 doesn't use separate vector file
     }
 
-    std::ofstream out(vec_path, std::ios::binary);
-    if (!out.is_open()) {
+    MappedFile file;
+    if (!map_file(vec_path, &file)) {
         return false;
     }
+    madvise(const_cast<char*>(file.data), file.size, MADV_SEQUENTIAL);
+    MappedReader in{file.data, file.data + file.size};
 
-    // Write header
-    uint32_t num_vectors = static_cast<uint32_t>(idx->label_to_id.size());
-    uint32_t dimensions = static_cast<uint32_t>(idx->dimension);
-    out.write(reinterpret_cast<const char*>(&num_vectors), sizeof(num_vectors));
-    out.write(reinterpret_cast<const char*>(&dimensions), sizeof(dimensions));
-
-    // Write each vector
-    for (size_t label = 0; label < idx->label_to_id.size(); label++) {
-        if (idx->label_to_id[label].empty()) {
-            // Deleted entry - write zeros
-            if (idx->precision == HNSW_PRECISION_FLOAT16) {
-                std::vector<uint16_t> zeros(idx->dimension, 0);
-                out.write(reinterpret_cast<const char*>(zeros.data()),
-                         idx->dimension * sizeof(uint16_t));
-            } else {
-                float zero_scale = 0.0f;
-                out.write(reinterpret_cast<const char*>(&zero_scale), sizeof(zero_scale));
-                std::vector<int8_t> zeros(idx->dimension, 0);
-                out.write(reinterpret_cast<const char*>(zeros.data()), idx->dimension);
-            }
-            continue;
-        }
+    // Read header
+    uint32_t num_vectors, dimensions;
+    if (!in.read(&num_vectors) || !in.read(&dimensions) ||
+        static_cast<int>(dimensions) != idx->dimension) {
+        unmap_file(&file);
+        return false;
+    }
 
-        // Get float32 vector from HNSW
-        std::vector<float> vec(idx->dimension);
-        try {
-            std::vector<float> data_vec = idx->hnsw->getDataByLabel<float>(label);
-            std::memcpy(vec.data(), data_vec.data(), idx->dimension * sizeof(float));
-        } catch (...) {
-            // Label not found, write zeros
-            if (idx->precision == HNSW_PRECISION_FLOAT16) {
-                std::vector<uint16_t> zeros(idx->dimension, 0);
-                out.write(reinterpret_cast<const char*>(zeros.data()),
-                         idx->dimension * sizeof(uint16_t));
-            } else {
-                float zero_scale = 0.0f;
-                out.write(reinterpret_cast<const char*>(&zero_scale), sizeof(zero_scale));
-                std::vector<int8_t> zeros(idx->dimension, 0);
-                out.write(reinterpret_cast<const char*>(zeros.data()), idx->dimension);
-            }
-            continue;
+    // Add each vector straight from the mapping; records are already in the
+    // in-memory format
+    const size_t record = idx->space->get_data_size();
+    bool ok = true;
+    for (uint32_t label = 0; label < num_vectors; label++) {
+        const char* vec = in.take(record);
+        if (vec == nullptr) {
+            ok = false;
+            break;
         }
 
-        // Compress and write
-        if (idx->precision == HNSW_PRECISION_FLOAT16) {
-            std::vector<uint16_t> compressed(idx->dimension);
-            for (int i = 0; i < idx->dimension; i++) {
-                compressed[i] = float_to_half(vec[i]);
+        // Only add if this label has a valid ID
+        if (!idx->ids.id(label).empty()) {
+            try {
+                idx->hnsw->addPoint(vec, label);
+            } catch (...) {
+                // Ignore errors for individual vectors
             }
-            out.write(reinterpret_cast<const char*>(compressed.data()),
-                     idx->dimension * sizeof(uint16_t));
-        } else {  // INT8
-            std::vector<int8_t> compressed(idx->dimension);
-            float scale = quantize_vector_int8(vec.data(), compressed.data(), idx->dimension);
-            out.write(reinterpret_cast<const char*>(&scale), sizeof(scale));
-            out.write(reinterpret_cast<const char*>(compressed.data()), idx->dimension);
         }
     }
+    unmap_file(&file);
+    return ok;
+}
+
+// Helper: read the records of a version 1-4 mapping into the ID table.
+// Records naming an out-of-range label or an ID already mapped are skipped.
+static bool read_id_records(HnswIndex* idx, MappedReader& in, size_t count) {
+    idx->ids.clear();
+    idx->ids.reserve(count, 0);
+    idx->ids.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        hnswlib::labeltype label;
+        size_t len;
+        if (!in.read(&label) || !in.read(&len)) {
+            return false;
+        }
+        const char* id = in.take(len);
+        if (id == nullptr) {
+            return false;
+        }
+        if (label < count) {
+            idx->ids.assign(label, std::string_view(id, len));
+        }
+    }
+    return true;
+}
+
+// Helper: parse a mapped id_mapping.bin. A version 5 ID table is copied, or
+// with attach used in place (the file must then stay mapped); older records
+// are always copied. Sets *version to the mapping format version.
+static bool parse_id_mappings(HnswIndex* idx, const MappedFile& file, bool attach,
+                              uint32_t* version) {
+    MappedReader in{file.data, file.data + file.size};
+
+    // Read format header; version 1 files have no magic
+    uint32_t magic;
+    int32_t prec;
+    if (!in.read(&magic)) {
+        return false;
+    }
+    if (magic == kMappingMagic) {
+        if (!in.read(version) || *version < 2 || *version > kMappingVersion || !in.read(&prec)) {
+            return false;
+        }
+    } else {
+        *version = 1;
+        std::memcpy(&prec, &magic, sizeof(prec));
+    }
+    if (!valid_precision(prec)) {
+        return false;
+    }
+    idx->precision = static_cast<HnswPrecision>(prec);
+
+    // Read snapshot generation (version 3+)
+    uint32_t reserved;
+    idx->checkpoint_seq = 0;
+    if ((*version >= 5 && !in.read(&reserved)) ||
+        (*version >= 3 && !in.read(&idx->checkpoint_seq))) {
+        return false;
+    }
+
+    if (*version >= 5) {
+        uint64_t next_label;
+        size_t consumed;
+        if (!in.read(&next_label)) {
+            return false;
+        }
+        idx->next_label = static_cast<hnswlib::labeltype>(next_label);
+        size_t remaining = static_cast<size_t>(in.end - in.pos);
+        bool ok = attach ? idx->ids.attach(in.pos, remaining, &consumed)
+                         : idx->ids.load(in.pos, remaining, &consumed);
+        if (!ok) {
+            return false;
+        }
+        in.take(consumed);
+    } else {
+        size_t count;
+        if (!in.read(&count) || !in.read(&idx->next_label) || !read_id_records(idx, in, count)) {
+            return false;
+        }
+    }
+
+    // Attributes are small next to the IDs, so they are copied rather than
+    // read in place (the dictionaries need hash lookups anyway)
+    idx->label_attrs.assign(idx->ids.size(), LabelAttributes());
+    if (*version >= 4) {
+        if (!map_dict(in, &idx->sources) || !map_dict(in, &idx->documents)) {
+            return false;
+        }
+        for (auto& attrs : idx->label_attrs) {
+            if (!in.read(&attrs.source) || !in.read(&attrs.document)) {
+                return false;
+            }
+        }
+    }
+
+    // Every vector of an older mapping is unsourced
+    idx->unsourced_count = 0;
+    for (size_t label = 0; label < idx->ids.size(); label++) {
+        if (!idx->ids.id(label).empty() && unsourced(idx, label)) {
+            idx->unsourced_count++;
+        }
+    }
+    return true;
+}
+
+// Helper: load ID mappings from file (includes precision metadata).
+// Sets *version to the mapping format version.
+static bool load_id_mappings(HnswIndex* idx, uint32_t* version) {
+    MappedFile file;
+    if (!map_file(idx->path + "/id_mapping.bin", &file)) {
+        return false;
+    }
+    bool ok = parse_id_mappings(idx, file, false, version);
+    unmap_file(&file);
+    return ok;
+}
+
+// Helper: map id_mapping.bin and use the ID table in place (read-only open).
+// Sets *version to the mapping format version.
+static bool map_id_mappings(HnswIndex* idx, uint32_t* version) {
+    // A writer may be installing a committed snapshot; its staged files are
+    // used until they have been renamed into place
+    const std::string file = idx->path + "/id_mapping.bin";
+    idx->staged = map_file(file + kStagedSuffix, &idx->mapping_map);
+    if (!idx->staged && !map_file(file, &idx->mapping_map)) {
+        return false;
+    }
+    return parse_id_mappings(idx, idx->mapping_map, true, version);
+}
+
+// Helper: write the graph in HierarchicalNSW::saveIndex's format through a
+// buffered, atomically renamed file. Level-0 data is streamed straight from
+// hnswlib's block. Caller must hold index->mutex (shared).
+static bool save_graph(const HnswIndex* idx, const std::string& file) {
+    const hnswlib::HierarchicalNSW<float>* hnsw = idx->hnsw;
+    SnapshotWriter out;
+    if (!out.open(file)) {
+        return false;
+    }
+    const size_t count = hnsw->cur_element_count;
+    bool ok = out.put(hnsw->offsetLevel0_) && out.put(hnsw->max_elements_) && out.put(count) &&
+              out.put(hnsw->size_data_per_element_) && out.put(hnsw->label_offset_) &&
+              out.put(hnsw->offsetData_) && out.put(hnsw->maxlevel_) &&
+              out.put(hnsw->enterpoint_node_) && out.put(hnsw->maxM_) && out.put(hnsw->maxM0_) &&
+              out.put(hnsw->M_) && out.put(hnsw->mult_) && out.put(hnsw->ef_construction_) &&
+              out.write(hnsw->data_level0_memory_, count * hnsw->size_data_per_element_);
+    for (size_t i = 0; ok && i < count; i++) {
+        unsigned int link_list_size = hnsw->element_levels_[i] > 0
+            ? static_cast<unsigned int>(hnsw->size_links_per_element_ * hnsw->element_levels_[i])
+            : 0;
+        ok = out.put(link_list_size) &&
+             (link_list_size == 0 || out.write(hnsw->linkLists_[i], link_list_size));
+    }
+    return ok && out.commit();
+}
+
+// Helper: read a saveIndex header into hnsw and set the derived fields. Sets
+// *count to the stored element count.
+static bool read_graph_header(const HnswIndex* idx, MappedReader& in,
+                              hnswlib::HierarchicalNSW<float>* hnsw, size_t* count) {
+    bool ok = in.read(&hnsw->offsetLevel0_) && in.read(&hnsw->max_elements_) &&
+              in.read(count) && in.read(&hnsw->size_data_per_element_) &&
+              in.read(&hnsw->label_offset_) && in.read(&hnsw->offsetData_) &&
+              in.read(&hnsw->maxlevel_) && in.read(&hnsw->enterpoint_node_) &&
+              in.read(&hnsw->maxM_) && in.read(&hnsw->maxM0_) && in.read(&hnsw->M_) &&
+              in.read(&hnsw->mult_) && in.read(&hnsw->ef_construction_);
+    // The stored vector size must match this space (catches a dimension or
+    // precision mismatch)
+    if (!ok || hnsw->label_offset_ != hnsw->offsetData_ + idx->space->get_data_size()) {
+        return false;
+    }
+
+    hnsw->data_size_ = idx->space->get_data_size();
+    hnsw->fstdistfunc_ = idx->space->get_dist_func();
+    hnsw->dist_func_param_ = idx->space->get_dist_func_param();
+    hnsw->max_elements_ = std::max(hnsw->max_elements_, *count);
+    hnsw->size_links_per_element_ =
+        hnsw->maxM_ * sizeof(hnswlib::tableint) + sizeof(hnswlib::linklistsizeint);
+    hnsw->size_links_level0_ =
+        hnsw->maxM0_ * sizeof(hnswlib::tableint) + sizeof(hnswlib::linklistsizeint);
+    hnsw->revSize_ = 1.0 / hnsw->mult_;
+    return true;
+}
+
+// Helper: load a graph file written by saveIndex for a writable index, in
+// place of HierarchicalNSW::loadIndex. The file is mapped and read in one
+// sequential pass: level-0 data is copied in a single block and label_lookup_
+// is sized up front, where loadIndex streams it through an ifstream twice.
+static hnswlib::HierarchicalNSW<float>* load_graph(HnswIndex* idx) {
+    MappedFile file;
+    if (!map_file(graph_path(idx), &file)) {
+        return nullptr;
+    }
+    madvise(const_cast<char*>(file.data), file.size, MADV_SEQUENTIAL);
+    MappedReader in{file.data, file.data + file.size};
+
+    std::unique_ptr<hnswlib::HierarchicalNSW<float>> hnsw(
+        new hnswlib::HierarchicalNSW<float>(idx->space));
+    size_t count = 0;
+    const char* level0 = nullptr;
+    bool ok = read_graph_header(idx, in, hnsw.get(), &count) &&
+              (level0 = in.take(count * hnsw->size_data_per_element_)) != nullptr;
+    if (ok) {
+        const size_t max_elements = hnsw->max_elements_;
+        hnsw->data_level0_memory_ =
+            static_cast<char*>(malloc(max_elements * hnsw->size_data_per_element_));
+        hnsw->linkLists_ = static_cast<char**>(calloc(max_elements, sizeof(char*)));
+        ok = hnsw->data_level0_memory_ != nullptr && hnsw->linkLists_ != nullptr;
+    }
+    if (ok) {
+        const size_t max_elements = hnsw->max_elements_;
+        std::memcpy(hnsw->data_level0_memory_, level0, count * hnsw->size_data_per_element_);
+        std::vector<std::mutex>(max_elements).swap(hnsw->link_list_locks_);
+        std::vector<std::mutex>(hnswlib::HierarchicalNSW<float>::MAX_LABEL_OPERATION_LOCKS)
+            .swap(hnsw->label_op_locks_);
+        hnsw->visited_list_pool_.reset(new hnswlib::VisitedListPool(1, max_elements));
+        hnsw->element_levels_.assign(max_elements, 0);
+        hnsw->label_lookup_.reserve(count);
+        hnsw->ef_ = 10;
+    }
+
+    // cur_element_count grows with the copied link lists, so a failure part
+    // way frees exactly what was allocated
+    for (size_t i = 0; ok && i < count; i++) {
+        unsigned int link_list_size;
+        const char* links = nullptr;
+        ok = in.read(&link_list_size) && link_list_size % hnsw->size_links_per_element_ == 0 &&
+             (link_list_size == 0 || (links = in.take(link_list_size)) != nullptr);
+        if (ok && link_list_size != 0) {
+            hnsw->linkLists_[i] = static_cast<char*>(malloc(link_list_size));
+            ok = hnsw->linkLists_[i] != nullptr;
+            if (ok) {
+                std::memcpy(hnsw->linkLists_[i], links, link_list_size);
+                hnsw->element_levels_[i] =
+                    static_cast<int>(link_list_size / hnsw->size_links_per_element_);
+            }
+        }
+        if (ok) {
+            hnsw->cur_element_count = i + 1;
+            hnsw->label_lookup_[hnsw->getExternalLabel(static_cast<hnswlib::tableint>(i))] =
+                static_cast<hnswlib::tableint>(i);
+            if (hnsw->isMarkedDeleted(static_cast<hnswlib::tableint>(i))) {
+                hnsw->num_deleted_ += 1;
+            }
+        }
+    }
+    // Like loadIndex, reject trailing data (a corrupt or foreign file)
+    ok = ok && in.pos == in.end;
+    unmap_file(&file);
+    return ok ? hnsw.release() : nullptr;
+}
+
+// Helper: build a HierarchicalNSW over a mapped graph file written by
+// saveIndex, mirroring HierarchicalNSW::loadIndex. Level-0 data and link
+// lists point into the mapping instead of being copied; label_lookup_ and
+// the per-element locks are left empty since a read-only index never
+// mutates or looks up by label.
+static hnswlib::HierarchicalNSW<float>* map_graph(HnswIndex* idx) {
+    // The staged graph goes with a staged mapping unless it was moved since
+    const std::string file = graph_path(idx);
+    if (!(idx->staged && map_file(file + kStagedSuffix, &idx->graph_map)) &&
+        !map_file(file, &idx->graph_map)) {
+        return nullptr;
+    }
+    MappedReader in{idx->graph_map.data, idx->graph_map.data + idx->graph_map.size};
+
+    auto* hnsw = new hnswlib::HierarchicalNSW<float>(idx->space);
+    size_t cur_element_count = 0;
+    if (!read_graph_header(idx, in, hnsw, &cur_element_count)) {
+        delete hnsw;
+        return nullptr;
+    }
+
+    const char* level0 = in.take(cur_element_count * hnsw->size_data_per_element_);
+    if (level0 == nullptr) {
+        delete hnsw;
+        return nullptr;
+    }
+    hnsw->data_level0_memory_ = const_cast<char*>(level0);
+    hnsw->visited_list_pool_.reset(new hnswlib::VisitedListPool(1, hnsw->max_elements_));
+    hnsw->element_levels_.assign(cur_element_count, 0);
+    hnsw->linkLists_ = static_cast<char**>(calloc(std::max<size_t>(cur_element_count, 1),
+                                                  sizeof(char*)));
+    if (hnsw->linkLists_ == nullptr) {
+        hnsw->data_level0_memory_ = nullptr;
+        delete hnsw;
+        return nullptr;
+    }
+
+    // cur_element_count is set last: until then the destructor frees nothing
+    // that points into the mapping
+    for (size_t i = 0; i < cur_element_count; i++) {
+        unsigned int link_list_size;
+        const char* links = nullptr;
+        if (!in.read(&link_list_size) ||
+            (link_list_size != 0 && (links = in.take(link_list_size)) == nullptr)) {
+            hnsw->data_level0_memory_ = nullptr;
+            delete hnsw;
+            return nullptr;
+        }
+        hnsw->element_levels_[i] = static_cast<int>(link_list_size / hnsw->size_links_per_element_);
+        hnsw->linkLists_[i] = const_cast<char*>(links);
+    }
+    hnsw->cur_element_count = cur_element_count;
+    return hnsw;
+}
+
+// Helper: free a mapped HierarchicalNSW without freeing mapped memory
+static void release_mapped_graph(hnswlib::HierarchicalNSW<float>* hnsw) {
+    if (hnsw == nullptr) {
+        return;
+    }
+    hnsw->data_level0_memory_ = nullptr;
+    hnsw->cur_element_count = 0;  // Skips freeing per-element link lists
+    delete hnsw;
+}
+
+static std::string wal_path(const HnswIndex* idx) {
+    return idx->path + "/wal.log";
+}
+
+// Helper: apply one replayed WAL record (used while opening, so no locking)
+static void apply_wal_record(HnswIndex* idx, const WalRecord& rec) {
+    std::string id(rec.id);
+    if (rec.op == WalOp::Delete) {
+        remove_mapping(idx, id);
+        return;
+    }
+    if (rec.op != WalOp::Add || rec.vector.size() != idx->space->get_data_size()) {
+        return;  // Unknown or malformed record
+    }
+    hnswlib::labeltype label = static_cast<hnswlib::labeltype>(rec.label);
+    ensure_capacity(idx, label + 1);
+    idx->hnsw->addPoint(rec.vector.data(), label);
+    publish_mapping(idx, id, label, rec.source, rec.document);
+    idx->next_label = std::max(idx->next_label, label + 1);
+}
+
+static bool checkpoint(HnswIndex* idx);
+
+// Helper: replay the WAL on top of the loaded snapshot and open it for
+// appending. A log in an older format is folded into a new snapshot right
+// away, since new records cannot be appended to it. Without a usable WAL,
+// later changes are saved by a full checkpoint on close instead.
+static void recover_wal(HnswIndex* idx) {
+    uint64_t end = 0;
+    size_t replayed = 0;
+    bool ok = HnswWal::replay(wal_path(idx), idx->checkpoint_seq, [&](const WalRecord& rec) {
+        apply_wal_record(idx, rec);
+        replayed++;
+    }, &end);
+    if (replayed > 0) {
+        idx->modified = true;
+        if (ok && end == 0) {
+            if (!checkpoint(idx)) {
+                idx->snapshot_required = true;
+            }
+            return;
+        }
+    }
+    if (!ok || !idx->wal.open(wal_path(idx), idx->checkpoint_seq, end)) {
+        idx->snapshot_required = true;
+    }
+}
+
+// Helper: append records to the WAL. On failure the changes are only in
+// memory, so the next close must write a full snapshot.
+// Caller must hold write_mutex.
+static void log_mutations(HnswIndex* idx, const WalRecord* records, size_t count) {
+    if (count > 0 && !idx->wal.append(records, count)) {
+        idx->snapshot_required = true;
+    }
+    idx->unsynced += count;
+    HnswFlusher& flusher = idx->flusher;
+    if (flusher.active.load(std::memory_order_relaxed) &&
+        idx->unsynced >= static_cast<uint64_t>(flusher.max_unsynced.load())) {
+        std::lock_guard<std::mutex> lock(flusher.mutex);
+        flusher.requested = true;
+        flusher.wake.notify_one();
+    }
+}
+
+// Helper: write a full snapshot as the next generation and start an empty
+// WAL for it. Searches may continue meanwhile. The graph and mapping are
+// staged next to the live files, and the staged mapping commits the new
+// generation; both are then renamed into place. A crash before the commit
+// leaves the previous snapshot and its WAL intact, and one after it is rolled
+// forward on open, where the old WAL no longer matches the generation. The
+// graph and mapping therefore always come from the same snapshot, which a
+// compaction (it renumbers labels) relies on. Caller must hold write_mutex.
+static bool checkpoint(HnswIndex* idx) {
+    const uint64_t seq = idx->checkpoint_seq + 1;
+    const std::string graph = graph_path(idx);
+    const std::string mapping = idx->path + "/id_mapping.bin";
+    // A snapshot committed by an earlier failed checkpoint goes in first
+    if (!install_staged_snapshot(idx->path)) {
+        return false;
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(idx->mutex);
+        // Save the graph (vectors in storage precision plus links), then the
+        // ID mappings that mark it as the current format
+        if (!save_graph(idx, graph + kStagedSuffix) ||
+            !save_id_mappings(idx, seq, mapping + kStagedSuffix)) {
+            std::error_code ec;
+            std::filesystem::remove(graph + kStagedSuffix, ec);
+            return false;
+        }
+    }
+    idx->checkpoint_seq = seq;
+    if (!install_staged_snapshot(idx->path)) {
+        // Committed but not installed: the next checkpoint or open finishes
+        // it, and the WAL must not be reused meanwhile
+        idx->modified = false;
+        idx->unsynced = 0;
+        idx->wal.close();
+        idx->snapshot_required = true;
+        return false;
+    }
+    idx->modified = false;
+    idx->unsynced = 0;  // The snapshot files are synced as they are written
+    idx->snapshot_required = !idx->wal.open(wal_path(idx), seq, 0);
+
+    if (idx->precision != HNSW_PRECISION_FLOAT32) {
+        // The legacy vectors-only file is superseded by the graph
+        std::error_code ec;
+        std::filesystem::remove(idx->path + (idx->precision == HNSW_PRECISION_FLOAT16
+                                             ? "/vectors.f16" : "/vectors.i8"), ec);
+    }
+    return true;
+}
+
+// Helper: whether close should fold the WAL into a new snapshot. Replay cost
+// grows with the log, so it is checkpointed once it reaches half the size of
+// the snapshot it applies to.
+static bool checkpoint_due(const HnswIndex* idx) {
+    if (!idx->modified) {
+        return false;
+    }
+    if (idx->snapshot_required) {
+        return true;
+    }
+    std::error_code ec;
+    uintmax_t snapshot = std::filesystem::file_size(graph_path(idx), ec);
+    if (ec) {
+        return true;
+    }
+    return idx->wal.size() * 2 >= snapshot;
+}
+
+// Helper: make every logged change durable. Changes the WAL could not hold
+// are only in memory, so they are checkpointed instead.
+// Caller must hold write_mutex.
+static bool flush_changes(HnswIndex* idx) {
+    if (idx->snapshot_required) {
+        return !idx->modified || checkpoint(idx);
+    }
+    if (idx->unsynced > 0) {
+        if (!idx->wal.sync()) {
+            return false;
+        }
+        idx->unsynced = 0;
+    }
+    return true;
+}
+
+// Helper: one background maintenance round: fold the log into a snapshot
+// once it reaches max_log_bytes (by default when close would), otherwise
+// sync it. Caller must hold write_mutex.
+static bool maintain(HnswIndex* idx) {
+    int64_t max_log_bytes = idx->flusher.max_log_bytes.load();
+    bool due = max_log_bytes > 0
+        ? idx->modified && idx->wal.size() >= static_cast<uint64_t>(max_log_bytes)
+        : checkpoint_due(idx);
+    if (due) {
+        return checkpoint(idx);
+    }
+    return flush_changes(idx);
+}
+
+// Body of the maintenance thread. A failed round leaves its work pending for
+// the next one (or hnsw_flush).
+static void flush_loop(HnswIndex* idx) {
+    HnswFlusher& flusher = idx->flusher;
+    std::unique_lock<std::mutex> lock(flusher.mutex);
+    while (!flusher.stop) {
+        auto interval = std::chrono::milliseconds(flusher.interval_ms.load());
+        flusher.wake.wait_for(lock, interval, [&] { return flusher.stop || flusher.requested; });
+        flusher.requested = false;
+        lock.unlock();
+        try {
+            std::lock_guard<std::mutex> write_lock(idx->write_mutex);
+            maintain(idx);
+        } catch (...) {
+            // Retried next round
+        }
+        lock.lock();
+    }
+}
+
+// Helper: stop the maintenance thread, if running.
+// Caller must hold flusher.control_mutex but not write_mutex.
+static void stop_flusher(HnswIndex* idx) {
+    HnswFlusher& flusher = idx->flusher;
+    flusher.active.store(false);
+    if (flusher.thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(flusher.mutex);
+            flusher.stop = true;
+            flusher.wake.notify_one();
+        }
+        flusher.thread.join();
+        flusher.stop = false;
+        flusher.requested = false;
+    }
+}
+
+// Helper: approximate heap size of a graph: the preallocated level-0 block
+// plus the upper-layer link lists.
+static size_t graph_bytes(const hnswlib::HierarchicalNSW<float>* hnsw) {
+    size_t bytes = hnsw->max_elements_ * hnsw->size_data_per_element_;
+    for (size_t i = 0; i < hnsw->cur_element_count; i++) {
+        bytes += static_cast<size_t>(hnsw->element_levels_[i]) * hnsw->size_links_per_element_;
+    }
+    return bytes;
+}
+
+// Helper: pack the chunk IDs of labels into the caller's arena. Sets
+// *ids_size to the bytes needed and returns false if they do not fit.
+// Caller must hold index->mutex (shared).
+template <typename LabelAt>
+static bool pack_ids(const HnswIndex* index, size_t count, LabelAt label_at,
+                     uint32_t* id_offsets, char* ids, size_t ids_capacity, size_t* ids_size) {
+    size_t needed = 0;
+    for (size_t i = 0; i < count; i++) {
+        needed += chunk_id_of(index, label_at(i)).size();
+    }
+    *ids_size = needed;
+    if (needed > ids_capacity || needed > UINT32_MAX) {
+        return false;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+        std::string_view chunk_id = chunk_id_of(index, label_at(i));
+        id_offsets[i] = static_cast<uint32_t>(pos);
+        if (!chunk_id.empty()) {
+            std::memcpy(ids + pos, chunk_id.data(), chunk_id.size());
+        }
+        pos += chunk_id.size();
+    }
+    id_offsets[count] = static_cast<uint32_t>(pos);
+    return true;
+}
+
+extern "C" {
+
+HnswIndex* hnsw_create(const char* path, int dimension, int max_elements, HnswPrecision precision) {
+    return hnsw_create_ex(path, dimension, max_elements, precision, nullptr);
+}
+
+HnswIndex* hnsw_create_ex(const char* path, int dimension, int max_elements,
+                          HnswPrecision precision, const HnswBuildParams* params) {
+    if (path == nullptr || dimension <= 0 || max_elements <= 0 || !valid_precision(precision)) {
+        return nullptr;
+    }
+
+    const size_t M = params != nullptr && params->M > 0 ? static_cast<size_t>(params->M)
+                                                        : kDefaultM;
+    const size_t ef_construction = params != nullptr && params->ef_construction > 0
+        ? static_cast<size_t>(params->ef_construction) : kDefaultEfConstruction;
+    const size_t ef_search = params != nullptr && params->ef_search > 0
+        ? static_cast<size_t>(params->ef_search) : kDefaultEfSearch;
+
+    try {
+        // Never replace an index that exists but could not be opened
+        if (index_files_exist(path)) {
+            return nullptr;
+        }
+        // Create directory if it doesn't exist
+        std::filesystem::create_directories(path);
+
+        HnswIndex* idx = new HnswIndex();
+        idx->path = path;
+        idx->dimension = dimension;
+        idx->max_elements = static_cast<size_t>(max_elements);
+        idx->next_label = 0;
+        idx->modified = false;
+        idx->precision = precision;
+        idx->rerank_factor = precision == HNSW_PRECISION_INT8 ? kDefaultInt8RerankFactor : 0;
+
+        // Inner product space (cosine similarity on normalized vectors) in
+        // the storage precision
+        idx->space = make_space(precision, dimension);
+
+        idx->hnsw = new hnswlib::HierarchicalNSW<float>(
+            idx->space,
+            idx->max_elements,
+            M,               // number of connections per element
+            ef_construction  // controls index quality
+        );
+
+        // Set ef for search (controls recall vs speed)
+        idx->hnsw->setEf(ef_search);
+
+        // Nothing is written yet: the first checkpoint or close writes the
+        // base snapshot, and the WAL is opened against it
+        idx->checkpoint_seq = 0;
+        idx->modified = true;
+        idx->snapshot_required = true;
+
+        return idx;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+HnswIndex* hnsw_open(const char* path, int dimension) {
+    if (path == nullptr || dimension <= 0) {
+        return nullptr;
+    }
+
+    std::string mapping_path = std::string(path) + "/id_mapping.bin";
+
+    try {
+        // Finish a checkpoint that committed before a crash
+        if (!install_staged_snapshot(path)) {
+            return nullptr;
+        }
+
+        // Check if mapping file exists (needed to determine precision)
+        if (!std::filesystem::exists(mapping_path)) {
+            return nullptr;
+        }
+
+        HnswIndex* idx = new HnswIndex();
+        idx->path = path;
+        idx->dimension = dimension;
+        idx->next_label = 0;
+        idx->modified = false;
+        idx->precision = HNSW_PRECISION_FLOAT32;  // Default, will be overwritten
+
+        // Load ID mappings first (this sets idx->precision from stored value)
+        uint32_t version = 0;
+        if (!load_id_mappings(idx, &version)) {
+            delete idx;
+            return nullptr;
+        }
+        idx->rerank_factor =
+            idx->precision == HNSW_PRECISION_INT8 ? kDefaultInt8RerankFactor : 0;
+
+        // Inner product space in the stored precision
+        idx->space = make_space(idx->precision, dimension);
+
+        // Load the persisted graph directly; only version 1 compressed
+        // indexes (vectors without links) need the graph rebuilt
+        if (idx->precision == HNSW_PRECISION_FLOAT32 || version >= 2) {
+            idx->hnsw = load_graph(idx);
+            if (idx->hnsw == nullptr) {
+                delete idx->space;
+                delete idx;
+                return nullptr;
+            }
+            idx->max_elements = idx->hnsw->max_elements_;
+        } else {
+            // For legacy compressed storage, create empty HNSW and insert the
+            // stored vectors as-is
+            size_t max_elements = idx->ids.size();
+            if (max_elements == 0) max_elements = 100000;  // Default
+            idx->max_elements = max_elements;
+
+            idx->hnsw = new hnswlib::HierarchicalNSW<float>(
+                idx->space, idx->max_elements, kDefaultM, kDefaultEfConstruction);
+
+            // Load compressed vectors and add to HNSW
+            if (!load_compressed_vectors(idx)) {
+                delete idx->hnsw;
+                delete idx->space;
+                delete idx;
+                return nullptr;
+            }
+
+            // Rewrite in the current format on close so the rebuild happens once
+            idx->modified = true;
+            idx->snapshot_required = true;
+        }
+
+        // Apply changes logged since the snapshot
+        recover_wal(idx);
+        rebuild_free_labels(idx);
+
+        // Set ef for search
+        idx->hnsw->setEf(kDefaultEfSearch);
+
+        return idx;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+HnswIndex* hnsw_open_readonly(const char* path, int dimension) {
+    if (path == nullptr || dimension <= 0) {
+        return nullptr;
+    }
+
+    HnswIndex* idx = nullptr;
+    try {
+        idx = new HnswIndex();
+        idx->path = path;
+        idx->dimension = dimension;
+        idx->next_label = 0;
+        idx->modified = false;
+        idx->readonly = true;
+
+        // Version 1 compressed indexes have no persisted graph to map
+        uint32_t version = 0;
+        if (!map_id_mappings(idx, &version) ||
+            (idx->precision != HNSW_PRECISION_FLOAT32 && version < 2)) {
+            throw std::runtime_error("unsupported index layout");
+        }
+
+        // Logged changes would have to be applied to the mapped graph
+        if (HnswWal::has_records(wal_path(idx), idx->checkpoint_seq)) {
+            throw std::runtime_error("index has uncheckpointed changes");
+        }
+        idx->rerank_factor =
+            idx->precision == HNSW_PRECISION_INT8 ? kDefaultInt8RerankFactor : 0;
+        idx->space = make_space(idx->precision, dimension);
+
+        idx->hnsw = map_graph(idx);
+        if (idx->hnsw == nullptr) {
+            throw std::runtime_error("invalid graph file");
+        }
+        idx->max_elements = idx->hnsw->max_elements_;
+        idx->hnsw->setEf(kDefaultEfSearch);
+
+        return idx;
+    } catch (...) {
+        if (idx != nullptr) {
+            delete idx->space;
+            unmap_file(&idx->graph_map);
+            unmap_file(&idx->mapping_map);
+            delete idx;
+        }
+        return nullptr;
+    }
+}
+
+int hnsw_add(HnswIndex* index, const char* chunk_id, const float* vector, int dimension) {
+    return hnsw_add_ex(index, chunk_id, vector, dimension, nullptr);
+}
+
+int hnsw_add_ex(HnswIndex* index, const char* chunk_id, const float* vector, int dimension,
+                const HnswAttributes* attrs) {
+    if (index == nullptr || chunk_id == nullptr || vector == nullptr || index->readonly) {
+        return -1;
+    }
+
+    if (dimension != index->dimension) {
+        return -1;
+    }
+
+    auto write_lock = writer_lock(index);
+
+    bool pending = false;  // label was allocated but is not yet published
+    hnswlib::labeltype label = 0;
+    try {
+        std::string id(chunk_id);
+        std::string_view source = attrs != nullptr && attrs->source_id != nullptr
+            ? std::string_view(attrs->source_id) : std::string_view();
+        std::string_view document = attrs != nullptr && attrs->document_id != nullptr
+            ? std::string_view(attrs->document_id) : std::string_view();
+
+        // Normalize and encode for storage (outside the index lock)
+        std::vector<float> normalized(vector, vector + dimension);
+        normalize_vector(normalized.data(), dimension);
+        std::vector<char> encoded(index->space->get_data_size());
+        encode_vector(index, normalized.data(), encoded.data());
+
+        // Assign a new label (an update gets a new label; the old one is retired)
+        label = allocate_label(index);
+        pending = true;
+
+        auto lock = exclusive_lock(index);
+
+        ensure_capacity(index, index->next_label);
+        index->hnsw->addPoint(encoded.data(), label);
+
+        // Swap old and new entries in one step so searches see exactly one
+        pending = false;
+        publish_mapping(index, id, label, source, document);
+        index->modified = true;
+        lock.unlock();
+
+        WalRecord rec{WalOp::Add, label, id, std::string_view(encoded.data(), encoded.size()),
+                      source, document};
+        log_mutations(index, &rec, 1);
+
+        return 0;
+    } catch (...) {
+        if (pending) {
+            try {
+                auto lock = exclusive_lock(index);
+                release_label(index, label);
+            } catch (...) {
+            }
+        }
+        return -1;
+    }
+}
+
+int hnsw_add_batch(HnswIndex* index, const char** ids, const float* vectors, int n,
+                   int dimension, int num_threads) {
+    return hnsw_add_batch_ex(index, ids, vectors, n, dimension, num_threads, nullptr);
+}
+
+int hnsw_add_batch_ex(HnswIndex* index, const char** ids, const float* vectors, int n,
+                      int dimension, int num_threads, const HnswAttributes* attrs) {
+    if (index == nullptr || ids == nullptr || vectors == nullptr || n < 0 || index->readonly) {
+        return -1;
+    }
+
+    if (dimension != index->dimension) {
+        return -1;
+    }
+
+    if (n == 0) {
+        return 0;
+    }
+
+    auto write_lock = writer_lock(index);
+
+    // labels[settled:] were allocated but are not yet published or released
+    std::vector<hnswlib::labeltype> labels;
+    size_t settled = 0;
+    try {
+        // Resolve duplicates within the batch (last occurrence wins)
+        std::unordered_map<std::string, size_t> last_row;
+        last_row.reserve(static_cast<size_t>(n));
+        for (int i = 0; i < n; i++) {
+            if (ids[i] == nullptr) {
+                return -1;
+            }
+            last_row[ids[i]] = static_cast<size_t>(i);
+        }
+
+        std::vector<size_t> rows;
+        rows.reserve(last_row.size());
+        for (int i = 0; i < n; i++) {
+            if (last_row[ids[i]] == static_cast<size_t>(i)) {
+                rows.push_back(static_cast<size_t>(i));
+            }
+        }
+
+        // Normalize and encode into one contiguous buffer (outside the index
+        // lock), a block of rows at a time so each block encodes in bulk
+        const size_t dim = static_cast<size_t>(dimension);
+        const size_t record = index->space->get_data_size();
+        const size_t blocks = (rows.size() + kEncodeBlockRows - 1) / kEncodeBlockRows;
+        std::vector<char> encoded(rows.size() * record);
+        WorkerPool pool(num_threads, rows.size());
+        pool.run(blocks, [&](size_t b) {
+            thread_local std::vector<float> scratch;
+            const size_t first = b * kEncodeBlockRows;
+            const size_t count = std::min(kEncodeBlockRows, rows.size() - first);
+            scratch.resize(count * dim);
+            for (size_t r = 0; r < count; r++) {
+                hnsw_kernels().normalize(vectors + rows[first + r] * dim, scratch.data() + r * dim,
+                                         dim);
+            }
+            encode_vectors(index, scratch.data(), count, encoded.data() + first * record);
+        });
+
+        // Assign labels (reusing tombstones first) and resize once for the
+        // whole batch
+        labels.resize(rows.size());
+        for (auto& label : labels) {
+            label = allocate_label(index);
+        }
+        {
+            auto lock = exclusive_lock(index);
+            ensure_capacity(index, index->next_label);
+        }
+        index->modified = true;
+
+        // Insert slice by slice from the worker pool (addPoint is thread-safe
+        // for distinct labels), publishing each slice's mappings before
+        // releasing the lock. Labels of rows that were not inserted go back
+        // to the free list.
+        std::vector<char> inserted(rows.size(), 0);
+        for (size_t begin = 0; begin < rows.size(); begin += kBatchSliceSize) {
+            size_t end = std::min(rows.size(), begin + kBatchSliceSize);
+
+            std::unique_lock<std::shared_mutex> lock(index->mutex);
+            bool ok = pool.run(end - begin, [&](size_t i) {
+                size_t r = begin + i;
+                index->hnsw->addPoint(encoded.data() + r * record, labels[r]);
+                inserted[r] = 1;
+            });
+
+            std::vector<WalRecord> logged;
+            logged.reserve(end - begin);
+            for (size_t r = begin; r < end; r++) {
+                settled = r + 1;
+                if (!inserted[r]) {
+                    release_label(index, labels[r]);
+                } else {
+                    const HnswAttributes* a = attrs != nullptr ? &attrs[rows[r]] : nullptr;
+                    std::string_view source = a != nullptr && a->source_id != nullptr
+                        ? std::string_view(a->source_id) : std::string_view();
+                    std::string_view document = a != nullptr && a->document_id != nullptr
+                        ? std::string_view(a->document_id) : std::string_view();
+                    publish_mapping(index, ids[rows[r]], labels[r], source, document);
+                    logged.push_back({WalOp::Add, labels[r], ids[rows[r]],
+                                      std::string_view(encoded.data() + r * record, record),
+                                      source, document});
+                }
+            }
+            if (!ok) {
+                for (; settled < labels.size(); settled++) {
+                    release_label(index, labels[settled]);
+                }
+            }
+            lock.unlock();
+
+            log_mutations(index, logged.data(), logged.size());
+
+            if (!ok) {
+                return -1;
+            }
+        }
+
+        return 0;
+    } catch (...) {
+        try {
+            auto lock = exclusive_lock(index);
+            for (; settled < labels.size(); settled++) {
+                release_label(index, labels[settled]);
+            }
+        } catch (...) {
+        }
+        return -1;
+    }
+}
+
+int hnsw_delete(HnswIndex* index, const char* chunk_id) {
+    if (index == nullptr || chunk_id == nullptr || index->readonly) {
+        return -1;
+    }
+
+    auto write_lock = writer_lock(index);
+
+    try {
+        std::string id(chunk_id);
+        if (!index->ids.contains(id)) {
+            // ID not found - not an error, just no-op
+            return 0;
+        }
+
+        {
+            auto lock = exclusive_lock(index);
+            remove_mapping(index, id);
+            index->modified = true;
+        }
+
+        WalRecord rec{WalOp::Delete, 0, id, {}, {}, {}};
+        log_mutations(index, &rec, 1);
+
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
 
-    return out.good();
+int hnsw_search(HnswIndex* index, const float* query, int dimension, int k,
+                HnswSearchResult** results) {
+    return hnsw_search_ex(index, query, dimension, k, nullptr, results);
 }
 
-// Helper: load compressed vectors and reconstruct HNSW index
-static bool load_compressed_vectors(HnswIndex* idx) {
-    std::string vec_path;
-    if (idx->precision == HNSW_PRECISION_FLOAT16) {
-        vec_path = idx->path + "/vectors.f16";
-    } else if (idx->precision == HNSW_PRECISION_INT8) {
-        vec_path = idx->path + "/vectors.i8";
-    } else {
-        return true;  // Float32 doesn't use separate vector file
+int hnsw_search_ex(HnswIndex* index, const float* query, int dimension, int k,
+                   const HnswSearchOptions* options, HnswSearchResult** results) {
+    if (index == nullptr || query == nullptr || results == nullptr || k <= 0) {
+        return -1;
     }
 
-    if (!std::filesystem::exists(vec_path)) {
-        return false;
+    if (dimension != index->dimension) {
+        return -1;
     }
 
-    std::ifstream in(vec_path, std::ios::binary);
-    if (!in.is_open()) {
-        return false;
-    }
+    try {
+        // Normalize query vector
+        std::vector<float> normalized(query, query + dimension);
+        normalize_vector(normalized.data(), dimension);
 
-    // Read header
-    uint32_t num_vectors, dimensions;
-    in.read(reinterpret_cast<char*>(&num_vectors), sizeof(num_vectors));
-    in.read(reinterpret_cast<char*>(&dimensions), sizeof(dimensions));
+        // Searches share the lock and run concurrently with each other
+        auto lock = read_lock(index);
 
-    if (static_cast<int>(dimensions) != idx->dimension) {
-        return false;
-    }
+        std::vector<std::pair<float, hnswlib::labeltype>> valid_results;
+        search_live(index, normalized.data(), static_cast<size_t>(k), options, &valid_results);
 
-    // Read and add each vector
-    for (uint32_t label = 0; label < num_vectors; label++) {
-        std::vector<float> vec(idx->dimension);
+        if (valid_results.empty()) {
+            *results = nullptr;
+            return 0;
+        }
 
-        if (idx->precision == HNSW_PRECISION_FLOAT16) {
-            std::vector<uint16_t> compressed(idx->dimension);
-            in.read(reinterpret_cast<char*>(compressed.data()),
-                   idx->dimension * sizeof(uint16_t));
-            for (int i = 0; i < idx->dimension; i++) {
-                vec[i] = half_to_float(compressed[i]);
-            }
-        } else {  // INT8
-            float scale;
-            in.read(reinterpret_cast<char*>(&scale), sizeof(scale));
-            std::vector<int8_t> compressed(idx->dimension);
-            in.read(reinterpret_cast<char*>(compressed.data()), idx->dimension);
-            dequantize_vector_int8(compressed.data(), vec.data(), idx->dimension, scale);
+        // Allocate results array
+        int count = static_cast<int>(valid_results.size());
+        *results = static_cast<HnswSearchResult*>(malloc(sizeof(HnswSearchResult) * count));
+        if (*results == nullptr) {
+            return -1;
         }
 
-        // Only add if this label has a valid ID
-        if (label < idx->label_to_id.size() && !idx->label_to_id[label].empty()) {
-            try {
-                idx->hnsw->addPoint(vec.data(), label);
-            } catch (...) {
-                // Ignore errors for individual vectors
-            }
+        for (int i = 0; i < count; i++) {
+            auto& item = valid_results[i];
+            std::string_view chunk_id = chunk_id_of(index, item.second);
+
+            (*results)[i].chunk_id = strndup(chunk_id.data(), chunk_id.size());
+            // Inner product similarity is already in [0,1] for normalized vectors
+            (*results)[i].similarity = 1.0f - item.first;  // Convert distance to similarity
         }
-    }
 
-    return in.good();
+        return count;
+    } catch (...) {
+        return -1;
+    }
 }
 
-// Helper: load ID mappings from file (includes precision metadata)
-static bool load_id_mappings(HnswIndex* idx) {
-    std::string mapping_path = idx->path + "/id_mapping.bin";
-    std::ifstream in(mapping_path, std::ios::binary);
-    if (!in.is_open()) {
-        return false;
+int hnsw_search_visit(HnswIndex* index, const float* query, int dimension, int k,
+                      const HnswSearchOptions* options, hnsw_hit_visitor visit, void* ctx) {
+    if (index == nullptr || query == nullptr || visit == nullptr || k <= 0 ||
+        dimension != index->dimension) {
+        return -1;
     }
 
-    // Read precision (new field)
-    int32_t prec;
-    in.read(reinterpret_cast<char*>(&prec), sizeof(prec));
-    idx->precision = static_cast<HnswPrecision>(prec);
-
-    // Read number of mappings
-    size_t count;
-    in.read(reinterpret_cast<char*>(&count), sizeof(count));
-
-    // Read next_label
-    in.read(reinterpret_cast<char*>(&idx->next_label), sizeof(idx->next_label));
+    try {
+        thread_local std::vector<float> normalized;
+        normalized.assign(query, query + dimension);
+        normalize_vector(normalized.data(), dimension);
 
-    // Read each mapping
-    idx->label_to_id.resize(count);
-    idx->id_to_label.clear();
-    for (size_t i = 0; i < count; i++) {
-        hnswlib::labeltype label;
-        size_t len;
-        in.read(reinterpret_cast<char*>(&label), sizeof(label));
-        in.read(reinterpret_cast<char*>(&len), sizeof(len));
+        auto lock = read_lock(index);
 
-        std::string id(len, '\0');
-        in.read(&id[0], len);
+        thread_local std::vector<std::pair<float, hnswlib::labeltype>> hits;
+        search_live(index, normalized.data(), static_cast<size_t>(k), options, &hits);
 
-        if (label < idx->label_to_id.size()) {
-            idx->label_to_id[label] = id;
-            if (!id.empty()) {
-                idx->id_to_label[id] = label;
-            }
+        // Ids are handed out straight from the index, which the shared lock
+        // keeps stable for the duration of each call
+        for (const auto& hit : hits) {
+            std::string_view chunk_id = chunk_id_of(index, hit.second);
+            visit(ctx, chunk_id.data(), chunk_id.size(), 1.0f - hit.first);
         }
-    }
 
-    return in.good();
+        return static_cast<int>(hits.size());
+    } catch (...) {
+        return -1;
+    }
 }
 
-extern "C" {
-
-HnswIndex* hnsw_create(const char* path, int dimension, int max_elements, HnswPrecision precision) {
-    if (path == nullptr || dimension <= 0 || max_elements <= 0) {
-        return nullptr;
+int hnsw_search_into(HnswIndex* index, const float* query, int dimension, int k,
+                     const HnswSearchOptions* options, HnswResultBuffer* buf) {
+    if (index == nullptr || query == nullptr || buf == nullptr || k <= 0 ||
+        k > buf->capacity || buf->similarities == nullptr ||
+        dimension != index->dimension ||
+        (buf->ids != nullptr && buf->id_offsets == nullptr) ||
+        (buf->ids == nullptr && buf->labels == nullptr)) {
+        return -1;
     }
 
     try {
-        // Create directory if it doesn't exist
-        std::filesystem::create_directories(path);
+        // Scratch is reused by every search on this thread
+        thread_local std::vector<float> normalized;
+        normalized.assign(query, query + dimension);
+        normalize_vector(normalized.data(), dimension);
 
-        HnswIndex* idx = new HnswIndex();
-        idx->path = path;
-        idx->dimension = dimension;
-        idx->max_elements = static_cast<size_t>(max_elements);
-        idx->next_label = 0;
-        idx->modified = false;
-        idx->precision = precision;
+        auto lock = read_lock(index);
 
-        // Use inner product space (cosine similarity on normalized vectors)
-        idx->space = new hnswlib::InnerProductSpace(dimension);
+        thread_local std::vector<std::pair<float, hnswlib::labeltype>> hits;
+        search_live(index, normalized.data(), static_cast<size_t>(k), options, &hits);
 
-        // HNSW parameters: M=16, ef_construction=200
-        idx->hnsw = new hnswlib::HierarchicalNSW<float>(
-            idx->space,
-            idx->max_elements,
-            16,   // M - number of connections per element
-            200   // ef_construction - controls index quality
-        );
+        buf->ids_size = 0;
+        buf->label_generation = index->label_generation;
+        if (buf->ids != nullptr &&
+            !pack_ids(index, hits.size(), [&](size_t i) { return hits[i].second; },
+                      buf->id_offsets, buf->ids, buf->ids_capacity, &buf->ids_size)) {
+            return HNSW_ERR_BUFFER_TOO_SMALL;
+        }
+        for (size_t i = 0; i < hits.size(); i++) {
+            buf->similarities[i] = 1.0f - hits[i].first;
+            if (buf->labels != nullptr) {
+                buf->labels[i] = hits[i].second;
+            }
+        }
 
-        // Set ef for search (controls recall vs speed)
-        idx->hnsw->setEf(50);
+        return static_cast<int>(hits.size());
+    } catch (...) {
+        return -1;
+    }
+}
 
-        return idx;
+int hnsw_resolve_labels(HnswIndex* index, const uint64_t* labels, int count,
+                        uint64_t label_generation, uint32_t* id_offsets, char* ids,
+                        size_t ids_capacity, size_t* ids_size) {
+    if (index == nullptr || count < 0 || (count > 0 && labels == nullptr) ||
+        id_offsets == nullptr || ids_size == nullptr || (ids == nullptr && ids_capacity > 0)) {
+        return -1;
+    }
+
+    try {
+        auto lock = read_lock(index);
+
+        if (label_generation != index->label_generation) {
+            return HNSW_ERR_STALE_LABELS;
+        }
+        if (!pack_ids(index, static_cast<size_t>(count),
+                      [&](size_t i) { return static_cast<hnswlib::labeltype>(labels[i]); },
+                      id_offsets, ids, ids_capacity, ids_size)) {
+            return HNSW_ERR_BUFFER_TOO_SMALL;
+        }
+        return 0;
     } catch (...) {
-        return nullptr;
+        return -1;
     }
 }
 
-HnswIndex* hnsw_open(const char* path, int dimension) {
-    if (path == nullptr || dimension <= 0) {
-        return nullptr;
+void hnsw_free_results(HnswSearchResult* results, int count) {
+    if (results != nullptr) {
+        for (int i = 0; i < count; i++) {
+            free(results[i].chunk_id);
+        }
+        free(results);
     }
+}
 
-    std::string index_path = std::string(path) + "/index.bin";
-    std::string mapping_path = std::string(path) + "/id_mapping.bin";
+int hnsw_search_batch(HnswIndex* index, const float* queries, int num_queries, int dimension,
+                      int k, int num_threads, HnswBatchResults* results) {
+    if (index == nullptr || queries == nullptr || results == nullptr ||
+        num_queries < 0 || k <= 0) {
+        return -1;
+    }
 
-    // Check if mapping file exists (needed to determine precision)
-    if (!std::filesystem::exists(mapping_path)) {
-        return nullptr;
+    if (dimension != index->dimension) {
+        return -1;
     }
 
+    *results = HnswBatchResults{num_queries, nullptr, nullptr, nullptr};
+
     try {
-        HnswIndex* idx = new HnswIndex();
-        idx->path = path;
-        idx->dimension = dimension;
-        idx->next_label = 0;
-        idx->modified = false;
-        idx->precision = HNSW_PRECISION_FLOAT32;  // Default, will be overwritten
+        const size_t nq = static_cast<size_t>(num_queries);
+        const size_t dim = static_cast<size_t>(dimension);
 
-        // Use inner product space
-        idx->space = new hnswlib::InnerProductSpace(dimension);
+        // Normalize all queries into one contiguous buffer
+        std::vector<float> normalized(nq * dim);
+        hnsw_normalize_batch(queries, normalized.data(), nq, dim);
 
-        // Load ID mappings first (this sets idx->precision from stored value)
-        if (!load_id_mappings(idx)) {
-            delete idx->space;
-            delete idx;
-            return nullptr;
+        auto lock = read_lock(index);
+
+        std::vector<std::vector<std::pair<float, hnswlib::labeltype>>> hits(nq);
+        bool ok = parallel_for(nq, num_threads, [&](size_t q) {
+            search_live(index, normalized.data() + q * dim, static_cast<size_t>(k), nullptr,
+                        &hits[q]);
+        });
+        if (!ok) {
+            return -1;
         }
 
-        // For float32, load the full index directly
-        if (idx->precision == HNSW_PRECISION_FLOAT32) {
-            if (!std::filesystem::exists(index_path)) {
-                delete idx->space;
-                delete idx;
-                return nullptr;
+        // Size the single allocation: offsets, id pointers, similarities, id arena
+        size_t total = 0;
+        size_t arena_size = 0;
+        for (const auto& list : hits) {
+            total += list.size();
+            for (const auto& item : list) {
+                arena_size += chunk_id_of(index, item.second).size() + 1;
             }
-            idx->hnsw = new hnswlib::HierarchicalNSW<float>(idx->space, index_path);
-            idx->max_elements = idx->hnsw->max_elements_;
-        } else {
-            // For compressed storage, create empty HNSW and load vectors
-            size_t max_elements = idx->label_to_id.size();
-            if (max_elements == 0) max_elements = 100000;  // Default
-            idx->max_elements = max_elements;
+        }
 
-            idx->hnsw = new hnswlib::HierarchicalNSW<float>(
-                idx->space, idx->max_elements, 16, 200);
+        const size_t offsets_size = (nq + 1) * sizeof(int);
+        const size_t ids_at = (offsets_size + alignof(const char*) - 1) &
+                              ~(alignof(const char*) - 1);
+        const size_t sims_at = ids_at + total * sizeof(const char*);
+        const size_t arena_at = sims_at + total * sizeof(float);
+        char* block = static_cast<char*>(malloc(arena_at + arena_size));
+        if (block == nullptr) {
+            return -1;
+        }
 
-            // Load compressed vectors and add to HNSW
-            if (!load_compressed_vectors(idx)) {
-                delete idx->hnsw;
-                delete idx->space;
-                delete idx;
-                return nullptr;
+        int* offsets = reinterpret_cast<int*>(block);
+        const char** chunk_ids = reinterpret_cast<const char**>(block + ids_at);
+        float* similarities = reinterpret_cast<float*>(block + sims_at);
+        char* arena = block + arena_at;
+
+        size_t pos = 0;
+        for (size_t q = 0; q < nq; q++) {
+            offsets[q] = static_cast<int>(pos);
+            for (const auto& item : hits[q]) {
+                std::string_view chunk_id = chunk_id_of(index, item.second);
+                std::memcpy(arena, chunk_id.data(), chunk_id.size());
+                arena[chunk_id.size()] = '\0';
+                chunk_ids[pos] = arena;
+                similarities[pos] = 1.0f - item.first;
+                arena += chunk_id.size() + 1;
+                pos++;
             }
         }
+        offsets[nq] = static_cast<int>(pos);
 
-        // Set ef for search
-        idx->hnsw->setEf(50);
-
-        return idx;
+        results->offsets = offsets;
+        results->chunk_ids = chunk_ids;
+        results->similarities = similarities;
+        return 0;
     } catch (...) {
-        return nullptr;
+        return -1;
     }
 }
 
-int hnsw_add(HnswIndex* index, const char* chunk_id, const float* vector, int dimension) {
-    if (index == nullptr || chunk_id == nullptr || vector == nullptr) {
+void hnsw_free_batch_results(HnswBatchResults* results) {
+    if (results != nullptr) {
+        // offsets is the start of the single allocation
+        free(results->offsets);
+        *results = HnswBatchResults{0, nullptr, nullptr, nullptr};
+    }
+}
+
+int hnsw_set_ef(HnswIndex* index, int ef) {
+    if (index == nullptr || ef <= 0) {
         return -1;
     }
 
-    if (dimension != index->dimension) {
+    std::unique_lock<std::shared_mutex> lock(index->mutex);
+    index->hnsw->setEf(static_cast<size_t>(ef));
+    return 0;
+}
+
+int hnsw_compact(HnswIndex* index, int num_threads, int64_t* reclaimed_bytes) {
+    if (index == nullptr || index->readonly) {
         return -1;
     }
 
-    std::lock_guard<std::mutex> lock(index->mutex);
+    std::lock_guard<std::mutex> write_lock(index->write_mutex);
 
     try {
-        std::string id(chunk_id);
-
-        // Check if this ID already exists (update case)
-        auto it = index->id_to_label.find(id);
-        hnswlib::labeltype label;
+        // Live labels in ascending order become the dense labels 0..n-1
+        std::vector<hnswlib::labeltype> live;
+        live.reserve(index->ids.count());
+        for (hnswlib::labeltype label = 0; label < index->ids.size(); label++) {
+            if (!index->ids.id(label).empty()) {
+                live.push_back(label);
+            }
+        }
 
-        if (it != index->id_to_label.end()) {
-            // Update existing: mark old as deleted, add new
-            label = it->second;
-            index->hnsw->markDelete(label);
+        // Build the dense graph while searches keep using the old one; only
+        // writers mutate it and they are held off by write_mutex
+        std::unique_ptr<hnswlib::HierarchicalNSW<float>> dense(
+            new hnswlib::HierarchicalNSW<float>(index->space, live.size() + live.size() / 4 + 1,
+                                                index->hnsw->M_,
+                                                index->hnsw->ef_construction_));
+        bool ok = parallel_for(live.size(), num_threads, [&](size_t i) {
+            hnswlib::tableint internal;
+            {
+                std::lock_guard<std::mutex> lock(index->hnsw->label_lookup_lock);
+                internal = index->hnsw->label_lookup_.at(live[i]);
+            }
+            dense->addPoint(index->hnsw->getDataByInternalId(internal),
+                            static_cast<hnswlib::labeltype>(i));
+        });
+        if (!ok) {
+            return -1;
         }
 
-        // Assign new label
-        label = index->next_label++;
+        // Renumber attributes and re-intern them so values no longer used by
+        // a live vector drop out of the dictionaries
+        AttributeDict sources;
+        AttributeDict documents;
+        std::vector<LabelAttributes> label_attrs(live.size());
+        for (size_t i = 0; i < live.size(); i++) {
+            LabelAttributes attrs = attributes_of(index, live[i]);
+            if (attrs.source < index->sources.values.size()) {
+                label_attrs[i].source = sources.intern(index->sources.values[attrs.source]);
+            }
+            if (attrs.document < index->documents.values.size()) {
+                label_attrs[i].document =
+                    documents.intern(index->documents.values[attrs.document]);
+            }
+        }
 
-        // Normalize vector for cosine similarity
-        std::vector<float> normalized(vector, vector + dimension);
-        normalize_vector(normalized.data(), dimension);
+        ChunkIdTable ids;
+        ids.reserve(live.size(), index->ids.id_bytes());
+        for (size_t i = 0; i < live.size(); i++) {
+            ids.assign(i, index->ids.id(live[i]));
+        }
 
-        // Check if we need to resize
-        if (label >= index->max_elements) {
-            index->hnsw->resizeIndex(index->max_elements * 2);
-            index->max_elements *= 2;
+        std::unique_ptr<hnswlib::HierarchicalNSW<float>> old;
+        {
+            std::unique_lock<std::shared_mutex> lock(index->mutex);
+            // hnsw_set_ef writes ef_ under this lock, so it is read here
+            // rather than while building, which also keeps a change made
+            // during the build
+            dense->setEf(index->hnsw->ef_);
+            old.reset(index->hnsw);
+            index->hnsw = dense.release();
+            index->max_elements = index->hnsw->max_elements_;
+            // Searches read the ID table, so it is only swapped in here
+            index->ids = std::move(ids);
+            index->label_attrs = std::move(label_attrs);
+            index->sources = std::move(sources);
+            index->documents = std::move(documents);
+            index->next_label = static_cast<hnswlib::labeltype>(index->ids.size());
+            index->free_labels.clear();
+            index->label_generation++;
+            index->modified = true;
         }
 
-        // Add to index
-        index->hnsw->addPoint(normalized.data(), label);
+        if (reclaimed_bytes != nullptr) {
+            size_t before = graph_bytes(old.get());
+            size_t after = graph_bytes(index->hnsw);
+            *reclaimed_bytes = before > after ? static_cast<int64_t>(before - after) : 0;
+        }
 
-        // Update mappings
-        if (label >= index->label_to_id.size()) {
-            index->label_to_id.resize(label + 1);
+        // Logged records refer to the old labels, so the compacted index must
+        // become the snapshot now. Its graph and mapping are committed
+        // together, so a crash never pairs the renumbered graph with the old
+        // mapping or log. If the checkpoint fails, stop logging: the files on
+        // disk still describe one consistent snapshot, and close will retry
+        // the full save.
+        if (!checkpoint(index)) {
+            index->wal.close();
+            index->snapshot_required = true;
         }
-        index->label_to_id[label] = id;
-        index->id_to_label[id] = label;
-        index->modified = true;
 
         return 0;
     } catch (...) {
@@ -536,109 +2454,130 @@ int hnsw_add(HnswIndex* index, const char* chunk_id, const float* vector, int di
     }
 }
 
-int hnsw_delete(HnswIndex* index, const char* chunk_id) {
-    if (index == nullptr || chunk_id == nullptr) {
+int hnsw_checkpoint(HnswIndex* index) {
+    if (index == nullptr || index->readonly) {
         return -1;
     }
 
-    std::lock_guard<std::mutex> lock(index->mutex);
+    std::lock_guard<std::mutex> write_lock(index->write_mutex);
 
     try {
-        std::string id(chunk_id);
-        auto it = index->id_to_label.find(id);
-
-        if (it == index->id_to_label.end()) {
-            // ID not found - not an error, just no-op
+        if (!index->modified && !index->snapshot_required) {
             return 0;
         }
+        return checkpoint(index) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
 
-        hnswlib::labeltype label = it->second;
+int hnsw_set_background_flush(HnswIndex* index, const HnswFlushOptions* opts) {
+    if (index == nullptr || index->readonly ||
+        (opts != nullptr && (opts->interval_ms < 0 || opts->max_unsynced < 0 ||
+                             opts->max_log_bytes < 0))) {
+        return -1;
+    }
 
-        // Mark as deleted in HNSW
-        index->hnsw->markDelete(label);
+    HnswFlusher& flusher = index->flusher;
+    std::lock_guard<std::mutex> control_lock(flusher.control_mutex);
+    stop_flusher(index);
 
-        // Remove from mappings
-        index->id_to_label.erase(it);
-        if (label < index->label_to_id.size()) {
-            index->label_to_id[label] = "";  // Clear but keep slot
+    try {
+        bool ok;
+        {
+            std::lock_guard<std::mutex> write_lock(index->write_mutex);
+            ok = flush_changes(index);
         }
-        index->modified = true;
-
-        return 0;
+        if (opts != nullptr) {
+            flusher.interval_ms.store(opts->interval_ms > 0 ? opts->interval_ms : 1000);
+            flusher.max_unsynced.store(opts->max_unsynced > 0 ? opts->max_unsynced : 1000);
+            flusher.max_log_bytes.store(opts->max_log_bytes);
+            flusher.thread = std::thread(flush_loop, index);
+            flusher.active.store(true);
+        }
+        return ok ? 0 : -1;
     } catch (...) {
         return -1;
     }
 }
 
-int hnsw_search(HnswIndex* index, const float* query, int dimension, int k,
-                HnswSearchResult** results) {
-    if (index == nullptr || query == nullptr || results == nullptr || k <= 0) {
+int hnsw_flush(HnswIndex* index) {
+    if (index == nullptr) {
         return -1;
     }
-
-    if (dimension != index->dimension) {
-        return -1;
+    if (index->readonly) {
+        return 0;  // Nothing to make durable
     }
 
-    std::lock_guard<std::mutex> lock(index->mutex);
+    std::lock_guard<std::mutex> write_lock(index->write_mutex);
 
     try {
-        // Normalize query vector
-        std::vector<float> normalized(query, query + dimension);
-        normalize_vector(normalized.data(), dimension);
+        return flush_changes(index) ? 0 : -1;
+    } catch (...) {
+        return -1;
+    }
+}
 
-        // Search
-        auto result = index->hnsw->searchKnn(normalized.data(), k);
+const char* hnsw_kernel_isa(void) {
+    return hnsw_kernels().isa;
+}
 
-        // Count valid results (non-deleted entries)
-        std::vector<std::pair<float, hnswlib::labeltype>> valid_results;
-        while (!result.empty()) {
-            auto item = result.top();
-            result.pop();
+int hnsw_stats(HnswIndex* index, HnswStats* stats) {
+    if (index == nullptr || stats == nullptr) {
+        return -1;
+    }
 
-            hnswlib::labeltype label = item.second;
-            if (label < index->label_to_id.size() && !index->label_to_id[label].empty()) {
-                valid_results.push_back(item);
+    try {
+        *stats = HnswStats{};
+        {
+            std::shared_lock<std::shared_mutex> lock(index->mutex);
+            const hnswlib::HierarchicalNSW<float>* hnsw = index->hnsw;
+            stats->live_elements = index->ids.count();
+            stats->unsourced_elements = index->unsourced_count;
+            stats->deleted_elements = hnsw->cur_element_count - stats->live_elements;
+            stats->max_elements = index->max_elements;
+            stats->vector_bytes = hnsw->max_elements_ * hnsw->data_size_;
+            stats->graph_bytes = graph_bytes(hnsw) - stats->vector_bytes;
+
+            size_t mapping = index->ids.memory_bytes() + index->mapping_map.size +
+                index->label_attrs.capacity() * sizeof(LabelAttributes);
+            for (const AttributeDict* dict : {&index->sources, &index->documents}) {
+                for (const std::string& value : dict->values) {
+                    mapping += 2 * value.size();  // values and ordinals keys
+                }
             }
+            stats->mapping_bytes = mapping;
         }
 
-        if (valid_results.empty()) {
-            *results = nullptr;
-            return 0;
-        }
-
-        // Allocate results array
-        int count = static_cast<int>(valid_results.size());
-        *results = static_cast<HnswSearchResult*>(malloc(sizeof(HnswSearchResult) * count));
-        if (*results == nullptr) {
-            return -1;
-        }
-
-        // Fill results (reverse order since priority_queue gives largest first)
-        for (int i = 0; i < count; i++) {
-            int idx = count - 1 - i;  // Reverse to get best first
-            auto& item = valid_results[idx];
-
-            hnswlib::labeltype label = item.second;
-            const std::string& chunk_id = index->label_to_id[label];
-
-            (*results)[i].chunk_id = strdup(chunk_id.c_str());
-            // Inner product similarity is already in [0,1] for normalized vectors
-            (*results)[i].similarity = 1.0f - item.first;  // Convert distance to similarity
-        }
-
-        return count;
+        std::error_code ec;
+        uintmax_t wal = std::filesystem::file_size(wal_path(index), ec);
+        stats->wal_bytes = ec ? 0 : wal;
+
+        const IndexStats& s = index->stats;
+        stats->resize_count = s.resizes.load(std::memory_order_relaxed);
+        stats->searches = s.searches.load(std::memory_order_relaxed);
+        stats->distance_computations = s.distance_computations.load(std::memory_order_relaxed);
+        stats->search_ns = s.search_ns.load(std::memory_order_relaxed);
+        s.distances.copy_to(stats->distance_histogram);
+        s.latency_us.copy_to(stats->latency_histogram);
+        stats->lock_waits = s.lock_waits.load(std::memory_order_relaxed);
+        stats->read_wait_ns = s.read_wait_ns.load(std::memory_order_relaxed);
+        stats->exclusive_wait_ns = s.exclusive_wait_ns.load(std::memory_order_relaxed);
+        stats->writer_wait_ns = s.writer_wait_ns.load(std::memory_order_relaxed);
+        return 0;
     } catch (...) {
         return -1;
     }
 }
 
-void hnsw_free_results(HnswSearchResult* results, int count) {
-    if (results != nullptr) {
-        for (int i = 0; i < count; i++) {
-            free(results[i].chunk_id);
-        }
-        free(results);
+int hnsw_index_exists(const char* path) {
+    if (path == nullptr) {
+        return 0;
+    }
+    try {
+        return index_files_exist(path) ? 1 : 0;
+    } catch (...) {
+        return 0;
     }
 }
 
@@ -647,31 +2586,35 @@ void hnsw_close(HnswIndex* index) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(index->mutex);
+    if (!index->readonly) {
+        std::lock_guard<std::mutex> control_lock(index->flusher.control_mutex);
+        stop_flusher(index);
+    }
 
     try {
-        // Save index and mappings if modified
-        if (index->modified) {
-            // Always save ID mappings (includes precision metadata)
-            save_id_mappings(index);
-
-            if (index->precision == HNSW_PRECISION_FLOAT32) {
-                // For float32, save the full HNSW index
-                std::string index_path = index->path + "/index.bin";
-                index->hnsw->saveIndex(index_path);
-            } else {
-                // For float16/int8, save compressed vectors
-                save_compressed_vectors(index);
-            }
+        // Wait for in-flight writers, then fold the WAL into a snapshot if it
+        // has grown large; otherwise the logged changes are already durable
+        std::lock_guard<std::mutex> write_lock(index->write_mutex);
+        if (!index->readonly && checkpoint_due(index)) {
+            checkpoint(index);
         }
+        index->wal.close();
 
-        delete index->hnsw;
-        delete index->space;
-        delete index;
+        // Wait for in-flight searches before freeing
+        std::unique_lock<std::shared_mutex> lock(index->mutex);
     } catch (...) {
-        // Best effort cleanup
-        delete index;
+        // Best effort save; still free everything below
+    }
+
+    if (index->readonly) {
+        release_mapped_graph(index->hnsw);
+        unmap_file(&index->graph_map);
+        unmap_file(&index->mapping_map);
+    } else {
+        delete index->hnsw;
     }
+    delete index->space;
+    delete index;
 }
 
 } // extern "C"
@@ -0,0 +1,261 @@
+/*
+ * hybrid_wrapper.cpp - Fused keyword + vector search
+ *
+ * Each side's hits are collected into a flat list whose IDs share one
+ * buffer, so a search allocates a handful of buffers rather than one string
+ * per hit. The lists are fused through a hash map keyed by views into those
+ * buffers and copied out in one allocation.
+ * Error handling uses a thread-local error string accessible via hybrid_get_error().
+ */
+
+#include "hybrid_wrapper.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Thread-local storage for error messages
+static thread_local std::string last_error;
+
+static const int kDefaultRrfK = 60;
+
+// Ranked hits of one side, IDs packed into a single buffer
+struct RankedList {
+    std::string ids;
+    std::vector<size_t> ends;  // End offset of each ID in ids
+    std::vector<double> scores;
+    std::string error;
+
+    void reserve(size_t n) {
+        ids.reserve(n * 40);
+        ends.reserve(n);
+        scores.reserve(n);
+    }
+
+    void add(const char* id, size_t len, double score) {
+        ids.append(id, len);
+        ends.push_back(ids.size());
+        scores.push_back(score);
+    }
+
+    size_t size() const { return ends.size(); }
+
+    std::string_view id(size_t i) const {
+        size_t start = i == 0 ? 0 : ends[i - 1];
+        return std::string_view(ids).substr(start, ends[i] - start);
+    }
+};
+
+static void collect_keyword(void* ctx, const char* chunk_id, size_t chunk_id_len, double score) {
+    static_cast<RankedList*>(ctx)->add(chunk_id, chunk_id_len, score);
+}
+
+static void collect_vector(void* ctx, const char* chunk_id, size_t chunk_id_len,
+                           float similarity) {
+    static_cast<RankedList*>(ctx)->add(chunk_id, chunk_id_len, similarity);
+}
+
+// Helper: run the keyword side into list, recording any failure in list->error
+static void search_keyword(const HybridEngines* engines, const char* query, int limit,
+                           RankedList* list) {
+    try {
+        list->reserve(static_cast<size_t>(limit));
+        if (engines->keyword_search(engines->keyword_db, query, limit, collect_keyword,
+                                    list) < 0) {
+            // The engine's error is thread-local, so it is read on this thread
+            const char* err = engines->keyword_error != nullptr ? engines->keyword_error()
+                                                                : nullptr;
+            list->error = std::string("keyword search failed") +
+                          (err != nullptr && *err != '\0' ? ": " + std::string(err) : "");
+        }
+    } catch (const std::exception& e) {
+        list->error = e.what();
+    }
+}
+
+// Helper: run the vector side into list, recording any failure in list->error
+static void search_vector(const HybridEngines* engines, const float* vector, int dimension,
+                          int k, RankedList* list) {
+    try {
+        list->reserve(static_cast<size_t>(k));
+        if (engines->vector_search(engines->vector_index, vector, dimension, k,
+                                   engines->vector_options, collect_vector, list) < 0) {
+            list->error = "vector search failed";
+        }
+    } catch (const std::exception& e) {
+        list->error = e.what();
+    }
+}
+
+struct FusedHit {
+    std::string_view id;
+    double score;
+    double keyword_score;
+    float similarity;
+    int keyword_rank;
+    int vector_rank;
+
+    int best_rank() const {
+        if (keyword_rank < 0) {
+            return vector_rank;
+        }
+        return vector_rank < 0 ? keyword_rank : std::min(keyword_rank, vector_rank);
+    }
+};
+
+// Helper: merge both rankings into one entry per chunk, scored per opts
+static std::vector<FusedHit> fuse(const RankedList& keyword, const RankedList& vector,
+                                  const HybridOptions& opts) {
+    const double rrf_k = opts.rrf_k > 0 ? opts.rrf_k : kDefaultRrfK;
+    const double keyword_weight = opts.keyword_weight > 0 ? opts.keyword_weight : 1.0;
+    const double vector_weight = opts.vector_weight > 0 ? opts.vector_weight : 1.0;
+    const bool weighted = opts.fusion == HYBRID_FUSION_WEIGHTED;
+
+    // Keyword scores are unbounded, so weighted fusion scales them to [0, 1]
+    // by the best one; similarities already are
+    const double keyword_scale =
+        keyword.size() > 0 && keyword.scores[0] > 0 ? 1.0 / keyword.scores[0] : 0.0;
+
+    std::vector<FusedHit> fused;
+    fused.reserve(keyword.size() + vector.size());
+    std::unordered_map<std::string_view, size_t> index;
+    index.reserve(keyword.size() + vector.size());
+
+    for (size_t i = 0; i < keyword.size(); i++) {
+        const double score = weighted ? keyword_weight * keyword.scores[i] * keyword_scale
+                                      : keyword_weight / (rrf_k + static_cast<double>(i + 1));
+        // Keyword hits are unique, so each one starts its entry
+        if (index.emplace(keyword.id(i), fused.size()).second) {
+            fused.push_back({keyword.id(i), score, keyword.scores[i], 0.0f,
+                             static_cast<int>(i), -1});
+        }
+    }
+
+    for (size_t i = 0; i < vector.size(); i++) {
+        const double score = weighted ? vector_weight * vector.scores[i]
+                                      : vector_weight / (rrf_k + static_cast<double>(i + 1));
+        auto it = index.emplace(vector.id(i), fused.size());
+        if (it.second) {
+            fused.push_back({vector.id(i), score, 0.0,
+                             static_cast<float>(vector.scores[i]), -1, static_cast<int>(i)});
+        } else if (fused[it.first->second].vector_rank < 0) {
+            FusedHit& hit = fused[it.first->second];
+            hit.score += score;
+            hit.similarity = static_cast<float>(vector.scores[i]);
+            hit.vector_rank = static_cast<int>(i);
+        }
+    }
+
+    auto better = [](const FusedHit& a, const FusedHit& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        if (a.best_rank() != b.best_rank()) {
+            return a.best_rank() < b.best_rank();
+        }
+        return a.id < b.id;
+    };
+    if (opts.limit > 0 && fused.size() > static_cast<size_t>(opts.limit)) {
+        std::partial_sort(fused.begin(), fused.begin() + opts.limit, fused.end(), better);
+        fused.resize(static_cast<size_t>(opts.limit));
+    } else {
+        std::sort(fused.begin(), fused.end(), better);
+    }
+    return fused;
+}
+
+// Helper: copy fused hits into a single allocation of hits then IDs
+static bool pack_results(const std::vector<FusedHit>& fused, HybridResults* results) {
+    size_t id_bytes = 0;
+    for (const auto& hit : fused) {
+        id_bytes += hit.id.size() + 1;
+    }
+    const size_t hit_bytes = sizeof(HybridHit) * fused.size();
+    char* block = static_cast<char*>(malloc(hit_bytes + id_bytes));
+    if (block == nullptr) {
+        return false;
+    }
+
+    HybridHit* hits = reinterpret_cast<HybridHit*>(block);
+    char* ids = block + hit_bytes;
+    for (size_t i = 0; i < fused.size(); i++) {
+        const FusedHit& f = fused[i];
+        std::memcpy(ids, f.id.data(), f.id.size());
+        ids[f.id.size()] = '\0';
+        hits[i] = {ids, f.score, f.keyword_score, f.similarity, f.keyword_rank, f.vector_rank};
+        ids += f.id.size() + 1;
+    }
+
+    results->hits = hits;
+    results->count = static_cast<int>(fused.size());
+    return true;
+}
+
+int hybrid_search(const HybridEngines* engines, const char* query, const float* vector,
+                  int dimension, const HybridOptions* opts, HybridResults* results) {
+    if (results != nullptr) {
+        results->hits = nullptr;
+        results->count = 0;
+    }
+    if (engines == nullptr || opts == nullptr || results == nullptr) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    const bool use_keyword = engines->keyword_db != nullptr &&
+                             engines->keyword_search != nullptr && query != nullptr &&
+                             opts->keyword_limit > 0;
+    const bool use_vector = engines->vector_index != nullptr &&
+                            engines->vector_search != nullptr && vector != nullptr &&
+                            dimension > 0 && opts->vector_limit > 0;
+
+    try {
+        RankedList keyword;
+        RankedList vec;
+
+        // Overlap the two searches; a single side runs inline
+        if (use_keyword && use_vector) {
+            std::thread worker(search_keyword, engines, query, opts->keyword_limit, &keyword);
+            search_vector(engines, vector, dimension, opts->vector_limit, &vec);
+            worker.join();
+        } else if (use_keyword) {
+            search_keyword(engines, query, opts->keyword_limit, &keyword);
+        } else if (use_vector) {
+            search_vector(engines, vector, dimension, opts->vector_limit, &vec);
+        }
+
+        if (!keyword.error.empty() || !vec.error.empty()) {
+            last_error = !keyword.error.empty() ? keyword.error : vec.error;
+            return -1;
+        }
+
+        std::vector<FusedHit> fused = fuse(keyword, vec, *opts);
+        if (!fused.empty() && !pack_results(fused, results)) {
+            last_error = "memory allocation failed";
+            return -1;
+        }
+
+        last_error.clear();
+        return 0;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+void hybrid_free_results(HybridResults* results) {
+    if (results != nullptr) {
+        free(results->hits);
+        results->hits = nullptr;
+        results->count = 0;
+    }
+}
+
+const char* hybrid_get_error(void) {
+    return last_error.c_str();
+}
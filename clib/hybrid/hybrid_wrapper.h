@@ -0,0 +1,122 @@
+/*
+ * hybrid_wrapper.h - Fused keyword + vector search
+ *
+ * Runs a Xapian keyword search and an HNSW vector search concurrently and
+ * fuses the two rankings in one call. The engines are reached through their
+ * visitor entry points (xapian_search_visit, hnsw_search_visit), passed in
+ * as function pointers so this library does not link against either one.
+ * The same sources build the sercha_hybrid library in clib/.
+ */
+
+#ifndef SERCHA_HYBRID_WRAPPER_H
+#define SERCHA_HYBRID_WRAPPER_H
+
+#include "hnsw_wrapper.h"
+#include "xapian_wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * HybridEngines - The two indexes to search and their entry points
+ *
+ * Either side may be left NULL to search the other alone. Native callers
+ * linking both libraries pass xapian_search_visit, xapian_get_error and
+ * hnsw_search_visit.
+ */
+typedef struct {
+    xapian_db keyword_db;
+    int (*keyword_search)(xapian_db db, const char* query, int limit,
+                          xapian_hit_visitor visit, void* ctx);
+    const char* (*keyword_error)(void);  /* May be NULL */
+
+    HnswIndex* vector_index;
+    int (*vector_search)(HnswIndex* index, const float* query, int dimension, int k,
+                         const HnswSearchOptions* options, hnsw_hit_visitor visit,
+                         void* ctx);
+    const HnswSearchOptions* vector_options;  /* May be NULL */
+} HybridEngines;
+
+/*
+ * HybridFusion - How the two rankings are combined
+ */
+typedef enum {
+    HYBRID_FUSION_RRF = 0,      /* sum of weight / (rrf_k + rank), rank from 1 */
+    HYBRID_FUSION_WEIGHTED = 1  /* weighted keyword score (scaled by the best
+                                   keyword score) plus weighted similarity */
+} HybridFusion;
+
+/*
+ * HybridOptions - Candidate counts and fusion parameters
+ */
+typedef struct {
+    int keyword_limit;      /* Keyword candidates (<= 0: skip the keyword side) */
+    int vector_limit;       /* Vector candidates (<= 0: skip the vector side) */
+    int limit;              /* Fused results returned (<= 0: all) */
+    HybridFusion fusion;
+    int rrf_k;              /* RRF constant (<= 0: 60) */
+    double keyword_weight;  /* <= 0: 1 */
+    double vector_weight;   /* <= 0: 1 */
+} HybridOptions;
+
+/*
+ * HybridHit - A fused result
+ */
+typedef struct {
+    const char* chunk_id;
+    double score;          /* Fused score */
+    double keyword_score;  /* Raw keyword score (0 if not a keyword hit) */
+    float similarity;      /* Vector similarity (0 if not a vector hit) */
+    int keyword_rank;      /* 0-based rank in the keyword results, or -1 */
+    int vector_rank;       /* 0-based rank in the vector results, or -1 */
+} HybridHit;
+
+/*
+ * HybridResults - Fused results, best first
+ *
+ * hits and the chunk IDs they point to share one allocation.
+ */
+typedef struct {
+    HybridHit* hits;
+    int count;
+} HybridResults;
+
+/*
+ * hybrid_search - Search both indexes concurrently and fuse the rankings
+ *
+ * The keyword search runs on a worker thread while the vector search runs on
+ * the calling thread. A chunk found by both appears once. Ties are broken by
+ * the better of the two ranks, then by chunk ID, so the order is stable.
+ * Fails if either search fails, so callers can fall back as they see fit.
+ *
+ * @param engines: Indexes to search
+ * @param query: Keyword query (may be NULL to skip the keyword side)
+ * @param vector: Query embedding (may be NULL to skip the vector side)
+ * @param dimension: Length of vector
+ * @param opts: Candidate counts and fusion parameters
+ * @param results: Receives the fused results (free with hybrid_free_results)
+ * @return: 0 on success, -1 on error (see hybrid_get_error)
+ */
+int hybrid_search(const HybridEngines* engines, const char* query, const float* vector,
+                  int dimension, const HybridOptions* opts, HybridResults* results);
+
+/*
+ * hybrid_free_results - Free fused results
+ *
+ * @param results: Results to free; reset to empty
+ */
+void hybrid_free_results(HybridResults* results);
+
+/*
+ * hybrid_get_error - Get the last error message
+ *
+ * @return: Error message string (valid until next hybrid call)
+ */
+const char* hybrid_get_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERCHA_HYBRID_WRAPPER_H */
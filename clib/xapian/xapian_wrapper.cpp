@@ -1,43 +1,1706 @@
+/*
+ * xapian_wrapper.cpp - C-compatible wrapper implementation for Xapian C++ API
+ *
+ * This implementation wraps Xapian's C++ API in C-compatible functions for use with CGO.
+ * Error handling uses a thread-local error string accessible via xapian_get_error().
+ */
+
 #include "xapian_wrapper.h"
+#include <xapian.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Thread-local storage for error messages
+static thread_local std::string last_error;
+
+// A read-only handle for searches, tagged with the writer generation it has
+// seen so it can be reopened once a writer commits. The query parser is
+// configured once and stays bound to db across reopens.
+struct PooledReader {
+    Xapian::Database db;
+    uint64_t generation;
+    uint64_t epoch;  // Files swapped in by compaction since open
+    Xapian::Stem stemmer;
+    Xapian::QueryParser parser;
+
+    PooledReader(const std::vector<std::string>& paths, uint64_t gen, uint64_t ep)
+        : generation(gen), epoch(ep), stemmer("en") {
+        // A sharded database is searched as one combined database
+        for (const std::string& path : paths) {
+            db.add_database(Xapian::Database(path));
+        }
+        parser.set_database(db);
+        parser.set_stemmer(stemmer);
+        parser.set_stemming_strategy(Xapian::QueryParser::STEM_SOME);
+        parser.set_default_op(Xapian::Query::OP_OR);
+    }
+};
+
+typedef std::vector<std::pair<std::string, double>> Hits;
+typedef std::vector<std::string> Snippets;
+
+// A cached answer: the hits, plus their snippets for a snippet search
+struct CachedResult {
+    Hits hits;
+    Snippets snippets;
+};
+
+// LRU cache of search results keyed by (normalized query, limit, snippet
+// options). Entries belong to one writer generation; the first access after
+// a commit drops them all.
+class ResultCache {
+public:
+    void set_capacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        evict();
+    }
+
+    bool lookup(const std::string& key, uint64_t generation, Hits* out,
+                Snippets* snippets = nullptr) {
+        return visit(key, generation, [out, snippets](const CachedResult& result) {
+            *out = result.hits;
+            if (snippets != nullptr) {
+                *snippets = result.snippets;
+            }
+        });
+    }
+
+    // Calls fn with the cached result for key, under the cache lock, instead
+    // of copying them. fn must not call back into the cache.
+    template <typename Fn>
+    bool visit(const std::string& key, uint64_t generation, Fn fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (capacity_ == 0) {
+            return false;
+        }
+        advance(generation);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            misses_++;
+            return false;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        fn(it->second->second);
+        hits_++;
+        return true;
+    }
+
+    // Stores hits (and snippets) computed by a reader at generation (dropped
+    // if stale)
+    void insert(const std::string& key, uint64_t generation, const Hits& hits,
+                const Snippets* snippets = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (capacity_ == 0 || generation < generation_) {
+            return;
+        }
+        advance(generation);
+        CachedResult result{hits, snippets != nullptr ? *snippets : Snippets()};
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->second = std::move(result);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        entries_.emplace_front(key, std::move(result));
+        index_[key] = entries_.begin();
+        evict();
+    }
+
+    XapianCacheStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return XapianCacheStats{hits_, misses_, static_cast<int>(entries_.size()),
+                                static_cast<int>(capacity_)};
+    }
+
+private:
+    void advance(uint64_t generation) {
+        if (generation != generation_) {
+            entries_.clear();
+            index_.clear();
+            generation_ = generation;
+        }
+    }
+
+    void evict() {
+        while (entries_.size() > capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+    }
+
+    std::mutex mutex_;
+    size_t capacity_ = 0;
+    uint64_t generation_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    std::list<std::pair<std::string, CachedResult>> entries_;  // Most recent first
+    std::unordered_map<std::string,
+                       std::list<std::pair<std::string, CachedResult>>::iterator> index_;
+};
+
+// Cache key: the query with surrounding whitespace trimmed and inner runs
+// collapsed to one space, plus the limit and, for a snippet search, the
+// snippet options. Case is kept, since the parser treats upper-case
+// AND/OR/NOT as operators.
+static void cache_key_into(const char* query, int limit, int per_document, std::string* out,
+                           const XapianSnippetOptions* snippet_opts = nullptr) {
+    std::string& key = *out;
+    key.clear();
+    bool space = false;
+    for (const char* p = query; *p != '\0'; p++) {
+        if (std::isspace(static_cast<unsigned char>(*p))) {
+            space = !key.empty();
+            continue;
+        }
+        if (space) {
+            key.push_back(' ');
+            space = false;
+        }
+        key.push_back(*p);
+    }
+    key.push_back('\0');
+    key.append(std::to_string(limit));
+    key.push_back('\0');
+    key.append(std::to_string(per_document));
+    if (snippet_opts != nullptr) {
+        key.push_back('\0');
+        key.append(std::to_string(snippet_opts->length));
+        key.push_back('\0');
+        key.append(std::to_string(snippet_opts->top_n));
+        key.push_back('\0');
+        key.append(snippet_opts->hi_start != nullptr ? snippet_opts->hi_start : "");
+        key.push_back('\0');
+        key.append(snippet_opts->hi_end != nullptr ? snippet_opts->hi_end : "");
+    }
+}
+
+static std::string cache_key(const char* query, int limit, int per_document,
+                             const XapianSnippetOptions* snippet_opts = nullptr) {
+    std::string key;
+    cache_key_into(query, limit, per_document, &key, snippet_opts);
+    return key;
+}
+
+static bool path_exists(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+// Total size in bytes of the files under path
+static uint64_t tree_size(const std::string& path) {
+    struct stat st;
+    if (::lstat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return static_cast<uint64_t>(st.st_size);
+    }
+    uint64_t total = 0;
+    if (DIR* dir = opendir(path.c_str())) {
+        while (struct dirent* entry = readdir(dir)) {
+            if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+                total += tree_size(path + "/" + entry->d_name);
+            }
+        }
+        closedir(dir);
+    }
+    return total;
+}
+
+// Delete path and everything under it (missing is not an error)
+static bool remove_tree(const std::string& path) {
+    struct stat st;
+    if (::lstat(path.c_str(), &st) != 0) {
+        return errno == ENOENT;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return ::unlink(path.c_str()) == 0;
+    }
+    bool ok = true;
+    if (DIR* dir = opendir(path.c_str())) {
+        while (struct dirent* entry = readdir(dir)) {
+            if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+                ok = remove_tree(path + "/" + entry->d_name) && ok;
+            }
+        }
+        closedir(dir);
+    }
+    return ::rmdir(path.c_str()) == 0 && ok;
+}
+
+// In-place compaction writes path.compact, then renames path to path.old and
+// path.compact to path. Finish or undo an interrupted swap before opening
+// path, and drop the leftovers of finished ones.
+static const std::string& recover_compaction(const std::string& path) {
+    std::string old_path = path + ".old";
+    if (!path_exists(path) && path_exists(old_path)) {
+        if (std::rename(old_path.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("cannot restore " + old_path + ": " + std::strerror(errno));
+        }
+    }
+    remove_tree(path + ".compact");
+    remove_tree(old_path);
+    return path;
+}
+
+// One writable (sub-)database with its own writer lock and batch state.
+struct Shard {
+    Xapian::WritableDatabase db;
+    std::string path;
+    std::mutex write_mutex;    // Serializes all use of db and the fields below
+    bool in_batch = false;     // A batch transaction is open on db
+    int batch_changes = 0;     // Changes in the current transaction
+    int batch_limit = 0;       // Changes per transaction (0 = unlimited)
+    int pending = 0;           // Uncommitted changes deferred to the flusher
+    Xapian::TermGenerator indexer;  // Reused for every document
+
+    explicit Shard(const std::string& p)
+        : db(recover_compaction(p), Xapian::DB_CREATE_OR_OPEN), path(p) {
+        indexer.set_stemmer(Xapian::Stem("en"));
+        indexer.set_stemming_strategy(Xapian::TermGenerator::STEM_SOME);
+    }
+};
+
+// Background committer of changes deferred by xapian_set_background_flush.
+// Lock order: a shard write_mutex may be held while taking mutex, never the
+// reverse.
+struct Flusher {
+    std::mutex control_mutex;          // Serializes starting and stopping
+    std::thread thread;
+    std::mutex mutex;                  // Guards stop and requested
+    std::condition_variable wake;
+    bool stop = false;
+    bool requested = false;            // A shard reached max_pending
+    std::atomic<bool> active{false};   // Changes outside batches are deferred
+    std::atomic<int> interval_ms{1000};
+    std::atomic<int> max_pending{1000};
+};
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t nanos_since(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+// Log2 histogram with the XAPIAN_STATS_BUCKETS bucketing
+struct XapianHistogram {
+    std::atomic<uint64_t> buckets[XAPIAN_STATS_BUCKETS] = {};
+
+    void add(uint64_t value) {
+        size_t bucket = value < 2 ? 0 : static_cast<size_t>(63 - __builtin_clzll(value));
+        buckets[std::min<size_t>(bucket, XAPIAN_STATS_BUCKETS - 1)].fetch_add(
+            1, std::memory_order_relaxed);
+    }
+
+    void copy_to(uint64_t* out) const {
+        for (size_t i = 0; i < XAPIAN_STATS_BUCKETS; i++) {
+            out[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Latency counters behind xapian_stats, updated with relaxed atomics
+struct LatencyStats {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    XapianHistogram histogram_us;
+
+    void add(uint64_t ns) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        histogram_us.add(ns / 1000);
+    }
+};
+
+// Internal database wrapper to hold both readable and writable database handles.
+//
+// The database is a single Xapian database or, when opened sharded, N
+// sub-databases with chunks routed by a hash of chunk_id. Xapian objects are
+// not thread-safe, so each shard's writable handle is only used under its
+// write_mutex; writes to different shards proceed in parallel. Every search
+// borrows a read-only Database combining all shards from the pool for its
+// duration, so searches run in parallel with each other and with indexing.
+// Readers see committed changes only: each commit bumps generation, and a
+// reader older than it is reopened when next borrowed.
+//
+// Compaction swaps a shard's files under swap_mutex held exclusively, while
+// readers hold it shared to open or reopen, so no reader sees a shard path
+// mid-swap. Readers opened before a swap are retired by epoch.
+//
+// Lock order: batch_mutex, then shard write_mutexes in ascending order, then
+// swap_mutex.
+struct XapianDatabase {
+    std::string path;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<std::string> shard_paths;
+    std::mutex batch_mutex;                 // Serializes batch begin/commit/cancel
+    std::condition_variable batch_idle;     // Signalled when batch_depth drops to 0
+    int batch_depth = 0;                    // Nesting level of xapian_begin_batch calls
+    std::atomic<uint64_t> generation{0};    // Commits since open
+    std::shared_mutex swap_mutex;
+    std::atomic<uint64_t> epoch{0};         // Compaction swaps since open
+    std::mutex pool_mutex;
+    std::vector<std::unique_ptr<PooledReader>> idle_readers;
+    ResultCache cache;
+    std::atomic<int> per_document{0};  // Hits kept per parent document (0 = all)
+    Flusher flusher;
+    LatencyStats commits;
+    LatencyStats searches;
+
+    XapianDatabase(const std::string& p, const std::vector<std::string>& paths)
+        : path(p), shard_paths(paths) {
+        for (const std::string& shard_path : paths) {
+            shards.emplace_back(new Shard(shard_path));
+        }
+    }
+
+    // Shard owning chunk_id. The routing depends only on the shard count,
+    // which is fixed when a sharded database is created.
+    size_t shard_index(const char* chunk_id, size_t len) const {
+        if (shards.size() == 1) {
+            return 0;
+        }
+        uint64_t h = 14695981039346656037ull;  // FNV-1a
+        for (size_t i = 0; i < len; i++) {
+            h ^= static_cast<unsigned char>(chunk_id[i]);
+            h *= 1099511628211ull;
+        }
+        return static_cast<size_t>(h % shards.size());
+    }
+
+    Shard& shard_for(const char* chunk_id) {
+        return *shards[shard_index(chunk_id, std::strlen(chunk_id))];
+    }
+};
+
+// Sharded layout: a SHARDS file holding the shard count, next to shard-NNN
+// sub-database directories
+static const char* kShardsFile = "SHARDS";
+
+static std::string shard_path(const std::string& path, int shard) {
+    char name[16];
+    snprintf(name, sizeof(name), "shard-%03d", shard);
+    return path + "/" + name;
+}
+
+// Shard count recorded at path, or 0 if path is not a sharded database
+static int read_shard_count(const std::string& path) {
+    std::ifstream in(path + "/" + kShardsFile);
+    int count = 0;
+    if (!(in >> count) || count < 1) {
+        return 0;
+    }
+    return count;
+}
+
+// True if path is missing or an empty directory
+static bool is_empty_dir(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return errno == ENOENT;
+    }
+    bool empty = true;
+    while (struct dirent* entry = readdir(dir)) {
+        if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+            empty = false;
+            break;
+        }
+    }
+    closedir(dir);
+    return empty;
+}
+
+// Record the shard count, replacing the file atomically
+static void write_shard_count(const std::string& path, int count) {
+    std::string file = path + "/" + kShardsFile;
+    std::string tmp = file + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << count << "\n";
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("cannot write " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), file.c_str()) != 0) {
+        throw std::runtime_error("cannot rename " + tmp + ": " + std::strerror(errno));
+    }
+}
+
+// Build and store the document for one chunk (not committed)
+static void index_document(Shard& shard, const std::string& chunk_id,
+                           const std::string* doc_id, const std::string& content) {
+    // Create a new document
+    Xapian::Document doc;
+    shard.indexer.set_document(doc);
+
+    // Index the content with positional information for phrase queries
+    shard.indexer.index_text(content);
+
+    // Store metadata
+    doc.add_value(0, chunk_id);  // Slot 0: chunk_id for retrieval
+    if (doc_id != nullptr) {
+        doc.add_value(1, *doc_id);  // Slot 1: parent document ID
+    }
+
+    // Store the original content for potential snippeting
+    doc.set_data(content);
+
+    // Use chunk_id as the unique identifier term
+    std::string id_term = "Q" + chunk_id;
+    doc.add_boolean_term(id_term);
+
+    // Replace or add the document
+    shard.db.replace_document(id_term, doc);
+}
+
+// Record a commit so pooled readers reopen before their next search
+static void committed(XapianDatabase* wrapper) {
+    wrapper->generation.fetch_add(1, std::memory_order_release);
+}
+
+// committed() for a commit begun at start, counted in the commit stats
+static void committed(XapianDatabase* wrapper, Clock::time_point start) {
+    wrapper->commits.add(nanos_since(start));
+    committed(wrapper);
+}
+
+// Record changes left for the flusher, waking it early once the shard has
+// max_pending of them. Caller holds shard.write_mutex.
+static void defer_changes(XapianDatabase* wrapper, Shard& shard, int changes) {
+    shard.pending += changes;
+    Flusher& flusher = wrapper->flusher;
+    if (shard.pending >= flusher.max_pending.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(flusher.mutex);
+        flusher.requested = true;
+        flusher.wake.notify_one();
+    }
+}
+
+// Commit shard's deferred changes, if any. Caller holds shard.write_mutex.
+static void commit_pending(XapianDatabase* wrapper, Shard& shard) {
+    if (shard.pending > 0 && !shard.in_batch) {
+        Clock::time_point start = Clock::now();
+        shard.db.commit();
+        shard.pending = 0;
+        committed(wrapper, start);
+    }
+}
+
+// Commit the deferred changes of every shard, continuing past a failure.
+// Returns the first error message, empty on success.
+static std::string commit_all_pending(XapianDatabase* wrapper) {
+    std::string error;
+    for (auto& shard : wrapper->shards) {
+        std::lock_guard<std::mutex> lock(shard->write_mutex);
+        try {
+            commit_pending(wrapper, *shard);
+        } catch (const Xapian::Error& e) {
+            if (error.empty()) {
+                error = e.get_description();
+            }
+        } catch (const std::exception& e) {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+    return error;
+}
+
+// Body of the flusher thread. A failed commit leaves the changes pending, so
+// the next round (or xapian_flush) retries it.
+static void flush_loop(XapianDatabase* wrapper) {
+    Flusher& flusher = wrapper->flusher;
+    std::unique_lock<std::mutex> lock(flusher.mutex);
+    while (!flusher.stop) {
+        auto interval = std::chrono::milliseconds(flusher.interval_ms.load());
+        flusher.wake.wait_for(lock, interval, [&] { return flusher.stop || flusher.requested; });
+        flusher.requested = false;
+        lock.unlock();
+        commit_all_pending(wrapper);
+        lock.lock();
+    }
+}
+
+// Stop the flusher thread, if running, and commit what it left pending.
+// Caller holds flusher.control_mutex. Returns an error message, empty on
+// success.
+static std::string stop_flusher(XapianDatabase* wrapper) {
+    Flusher& flusher = wrapper->flusher;
+    if (flusher.thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(flusher.mutex);
+            flusher.stop = true;
+            flusher.wake.notify_one();
+        }
+        flusher.thread.join();
+        flusher.stop = false;
+        flusher.requested = false;
+    }
+    // Writers that still saw active commit through it below, since each
+    // shard is visited under its write_mutex
+    flusher.active.store(false);
+    return commit_all_pending(wrapper);
+}
+
+// Make a change to shard durable: commit it on its own outside a batch (or
+// leave it to the flusher), or count it toward the batch, committing and
+// starting a new transaction at the limit. Caller holds shard.write_mutex.
+static void commit_change(XapianDatabase* wrapper, Shard& shard) {
+    if (!shard.in_batch) {
+        if (wrapper->flusher.active.load()) {
+            defer_changes(wrapper, shard, 1);
+            return;
+        }
+        Clock::time_point start = Clock::now();
+        shard.db.commit();
+        committed(wrapper, start);
+        return;
+    }
+    if (shard.batch_limit > 0 && ++shard.batch_changes >= shard.batch_limit) {
+        Clock::time_point start = Clock::now();
+        shard.db.commit_transaction();
+        committed(wrapper, start);
+        shard.batch_changes = 0;
+        shard.db.begin_transaction(true);
+    }
+}
+
+// Idle readers kept per database; more concurrent searches open extra
+// handles that are closed again when returned
+static size_t max_idle_readers() {
+    return std::max(2u, std::thread::hardware_concurrency());
+}
+
+// Borrowed read-only handle, returned to the pool on destruction
+class ReaderLease {
+public:
+    explicit ReaderLease(XapianDatabase* wrapper) : wrapper_(wrapper) {
+        {
+            std::lock_guard<std::mutex> lock(wrapper->pool_mutex);
+            if (!wrapper->idle_readers.empty()) {
+                reader_ = std::move(wrapper->idle_readers.back());
+                wrapper->idle_readers.pop_back();
+            }
+        }
+        if (!reader_ ||
+            reader_->generation != wrapper->generation.load(std::memory_order_acquire) ||
+            reader_->epoch != wrapper->epoch.load(std::memory_order_acquire)) {
+            refresh();
+        }
+    }
+
+    ~ReaderLease() {
+        std::lock_guard<std::mutex> lock(wrapper_->pool_mutex);
+        if (reader_->epoch == wrapper_->epoch.load(std::memory_order_acquire) &&
+            wrapper_->idle_readers.size() < max_idle_readers()) {
+            wrapper_->idle_readers.push_back(std::move(reader_));
+        }
+    }
+
+    ReaderLease(const ReaderLease&) = delete;
+    ReaderLease& operator=(const ReaderLease&) = delete;
+
+    Xapian::Database& db() { return reader_->db; }
+    Xapian::QueryParser& parser() { return reader_->parser; }
+    const Xapian::Stem& stemmer() const { return reader_->stemmer; }
+    uint64_t generation() const { return reader_->generation; }
+
+    // Move to the latest committed revision (also after DatabaseModifiedError).
+    // A reader from before a compaction swap is replaced, not reopened.
+    void refresh() {
+        std::shared_lock<std::shared_mutex> lock(wrapper_->swap_mutex);
+        uint64_t gen = wrapper_->generation.load(std::memory_order_acquire);
+        uint64_t epoch = wrapper_->epoch.load(std::memory_order_acquire);
+        if (!reader_ || reader_->epoch != epoch) {
+            reader_.reset(new PooledReader(wrapper_->shard_paths, gen, epoch));
+            return;
+        }
+        reader_->generation = gen;
+        reader_->db.reopen();
+    }
+
+private:
+    XapianDatabase* wrapper_;
+    std::unique_ptr<PooledReader> reader_;
+};
+
+// Fill in the chunk_id (value slot 0) of each hit from the value stream rather
+// than get_document(), which would also fetch the stored chunk text. The
+// stream is ordered by docid, so it is walked once over the sorted hits.
+static void read_chunk_ids(const Xapian::Database& db, const std::vector<Xapian::docid>& docids,
+                           Hits* hits) {
+    std::vector<size_t> order(docids.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return docids[a] < docids[b]; });
+
+    Xapian::ValueIterator values = db.valuestream_begin(0);
+    Xapian::ValueIterator values_end = db.valuestream_end(0);
+    for (size_t i : order) {
+        Xapian::docid did = docids[i];
+        if (values != values_end && values.get_docid() < did) {
+            values.skip_to(did);
+        }
+        if (values != values_end && values.get_docid() == did) {
+            (*hits)[i].first = *values;
+        } else {
+            // Written without slot 0 (should not happen): fall back to the record
+            (*hits)[i].first = db.get_document(did).get_value(0);
+        }
+    }
+}
+
+// Snippet defaults when XapianSnippetOptions leaves a field unset
+static const int kDefaultSnippetLength = 200;
+
+// Highlighted snippets of the stored chunk text for the first top_n hits.
+// Only these documents are fetched; the rest get no snippet.
+static void make_snippets(const ReaderLease& reader, const Xapian::MSet& matches,
+                          const XapianSnippetOptions& opts, std::vector<std::string>* snippets) {
+    size_t length = opts.length > 0 ? static_cast<size_t>(opts.length) : kDefaultSnippetLength;
+    size_t top_n = opts.top_n > 0 ? static_cast<size_t>(opts.top_n) : matches.size();
+    std::string hi_start = opts.hi_start != nullptr ? opts.hi_start : "";
+    std::string hi_end = opts.hi_end != nullptr ? opts.hi_end : "";
+
+    snippets->assign(std::min<size_t>(top_n, matches.size()), std::string());
+    Xapian::MSetIterator it = matches.begin();
+    for (size_t i = 0; i < snippets->size(); ++i, ++it) {
+        (*snippets)[i] = matches.snippet(it.get_document().get_data(), length, reader.stemmer(),
+                                         Xapian::MSet::SNIPPET_BACKGROUND_MODEL |
+                                             Xapian::MSet::SNIPPET_EXHAUSTIVE,
+                                         hi_start, hi_end);
+    }
+}
+
+// Run a query on a borrowed reader. A commit can overwrite blocks the reader
+// is using, in which case it is reopened and the query retried once.
+// At most per_document hits are kept per parent document (slot 1) when it
+// is positive. Snippets are generated in the same pass when snippet_opts is set.
+static void run_search(ReaderLease& reader, const char* query_str, int limit, int per_document,
+                       Hits* hits, const XapianSnippetOptions* snippet_opts = nullptr,
+                       std::vector<std::string>* snippets = nullptr) {
+    for (int attempt = 0;; attempt++) {
+        try {
+            hits->clear();
+            if (snippets != nullptr) {
+                snippets->clear();
+            }
+
+            // Parse the query with partial matching for better recall
+            Xapian::Query query = reader.parser().parse_query(
+                query_str,
+                Xapian::QueryParser::FLAG_DEFAULT |
+                Xapian::QueryParser::FLAG_WILDCARD |
+                Xapian::QueryParser::FLAG_PARTIAL
+            );
+
+            // If empty query, return no results
+            if (query.empty()) {
+                return;
+            }
+
+            // Create an enquire object and run the query
+            Xapian::Enquire enquire(reader.db());
+            enquire.set_query(query);
+
+            // Keep the top-k diverse: a long document cannot take every slot.
+            // Chunks indexed without a document ID are never collapsed.
+            if (per_document > 0) {
+                enquire.set_collapse_key(1, static_cast<Xapian::doccount>(per_document));
+            }
+
+            // Get the matching documents
+            Xapian::MSet matches = enquire.get_mset(0, limit);
+
+            // Normalize scores to 0-1 range using MSet's max_possible
+            double max_weight = matches.get_max_possible();
+            std::vector<Xapian::docid> docids;
+            docids.reserve(matches.size());
+            hits->reserve(matches.size());
+            for (Xapian::MSetIterator it = matches.begin(); it != matches.end(); ++it) {
+                double score = max_weight > 0 ? it.get_weight() / max_weight : 0.0;
+                docids.push_back(*it);
+                hits->emplace_back(std::string(), score);
+            }
+            read_chunk_ids(reader.db(), docids, hits);
+            if (snippet_opts != nullptr && snippets != nullptr) {
+                make_snippets(reader, matches, *snippet_opts, snippets);
+            }
+            return;
+        } catch (const Xapian::DatabaseModifiedError&) {
+            if (attempt > 0) {
+                throw;
+            }
+            reader.refresh();
+        }
+    }
+}
+
+// Xapian compaction flags for the options (NULL = defaults)
+static unsigned compact_flags(const XapianCompactOptions* opts) {
+    int level = opts != nullptr ? opts->level : 0;
+    switch (level) {
+    case 1:
+        return Xapian::Compactor::FULL;
+    case 2:
+        return Xapian::Compactor::FULLER;
+    default:
+        return Xapian::Compactor::STANDARD;
+    }
+}
+
+// Compact one shard's committed state to target. Caller holds shard's
+// write_mutex so no commit lands mid-compaction.
+static void compact_shard(const Shard& shard, const std::string& target,
+                          const XapianCompactOptions* opts) {
+    int block_size = opts != nullptr ? opts->block_size : 0;
+    Xapian::Database(shard.path).compact(target, compact_flags(opts), block_size);
+}
+
+// Compact a shard into path.compact and swap it in for the live files.
+// Caller holds batch_mutex (with no batch open) and shard's write_mutex.
+static void compact_shard_in_place(XapianDatabase* wrapper, Shard& shard,
+                                   const XapianCompactOptions* opts) {
+    std::string tmp_path = shard.path + ".compact";
+    std::string old_path = shard.path + ".old";
+    remove_tree(tmp_path);
+    remove_tree(old_path);
+    compact_shard(shard, tmp_path, opts);
+
+    {
+        // Searches already running keep the old files open; new ones wait
+        // here and then open the compacted files
+        std::unique_lock<std::shared_mutex> swap_lock(wrapper->swap_mutex);
+        shard.db.close();
+        std::string error;
+        if (std::rename(shard.path.c_str(), old_path.c_str()) != 0) {
+            error = "cannot move " + shard.path + " aside: " + std::strerror(errno);
+        } else if (std::rename(tmp_path.c_str(), shard.path.c_str()) != 0) {
+            error = "cannot move " + tmp_path + " into place: " + std::strerror(errno);
+            std::rename(old_path.c_str(), shard.path.c_str());
+        }
+        shard.db = Xapian::WritableDatabase(shard.path, Xapian::DB_CREATE_OR_OPEN);
+        if (!error.empty()) {
+            remove_tree(tmp_path);
+            throw std::runtime_error(error);
+        }
+        wrapper->epoch.fetch_add(1, std::memory_order_release);
+    }
+    committed(wrapper);
+
+    {
+        std::lock_guard<std::mutex> lock(wrapper->pool_mutex);
+        wrapper->idle_readers.clear();
+    }
+
+    // Searches still running on the old files keep them open until done
+    remove_tree(old_path);
+}
 
-// Stub implementation - will be filled in when implementing functionality
+// Copy hits (and snippets, if any) into a malloc'd SearchResults.
+// Returns false on allocation failure.
+static bool to_results(const Hits& hits, const std::vector<std::string>* snippets,
+                       SearchResults* results) {
+    results->results = static_cast<SearchResult*>(malloc(sizeof(SearchResult) * hits.size()));
+    if (results->results == nullptr) {
+        return false;
+    }
+
+    // Populate results (caller must free each chunk_id and snippet)
+    results->count = static_cast<int>(hits.size());
+    for (int i = 0; i < results->count; ++i) {
+        results->results[i].chunk_id = strdup(hits[i].first.c_str());
+        results->results[i].score = hits[i].second;
+        results->results[i].snippet = nullptr;
+        if (snippets != nullptr && static_cast<size_t>(i) < snippets->size()) {
+            results->results[i].snippet = strdup((*snippets)[i].c_str());
+        }
+    }
+    return true;
+}
 
 extern "C" {
 
-XapianDatabase* xapian_open(const char* path) {
-    (void)path;
-    return nullptr;
+xapian_db xapian_open(const char* path) {
+    if (path == nullptr) {
+        last_error = "invalid arguments: path must not be null";
+        return nullptr;
+    }
+
+    try {
+        std::vector<std::string> paths;
+        int count = read_shard_count(path);
+        if (count == 0) {
+            paths.push_back(path);
+        }
+        for (int i = 0; i < count; i++) {
+            paths.push_back(shard_path(path, i));
+        }
+
+        XapianDatabase* wrapper = new XapianDatabase(path, paths);
+        last_error.clear();
+        return static_cast<xapian_db>(wrapper);
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return nullptr;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return nullptr;
+    }
 }
 
-int xapian_index(XapianDatabase* db, const char* chunk_id, const char* content) {
-    (void)db;
-    (void)chunk_id;
-    (void)content;
-    return -1;
+xapian_db xapian_open_sharded(const char* path, int num_shards) {
+    if (path == nullptr || num_shards < 1) {
+        last_error = "invalid arguments";
+        return nullptr;
+    }
+
+    try {
+        int count = read_shard_count(path);
+        if (count == 0) {
+            if (!is_empty_dir(path)) {
+                last_error = std::string("not a sharded database: ") + path;
+                return nullptr;
+            }
+            if (::mkdir(path, 0700) != 0 && errno != EEXIST) {
+                last_error = std::string("cannot create ") + path + ": " + std::strerror(errno);
+                return nullptr;
+            }
+        } else if (count != num_shards) {
+            last_error = "database has " + std::to_string(count) + " shards, not " +
+                         std::to_string(num_shards);
+            return nullptr;
+        }
+
+        std::vector<std::string> paths;
+        for (int i = 0; i < num_shards; i++) {
+            paths.push_back(shard_path(path, i));
+        }
+        XapianDatabase* wrapper = new XapianDatabase(path, paths);
+
+        // Written once every shard exists, so a crash mid-creation leaves a
+        // directory that is neither a valid layout nor mistaken for one
+        if (count == 0) {
+            try {
+                write_shard_count(path, num_shards);
+            } catch (...) {
+                delete wrapper;
+                throw;
+            }
+        }
+
+        last_error.clear();
+        return static_cast<xapian_db>(wrapper);
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return nullptr;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return nullptr;
+    }
 }
 
-int xapian_delete(XapianDatabase* db, const char* chunk_id) {
-    (void)db;
-    (void)chunk_id;
-    return -1;
+int xapian_shard_count(xapian_db db) {
+    if (db == nullptr) {
+        last_error = "invalid arguments: db must not be null";
+        return -1;
+    }
+
+    last_error.clear();
+    return static_cast<int>(static_cast<XapianDatabase*>(db)->shards.size());
 }
 
-int xapian_search(XapianDatabase* db, const char* query, int limit,
-                  XapianSearchResult** results) {
-    (void)db;
-    (void)query;
-    (void)limit;
-    (void)results;
+void xapian_close(xapian_db db) {
+    if (db != nullptr) {
+        XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+        {
+            std::lock_guard<std::mutex> control_lock(wrapper->flusher.control_mutex);
+            stop_flusher(wrapper);  // Closing commits anything still pending
+        }
+        std::lock_guard<std::mutex> batch_lock(wrapper->batch_mutex);
+        for (auto& shard : wrapper->shards) {
+            try {
+                std::lock_guard<std::mutex> lock(shard->write_mutex);
+                if (shard->in_batch) {
+                    shard->in_batch = false;
+                    shard->db.commit_transaction();
+                }
+                shard->db.close();
+            } catch (...) {
+                // Ignore errors during close
+            }
+        }
+        delete wrapper;
+    }
+}
+
+int xapian_index(xapian_db db, const char* chunk_id, const char* doc_id, const char* content) {
+    if (db == nullptr || chunk_id == nullptr || content == nullptr) {
+        last_error = "invalid arguments: db, chunk_id, and content must not be null";
+        return -1;
+    }
+
+    try {
+        XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+        Shard& shard = wrapper->shard_for(chunk_id);
+        std::lock_guard<std::mutex> lock(shard.write_mutex);
+
+        std::string parent = doc_id != nullptr ? doc_id : "";
+        index_document(shard, chunk_id, doc_id != nullptr ? &parent : nullptr, content);
+        commit_change(wrapper, shard);
+
+        last_error.clear();
+        return 0;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return -1;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+// Index the documents at indices on one shard. Outside a batch (own) they
+// go into a transaction of their own that the caller commits or cancels;
+// when deferred it is unflushed, so committing it writes nothing to disk.
+// Caller holds shard.write_mutex. Returns an error message, empty on success.
+static std::string index_on_shard(XapianDatabase* wrapper, Shard& shard, bool own,
+                                  bool deferred, const XapianDocument* docs,
+                                  const std::vector<int>& indices) {
+    try {
+        if (own) {
+            shard.db.begin_transaction(!deferred);
+            if (!deferred) {
+                // A flushed transaction commits changes pending before it
+                shard.pending = 0;
+            }
+        }
+
+        std::string chunk_id;
+        std::string doc_id;
+        std::string content;
+        for (int i : indices) {
+            const XapianDocument& d = docs[i];
+            chunk_id.assign(d.chunk_id, d.chunk_id_len);
+            if (d.doc_id != nullptr) {
+                doc_id.assign(d.doc_id, d.doc_id_len);
+            }
+            content.assign(d.content != nullptr ? d.content : "", d.content_len);
+            index_document(shard, chunk_id, d.doc_id != nullptr ? &doc_id : nullptr, content);
+            if (!own) {
+                commit_change(wrapper, shard);
+            }
+        }
+        return std::string();
+    } catch (const Xapian::Error& e) {
+        return e.get_description();
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+}
+
+int xapian_index_batch(xapian_db db, const XapianDocument* docs, int n) {
+    if (db == nullptr || (docs == nullptr && n > 0) || n < 0) {
+        last_error = "invalid arguments: db and docs must not be null";
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        if (docs[i].chunk_id == nullptr || (docs[i].content == nullptr && docs[i].content_len > 0)) {
+            last_error = "invalid arguments: chunk_id and content must not be null";
+            return -1;
+        }
+    }
+    if (n == 0) {
+        last_error.clear();
+        return 0;
+    }
+
+    XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+
+    // Route documents to shards and lock the shards involved, in order
+    std::vector<std::vector<int>> groups(wrapper->shards.size());
+    for (int i = 0; i < n; i++) {
+        groups[wrapper->shard_index(docs[i].chunk_id, docs[i].chunk_id_len)].push_back(i);
+    }
+    std::vector<size_t> involved;
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for (size_t k = 0; k < groups.size(); k++) {
+        if (!groups[k].empty()) {
+            involved.push_back(k);
+            locks.emplace_back(wrapper->shards[k]->write_mutex);
+        }
+    }
+
+    // Outside a batch the call is its own transaction on each shard, so it
+    // commits once per shard and either all documents land or none do (short
+    // of a commit failing after another shard committed)
+    std::vector<bool> own(involved.size());
+    for (size_t j = 0; j < involved.size(); j++) {
+        own[j] = !wrapper->shards[involved[j]]->in_batch;
+    }
+    const bool deferred = wrapper->flusher.active.load();
+
+    // Shards are independent databases, so they are indexed in parallel
+    std::vector<std::string> errors(involved.size());
+    auto index_group = [&](size_t j) {
+        errors[j] = index_on_shard(wrapper, *wrapper->shards[involved[j]], own[j], deferred,
+                                   docs, groups[involved[j]]);
+    };
+    std::vector<std::thread> workers;
+    try {
+        for (size_t j = 1; j < involved.size(); j++) {
+            workers.emplace_back(index_group, j);
+        }
+    } catch (const std::system_error&) {
+        // Could not start a thread: index the remaining shards inline
+        for (size_t j = workers.size() + 1; j < involved.size(); j++) {
+            index_group(j);
+        }
+    }
+    index_group(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::string error;
+    for (const std::string& e : errors) {
+        if (!e.empty()) {
+            error = e;
+            break;
+        }
+    }
+
+    for (size_t j = 0; j < involved.size(); j++) {
+        if (!own[j]) {
+            continue;
+        }
+        Shard& shard = *wrapper->shards[involved[j]];
+        try {
+            if (error.empty()) {
+                Clock::time_point start = Clock::now();
+                shard.db.commit_transaction();
+                if (deferred) {
+                    defer_changes(wrapper, shard, static_cast<int>(groups[involved[j]].size()));
+                } else {
+                    committed(wrapper, start);
+                }
+            } else {
+                shard.db.cancel_transaction();
+            }
+        } catch (const Xapian::Error& e) {
+            // Xapian ends the transaction even when the commit fails
+            if (error.empty()) {
+                error = e.get_description();
+            }
+        } catch (const std::exception& e) {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+
+    if (!error.empty()) {
+        last_error = error;
+        return -1;
+    }
+    last_error.clear();
+    return 0;
+}
+
+int xapian_delete(xapian_db db, const char* chunk_id) {
+    if (db == nullptr || chunk_id == nullptr) {
+        last_error = "invalid arguments: db and chunk_id must not be null";
+        return -1;
+    }
+
+    try {
+        XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+        Shard& shard = wrapper->shard_for(chunk_id);
+        std::lock_guard<std::mutex> lock(shard.write_mutex);
+
+        std::string id_term = "Q" + std::string(chunk_id);
+        shard.db.delete_document(id_term);
+        commit_change(wrapper, shard);
+
+        last_error.clear();
+        return 0;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return -1;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+int xapian_begin_batch(xapian_db db, int max_changes) {
+    if (db == nullptr || max_changes < 0) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+    std::lock_guard<std::mutex> batch_lock(wrapper->batch_mutex);
+    if (wrapper->batch_depth > 0) {
+        wrapper->batch_depth++;
+        last_error.clear();
+        return 0;
+    }
+
+    size_t started = 0;
+    try {
+        for (; started < wrapper->shards.size(); started++) {
+            Shard& shard = *wrapper->shards[started];
+            std::lock_guard<std::mutex> lock(shard.write_mutex);
+            // A flushed transaction is committed to disk atomically as a
+            // whole, after the changes pending before it
+            shard.db.begin_transaction(true);
+            if (shard.pending > 0) {
+                shard.pending = 0;
+                committed(wrapper);
+            }
+            shard.in_batch = true;
+            shard.batch_changes = 0;
+            shard.batch_limit = max_changes;
+        }
+        wrapper->batch_depth = 1;
+
+        last_error.clear();
+        return 0;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+    } catch (const std::exception& e) {
+        last_error = e.what();
+    }
+
+    // Undo the shards already started; nothing was written to them yet
+    for (size_t k = 0; k < started; k++) {
+        Shard& shard = *wrapper->shards[k];
+        std::lock_guard<std::mutex> lock(shard.write_mutex);
+        shard.in_batch = false;
+        try {
+            shard.db.cancel_transaction();
+        } catch (...) {
+            // Nothing to undo
+        }
+    }
     return -1;
 }
 
-void xapian_free_results(XapianSearchResult* results, int count) {
-    (void)results;
-    (void)count;
+int xapian_commit_batch(xapian_db db) {
+    if (db == nullptr) {
+        last_error = "invalid arguments: db must not be null";
+        return -1;
+    }
+
+    XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+    std::lock_guard<std::mutex> batch_lock(wrapper->batch_mutex);
+    if (wrapper->batch_depth == 0) {
+        last_error = "no batch in progress";
+        return -1;
+    }
+    if (--wrapper->batch_depth > 0) {
+        last_error.clear();
+        return 0;
+    }
+    wrapper->batch_idle.notify_all();
+
+    // Commit every shard even if one fails; Xapian ends the transaction
+    // either way
+    std::string error;
+    for (auto& shard : wrapper->shards) {
+        std::lock_guard<std::mutex> lock(shard->write_mutex);
+        if (!shard->in_batch) {
+            continue;
+        }
+        shard->in_batch = false;
+        try {
+            Clock::time_point start = Clock::now();
+            shard->db.commit_transaction();
+            committed(wrapper, start);
+        } catch (const Xapian::Error& e) {
+            if (error.empty()) {
+                error = e.get_description();
+            }
+        } catch (const std::exception& e) {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+
+    if (!error.empty()) {
+        last_error = error;
+        return -1;
+    }
+    last_error.clear();
+    return 0;
+}
+
+int xapian_cancel_batch(xapian_db db) {
+    if (db == nullptr) {
+        last_error = "invalid arguments: db must not be null";
+        return -1;
+    }
+
+    XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+    std::lock_guard<std::mutex> batch_lock(wrapper->batch_mutex);
+    if (wrapper->batch_depth == 0) {
+        last_error = "no batch in progress";
+        return -1;
+    }
+
+    wrapper->batch_depth = 0;
+    wrapper->batch_idle.notify_all();
+    std::string error;
+    for (auto& shard : wrapper->shards) {
+        std::lock_guard<std::mutex> lock(shard->write_mutex);
+        if (!shard->in_batch) {
+            continue;
+        }
+        shard->in_batch = false;
+        try {
+            shard->db.cancel_transaction();
+        } catch (const Xapian::Error& e) {
+            if (error.empty()) {
+                error = e.get_description();
+            }
+        } catch (const std::exception& e) {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+
+    if (!error.empty()) {
+        last_error = error;
+        return -1;
+    }
+    last_error.clear();
+    return 0;
+}
+
+int xapian_set_background_flush(xapian_db db, const XapianFlushOptions* opts) {
+    if (db == nullptr || (opts != nullptr && (opts->interval_ms < 0 || opts->max_pending < 0))) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+    Flusher& flusher = wrapper->flusher;
+    std::lock_guard<std::mutex> control_lock(flusher.control_mutex);
+    std::string error = stop_flusher(wrapper);
+    if (opts != nullptr) {
+        flusher.interval_ms.store(opts->interval_ms > 0 ? opts->interval_ms : 1000);
+        flusher.max_pending.store(opts->max_pending > 0 ? opts->max_pending : 1000);
+        try {
+            flusher.thread = std::thread(flush_loop, wrapper);
+            flusher.active.store(true);
+        } catch (const std::system_error& e) {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+
+    if (!error.empty()) {
+        last_error = error;
+        return -1;
+    }
+    last_error.clear();
+    return 0;
+}
+
+int xapian_flush(xapian_db db) {
+    if (db == nullptr) {
+        last_error = "invalid arguments: db must not be null";
+        return -1;
+    }
+
+    std::string error = commit_all_pending(static_cast<XapianDatabase*>(db));
+    if (!error.empty()) {
+        last_error = error;
+        return -1;
+    }
+    last_error.clear();
+    return 0;
+}
+
+int xapian_compact(xapian_db db, const char* target_path, const XapianCompactOptions* opts,
+                   XapianCompactStats* stats) {
+    if (db == nullptr || (opts != nullptr && (opts->level < 0 || opts->level > 2 ||
+                                              opts->block_size < 0))) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+    try {
+        uint64_t before = 0;
+        uint64_t after = 0;
+
+        if (target_path != nullptr) {
+            // A copy of the committed state; the live database is untouched
+            std::string target = target_path;
+            if (!is_empty_dir(target)) {
+                last_error = "target is not empty: " + target;
+                return -1;
+            }
+            bool sharded = read_shard_count(wrapper->path) > 0;
+            if (sharded && ::mkdir(target.c_str(), 0700) != 0 && errno != EEXIST) {
+                last_error = "cannot create " + target + ": " + std::strerror(errno);
+                return -1;
+            }
+            for (size_t k = 0; k < wrapper->shards.size(); k++) {
+                Shard& shard = *wrapper->shards[k];
+                std::string out = sharded ? shard_path(target, static_cast<int>(k)) : target;
+                std::lock_guard<std::mutex> lock(shard.write_mutex);
+                commit_pending(wrapper, shard);
+                before += tree_size(shard.path);
+                compact_shard(shard, out, opts);
+                after += tree_size(out);
+            }
+            if (sharded) {
+                write_shard_count(target, static_cast<int>(wrapper->shards.size()));
+            }
+        } else {
+            // In place: wait for a running batch to finish, and keep new ones
+            // from starting until every shard is swapped
+            std::unique_lock<std::mutex> batch_lock(wrapper->batch_mutex);
+            wrapper->batch_idle.wait(batch_lock, [&] { return wrapper->batch_depth == 0; });
+            for (auto& shard : wrapper->shards) {
+                std::lock_guard<std::mutex> lock(shard->write_mutex);
+                commit_pending(wrapper, *shard);
+                before += tree_size(shard->path);
+                compact_shard_in_place(wrapper, *shard, opts);
+                after += tree_size(shard->path);
+            }
+        }
+
+        if (stats != nullptr) {
+            stats->bytes_before = before;
+            stats->bytes_after = after;
+        }
+        last_error.clear();
+        return 0;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return -1;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+// Helper: ranked hits for a query (with snippets when snippet_opts is set),
+// answered from the result cache when the same search ran since the last
+// commit
+static void cached_search(XapianDatabase* wrapper, const char* query_str, int limit,
+                          Hits* hits, const XapianSnippetOptions* snippet_opts = nullptr,
+                          Snippets* snippets = nullptr) {
+    Clock::time_point start = Clock::now();
+    int per_document = wrapper->per_document.load(std::memory_order_relaxed);
+    std::string key = cache_key(query_str, limit, per_document, snippet_opts);
+    if (!wrapper->cache.lookup(key, wrapper->generation.load(std::memory_order_acquire), hits,
+                               snippets)) {
+        // Search on a pooled read-only handle so concurrent searches and
+        // indexing do not contend for the writer
+        ReaderLease reader(wrapper);
+        run_search(reader, query_str, limit, per_document, hits, snippet_opts, snippets);
+        wrapper->cache.insert(key, reader.generation(), *hits, snippets);
+    }
+    wrapper->searches.add(nanos_since(start));
+}
+
+SearchResults xapian_search(xapian_db db, const char* query_str, int limit) {
+    SearchResults results = {nullptr, 0};
+
+    if (db == nullptr || query_str == nullptr || limit <= 0) {
+        last_error = "invalid arguments";
+        return results;
+    }
+
+    try {
+        XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+
+        Hits hits;
+        cached_search(wrapper, query_str, limit, &hits);
+
+        if (hits.empty()) {
+            last_error.clear();
+            return results;
+        }
+
+        if (!to_results(hits, nullptr, &results)) {
+            last_error = "memory allocation failed";
+            return results;
+        }
+
+        last_error.clear();
+        return results;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return results;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return results;
+    }
+}
+
+// Helper: pack hits into a caller-owned buffer. Returns the hit count, or
+// XAPIAN_ERR_BUFFER_TOO_SMALL with buf->ids_size set to the bytes needed.
+static int pack_hits(const Hits& hits, XapianResultBuffer* buf) {
+    size_t needed = 0;
+    for (const auto& hit : hits) {
+        needed += hit.first.size();
+    }
+    buf->ids_size = needed;
+    if (hits.size() > static_cast<size_t>(buf->capacity) || needed > buf->ids_capacity ||
+        needed > UINT32_MAX) {
+        return XAPIAN_ERR_BUFFER_TOO_SMALL;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < hits.size(); i++) {
+        const std::string& chunk_id = hits[i].first;
+        buf->id_offsets[i] = static_cast<uint32_t>(pos);
+        buf->scores[i] = hits[i].second;
+        if (!chunk_id.empty()) {
+            std::memcpy(buf->ids + pos, chunk_id.data(), chunk_id.size());
+        }
+        pos += chunk_id.size();
+    }
+    buf->id_offsets[hits.size()] = static_cast<uint32_t>(pos);
+    return static_cast<int>(hits.size());
+}
+
+int xapian_search_into(xapian_db db, const char* query_str, int limit, XapianResultBuffer* buf) {
+    if (db == nullptr || query_str == nullptr || buf == nullptr || limit <= 0 ||
+        limit > buf->capacity || buf->scores == nullptr || buf->id_offsets == nullptr ||
+        (buf->ids == nullptr && buf->ids_capacity > 0)) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    try {
+        XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+        Clock::time_point start = Clock::now();
+        int per_document = wrapper->per_document.load(std::memory_order_relaxed);
+
+        // Key and hits scratch are reused by every search on this thread
+        thread_local std::string key;
+        cache_key_into(query_str, limit, per_document, &key);
+
+        // A cached answer is packed straight from the cache entry
+        int count = 0;
+        if (!wrapper->cache.visit(key, wrapper->generation.load(std::memory_order_acquire),
+                                  [&](const CachedResult& result) {
+                                      count = pack_hits(result.hits, buf);
+                                  })) {
+            thread_local Hits hits;
+            ReaderLease reader(wrapper);
+            run_search(reader, query_str, limit, per_document, &hits);
+            wrapper->cache.insert(key, reader.generation(), hits);
+            count = pack_hits(hits, buf);
+        }
+
+        if (count == XAPIAN_ERR_BUFFER_TOO_SMALL) {
+            // Not recorded: the caller retries with a larger buffer
+            last_error = "result buffer too small";
+            return count;
+        }
+
+        wrapper->searches.add(nanos_since(start));
+        last_error.clear();
+        return count;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return -1;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+int xapian_search_visit(xapian_db db, const char* query_str, int limit,
+                        xapian_hit_visitor visit, void* ctx) {
+    if (db == nullptr || query_str == nullptr || limit <= 0 || visit == nullptr) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    try {
+        Hits hits;
+        cached_search(static_cast<XapianDatabase*>(db), query_str, limit, &hits);
+
+        for (const auto& hit : hits) {
+            visit(ctx, hit.first.data(), hit.first.size(), hit.second);
+        }
+
+        last_error.clear();
+        return static_cast<int>(hits.size());
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return -1;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+SearchResults xapian_search_snippets(xapian_db db, const char* query_str, int limit,
+                                     const XapianSnippetOptions* opts) {
+    SearchResults results = {nullptr, 0};
+
+    if (db == nullptr || query_str == nullptr || limit <= 0 || opts == nullptr) {
+        last_error = "invalid arguments";
+        return results;
+    }
+
+    try {
+        // Snippets are built from the live MSet on a miss and cached with
+        // the hits, so a repeated search skips both
+        Hits hits;
+        Snippets snippets;
+        cached_search(static_cast<XapianDatabase*>(db), query_str, limit, &hits, opts,
+                      &snippets);
+
+        if (hits.empty()) {
+            last_error.clear();
+            return results;
+        }
+
+        if (!to_results(hits, &snippets, &results)) {
+            last_error = "memory allocation failed";
+            return results;
+        }
+
+        last_error.clear();
+        return results;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return results;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return results;
+    }
+}
+
+void xapian_free_results(SearchResults results) {
+    if (results.results != nullptr) {
+        for (int i = 0; i < results.count; ++i) {
+            free(results.results[i].chunk_id);
+            free(results.results[i].snippet);
+        }
+        free(results.results);
+    }
+}
+
+int xapian_set_cache_size(xapian_db db, int capacity) {
+    if (db == nullptr || capacity < 0) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    try {
+        static_cast<XapianDatabase*>(db)->cache.set_capacity(static_cast<size_t>(capacity));
+        last_error.clear();
+        return 0;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+int xapian_set_collapse(xapian_db db, int max_per_document) {
+    if (db == nullptr || max_per_document < 0) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    static_cast<XapianDatabase*>(db)->per_document.store(max_per_document,
+                                                         std::memory_order_relaxed);
+    last_error.clear();
+    return 0;
+}
+
+int xapian_cache_stats(xapian_db db, XapianCacheStats* stats) {
+    if (db == nullptr || stats == nullptr) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    *stats = static_cast<XapianDatabase*>(db)->cache.stats();
+    last_error.clear();
+    return 0;
+}
+
+int xapian_stats(xapian_db db, XapianStats* stats) {
+    if (db == nullptr || stats == nullptr) {
+        last_error = "invalid arguments";
+        return -1;
+    }
+
+    try {
+        XapianDatabase* wrapper = static_cast<XapianDatabase*>(db);
+        *stats = XapianStats{};
+        {
+            // The writer's count would include uncommitted changes
+            ReaderLease reader(wrapper);
+            stats->documents = reader.db().get_doccount();
+        }
+        for (auto& shard : wrapper->shards) {
+            std::lock_guard<std::mutex> lock(shard->write_mutex);
+            stats->revision += shard->db.get_revision();
+            stats->pending_changes += static_cast<uint64_t>(shard->pending);
+        }
+        stats->commits = wrapper->commits.count.load(std::memory_order_relaxed);
+        stats->commit_ns = wrapper->commits.total_ns.load(std::memory_order_relaxed);
+        wrapper->commits.histogram_us.copy_to(stats->commit_histogram);
+        stats->searches = wrapper->searches.count.load(std::memory_order_relaxed);
+        stats->search_ns = wrapper->searches.total_ns.load(std::memory_order_relaxed);
+        wrapper->searches.histogram_us.copy_to(stats->search_histogram);
+        last_error.clear();
+        return 0;
+    } catch (const Xapian::Error& e) {
+        last_error = e.get_description();
+        return -1;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return -1;
+    }
 }
 
-void xapian_close(XapianDatabase* db) {
-    (void)db;
+const char* xapian_get_error(void) {
+    return last_error.c_str();
 }
 
 } // extern "C"
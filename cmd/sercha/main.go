@@ -5,6 +5,8 @@ import (
 	"os"
 	"path/filepath"
 
+	"github.com/custodia-labs/sercha-cli/cgo/hnsw"
+	"github.com/custodia-labs/sercha-cli/cgo/hybrid"
 	"github.com/custodia-labs/sercha-cli/cgo/xapian"
 	"github.com/custodia-labs/sercha-cli/internal/adapters/driven/ai"
 	"github.com/custodia-labs/sercha-cli/internal/adapters/driven/auth"
@@ -138,12 +140,17 @@ func run() int {
 	// Set optional stores for SourceName enrichment in search results
 	searchSvc.SetSourceStore(sourceStore)
 	searchSvc.SetCredentialsStore(credentialsStore)
+	// Fuse hybrid searches natively when both indexes are native
+	if vectorIndex, ok := aiResult.VectorIndex.(*hnsw.Index); ok {
+		searchSvc.SetHybridSearcher(hybrid.New(searchEngine, vectorIndex))
+	}
 
 	sourceSvc := services.NewSourceService(sourceStore, syncStore, docStore)
 
 	// Create connector registry (needed before sourceSvc.SetConnectorRegistry)
 	connectorRegistry := services.NewConnectorRegistry(connectorFactory)
 	sourceSvc.SetConnectorRegistry(connectorRegistry)
+	sourceSvc.SetVectorIndex(aiResult.VectorIndex)
 
 	// Create provider registry (depends on connectorRegistry and connectorFactory)
 	providerRegistry := services.NewProviderRegistry(connectorRegistry, connectorFactory)
@@ -162,6 +169,7 @@ func run() int {
 		schedulerStore,
 		syncSvc,
 	)
+	scheduler.SetSearchEngine(searchEngine)
 
 	// Inject services into CLI commands
 	cli.SetServices(&cli.Services{
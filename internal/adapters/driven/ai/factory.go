@@ -3,6 +3,7 @@ package ai
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"time"
 
@@ -287,7 +288,8 @@ func InitialiseServices(settings *domain.AppSettings, vectorPath string) (*InitR
 		logger.Debug("Creating vector index: path=%s, dims=%d, precision=%v",
 			vectorPath, result.EmbeddingService.Dimensions(), precision)
 
-		idx, err := hnsw.New(vectorPath, result.EmbeddingService.Dimensions(), precision)
+		idx, err := openVectorIndex(&settings.VectorIndex, vectorPath,
+			result.EmbeddingService.Dimensions(), precision)
 		if err != nil {
 			logger.Warn("Vector index failed: %v", err)
 			result.Warnings = append(result.Warnings,
@@ -318,6 +320,41 @@ func InitialiseServices(settings *domain.AppSettings, vectorPath string) (*InitR
 	return result, nil
 }
 
+// openVectorIndex opens the vector index at path: one index per source when
+// partitioned, otherwise a single index for all sources.
+func openVectorIndex(
+	settings *domain.VectorIndexSettings, path string, dimensions int, precision hnsw.Precision,
+) (driven.VectorIndex, error) {
+	opts := hnsw.Options{
+		M:              settings.M,
+		EfConstruction: settings.EfConstruction,
+		EfSearch:       settings.EfSearch,
+	}
+	if settings.Partitioned {
+		logger.Debug("Vector index layout: one partition per source")
+		idx, err := hnsw.NewPartitioned(path, dimensions, precision, opts)
+		if err != nil {
+			return nil, layoutError(err, path)
+		}
+		return idx, nil
+	}
+	idx, err := hnsw.NewWithOptions(path, dimensions, precision, opts)
+	if err != nil {
+		return nil, layoutError(err, path)
+	}
+	return idx, nil
+}
+
+// layoutError explains how to recover from a vector_index.partitioned change
+// that was refused because the index exists in the other layout.
+func layoutError(err error, path string) error {
+	if errors.Is(err, hnsw.ErrLayoutMismatch) {
+		return fmt.Errorf("%w; set vector_index.partitioned back, or remove %s and sync every source",
+			err, path)
+	}
+	return err
+}
+
 // initLLMService creates and configures the LLM service, updating result accordingly.
 func initLLMService(result *InitResult, settings *domain.LLMSettings) {
 	svc, err := CreateLLMService(settings)
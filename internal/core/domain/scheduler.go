@@ -90,12 +90,17 @@ func DefaultSchedulerConfig() SchedulerConfig {
 				Enabled:  true,
 				Interval: 1 * time.Hour,
 			},
+			"search-compact": {
+				Enabled:  true,
+				Interval: 24 * time.Hour,
+			},
 		},
 	}
 }
 
 // Task IDs for built-in tasks.
 const (
-	TaskIDOAuthRefresh = "oauth-refresh"
-	TaskIDDocumentSync = "document-sync"
+	TaskIDOAuthRefresh  = "oauth-refresh"
+	TaskIDDocumentSync  = "document-sync"
+	TaskIDSearchCompact = "search-compact"
 )
@@ -12,7 +12,7 @@ func TestDefaultSchedulerConfig(t *testing.T) {
 
 	assert.True(t, config.Enabled)
 	assert.NotNil(t, config.TaskConfigs)
-	assert.Len(t, config.TaskConfigs, 2)
+	assert.Len(t, config.TaskConfigs, 3)
 
 	// OAuth refresh config
 	oauthCfg := config.TaskConfigs[TaskIDOAuthRefresh]
@@ -23,6 +23,11 @@ func TestDefaultSchedulerConfig(t *testing.T) {
 	docCfg := config.TaskConfigs[TaskIDDocumentSync]
 	assert.True(t, docCfg.Enabled)
 	assert.Equal(t, 1*time.Hour, docCfg.Interval)
+
+	// Search index compaction config
+	compactCfg := config.TaskConfigs[TaskIDSearchCompact]
+	assert.True(t, compactCfg.Enabled)
+	assert.Equal(t, 24*time.Hour, compactCfg.Interval)
 }
 
 func TestSchedulerConfig_GetTaskConfig(t *testing.T) {
@@ -53,6 +58,7 @@ func TestSchedulerConfig_GetTaskConfig_NilMap(t *testing.T) {
 func TestTaskConstants(t *testing.T) {
 	assert.Equal(t, "oauth-refresh", TaskIDOAuthRefresh)
 	assert.Equal(t, "document-sync", TaskIDDocumentSync)
+	assert.Equal(t, "search-compact", TaskIDSearchCompact)
 }
 
 func TestScheduledTask_Fields(t *testing.T) {
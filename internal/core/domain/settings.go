@@ -228,6 +228,27 @@ type VectorIndexSettings struct {
 	// Precision is the storage precision for vectors.
 	// Default is float16 (best balance of size vs quality).
 	Precision VectorPrecision
+
+	// M is the number of graph connections per vector. Higher values improve
+	// recall at the cost of memory. Only applies when the index is created.
+	M int
+
+	// EfConstruction is the beam width used while building the graph.
+	// Higher values build a better graph more slowly. Only applies when the
+	// index is created.
+	EfConstruction int
+
+	// EfSearch is the search beam width. Higher values improve recall at
+	// the cost of latency.
+	EfSearch int
+
+	// Partitioned keeps each source's vectors in an index of its own, so
+	// source-filtered searches only traverse the selected sources and
+	// removing a source deletes its files. A change is refused while vectors
+	// exist in the other layout: the vector index stays unavailable until
+	// the setting is switched back or the index is removed and every source
+	// synced again.
+	Partitioned bool
 }
 
 // AppSettings holds all application settings.
@@ -258,9 +279,12 @@ func DefaultAppSettings() AppSettings {
 		// LLM is left unconfigured - user must set up via settings wizard
 		LLM: LLMSettings{},
 		VectorIndex: VectorIndexSettings{
-			Enabled:    false,
-			Dimensions: 768,                    // nomic-embed-text default
-			Precision:  VectorPrecisionFloat16, // Best balance of size vs quality
+			Enabled:        false,
+			Dimensions:     768,                    // nomic-embed-text default
+			Precision:      VectorPrecisionFloat16, // Best balance of size vs quality
+			M:              16,
+			EfConstruction: 200,
+			EfSearch:       50,
 		},
 	}
 }
@@ -22,6 +22,117 @@ type SearchEngine interface {
 	Close() error
 }
 
+// BatchSearchEngine is an optional interface for search engines that can
+// group many Index and Delete calls into one transaction, committed once
+// instead of per call. A crash before CommitBatch leaves the index as it was
+// when the batch began (or at its last intermediate commit). Batches nest.
+// Callers should type-assert; engines without it commit every call.
+type BatchSearchEngine interface {
+	// BeginBatch starts grouping writes into a transaction.
+	BeginBatch(ctx context.Context) error
+
+	// CommitBatch ends the batch, committing it if it is the outermost one.
+	CommitBatch(ctx context.Context) error
+
+	// IndexBatch adds or updates many chunks in one call. Outside a batch
+	// the chunks are committed together, all or none.
+	IndexBatch(ctx context.Context, chunks []domain.Chunk) error
+}
+
+// SnippetSearchEngine is an optional interface for search engines that can
+// build highlighted snippets of the matched chunks while searching, saving
+// callers a content lookup per result. Callers should type-assert.
+type SnippetSearchEngine interface {
+	// SearchWithSnippets is Search, with SearchHit.Snippet set for the
+	// first opts.TopN hits.
+	SearchWithSnippets(ctx context.Context, query string, limit int, opts SnippetOptions) ([]SearchHit, error)
+}
+
+// CollapsingSearchEngine is an optional interface for search engines that
+// return at most a few chunks per parent document, so results are diverse
+// without post-filtering. Callers should type-assert.
+type CollapsingSearchEngine interface {
+	// MaxHitsPerDocument returns the per-document cap on hits (0 = none).
+	MaxHitsPerDocument() int
+}
+
+// CompactableSearchEngine is an optional interface for search engines whose
+// index fragments under update churn and can be rewritten compactly while it
+// stays open. Searches keep working during compaction; writes may wait.
+// Callers should type-assert.
+type CompactableSearchEngine interface {
+	// Compact rewrites the index in place.
+	Compact(ctx context.Context) (CompactionStats, error)
+}
+
+// CompactionStats reports the index size around a compaction.
+type CompactionStats struct {
+	BytesBefore int64
+	BytesAfter  int64
+}
+
+// HybridSearcher is an optional capability for backends that run keyword and
+// vector retrieval concurrently and fuse the two rankings natively, in one
+// call and without materialising either list. Callers should type-assert or
+// accept it separately; without it, hybrid searches are fused by the caller.
+type HybridSearcher interface {
+	// HybridSearch searches query against the keyword index and embedding
+	// against the vector index and returns the fused ranking, best first,
+	// with each chunk at most once.
+	HybridSearch(ctx context.Context, query string, embedding []float32, opts HybridSearchOptions) ([]SearchHit, error)
+}
+
+// FusionMethod selects how a HybridSearcher combines the two rankings.
+type FusionMethod int
+
+const (
+	// FusionRRF scores a chunk by reciprocal rank fusion: the sum of
+	// weight/(RRFK + rank) over the rankings it appears in.
+	FusionRRF FusionMethod = iota
+
+	// FusionWeighted scores a chunk by the weighted sum of its keyword score
+	// (scaled by the best keyword score) and its vector similarity.
+	FusionWeighted
+)
+
+// HybridSearchOptions controls a fused hybrid search.
+type HybridSearchOptions struct {
+	// KeywordLimit and VectorLimit are the candidates taken from each index.
+	KeywordLimit int
+	VectorLimit  int
+
+	// Limit caps the fused results (0 = all candidates).
+	Limit int
+
+	// Fusion selects the scoring (default FusionRRF).
+	Fusion FusionMethod
+
+	// RRFK is the reciprocal rank fusion constant (0 = 60).
+	RRFK int
+
+	// KeywordWeight and VectorWeight scale each ranking's contribution
+	// (0 = 1).
+	KeywordWeight float64
+	VectorWeight  float64
+
+	// Filter restricts the vector candidates (nil = no filter).
+	Filter *VectorFilter
+}
+
+// SnippetOptions controls snippet generation.
+type SnippetOptions struct {
+	// Length is the maximum snippet length in bytes (0 = engine default).
+	Length int
+
+	// TopN limits snippets to the best TopN hits (0 = all hits).
+	TopN int
+
+	// HighlightStart and HighlightEnd surround each matched term
+	// (empty = no markup).
+	HighlightStart string
+	HighlightEnd   string
+}
+
 // SearchHit represents a search result from the engine.
 type SearchHit struct {
 	// ChunkID is the matched chunk.
@@ -29,4 +140,8 @@ type SearchHit struct {
 
 	// Score is the relevance score (e.g., BM25).
 	Score float64
+
+	// Snippet is a highlighted excerpt of the chunk, empty unless requested
+	// through SnippetSearchEngine.
+	Snippet string
 }
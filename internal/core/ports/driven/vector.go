@@ -18,6 +18,65 @@ type VectorIndex interface {
 	Close() error
 }
 
+// BatchVectorIndex is an optional interface for vector indexes that can insert
+// many vectors in one call. Callers should type-assert and fall back to Add.
+type BatchVectorIndex interface {
+	// AddBatch inserts vectors for the given chunk IDs.
+	// chunkIDs and embeddings must have the same length.
+	AddBatch(ctx context.Context, chunkIDs []string, embeddings [][]float32) error
+}
+
+// FilterableVectorIndex is an optional interface for vector indexes that
+// store per-vector attributes and filter on them during the search itself,
+// so a filtered search returns k eligible hits without over-fetching.
+// Callers should type-assert and fall back to Search plus post-filtering.
+type FilterableVectorIndex interface {
+	// AddBatchWithAttributes inserts vectors with their filter attributes.
+	// chunkIDs, embeddings and attrs must have the same length.
+	AddBatchWithAttributes(
+		ctx context.Context, chunkIDs []string, embeddings [][]float32, attrs []VectorAttributes,
+	) error
+
+	// SearchFiltered finds the k nearest neighbours that pass the filter.
+	SearchFiltered(ctx context.Context, query []float32, k int, filter VectorFilter) ([]VectorHit, error)
+}
+
+// PartitionedVectorIndex is an optional interface for vector indexes that
+// keep each source's vectors in a partition of their own, so a source can be
+// dropped as a whole instead of deleting its vectors one by one.
+type PartitionedVectorIndex interface {
+	// DropSource removes every vector of the source.
+	DropSource(ctx context.Context, sourceID string) error
+
+	// DeleteFromSource removes a vector stored for the source, touching only
+	// that source's partition. Prefer it to Delete when the source is known.
+	DeleteFromSource(ctx context.Context, sourceID, chunkID string) error
+}
+
+// VectorAttributes are the filterable attributes stored with a vector.
+type VectorAttributes struct {
+	// SourceID is the source the chunk was synced from.
+	SourceID string
+
+	// DocumentID is the parent document of the chunk.
+	DocumentID string
+}
+
+// VectorFilter restricts a vector search by attribute.
+type VectorFilter struct {
+	// SourceIDs limits results to these sources (empty means any source).
+	// Vectors stored without a source, such as those indexed before sources
+	// were recorded, still pass, so callers check the sources of the hits.
+	SourceIDs []string
+
+	// DocumentIDs limits results to these documents (empty means any document).
+	DocumentIDs []string
+
+	// Exclude inverts the filter: vectors whose source or document is listed
+	// are rejected and all others pass.
+	Exclude bool
+}
+
 // VectorHit represents a similarity search result.
 type VectorHit struct {
 	// ChunkID is the matched chunk.
@@ -14,9 +14,10 @@ import (
 // Scheduler manages background task execution.
 // It is a pure core service with no external control API.
 type Scheduler struct {
-	config   domain.SchedulerConfig
-	store    driven.SchedulerStore
-	syncOrch driving.SyncOrchestrator
+	config       domain.SchedulerConfig
+	store        driven.SchedulerStore
+	syncOrch     driving.SyncOrchestrator
+	searchEngine driven.SearchEngine
 
 	mu      sync.Mutex
 	running bool
@@ -37,6 +38,13 @@ func NewScheduler(
 	}
 }
 
+// SetSearchEngine sets the search engine maintained by the search index
+// compaction task. Optional: the task only runs for engines that support
+// compaction (driven.CompactableSearchEngine).
+func (s *Scheduler) SetSearchEngine(engine driven.SearchEngine) {
+	s.searchEngine = engine
+}
+
 // Start begins the scheduler loop. This method blocks until Stop is called.
 func (s *Scheduler) Start(ctx context.Context) error {
 	s.mu.Lock()
@@ -83,6 +91,15 @@ func (s *Scheduler) initialiseTasks(ctx context.Context) error {
 		}
 	}
 
+	// Search index compaction task
+	if _, ok := s.searchEngine.(driven.CompactableSearchEngine); ok {
+		if taskCfg := s.config.GetTaskConfig(domain.TaskIDSearchCompact); taskCfg.Enabled {
+			if err := s.ensureTask(ctx, domain.TaskIDSearchCompact, "Search Index Compaction", taskCfg); err != nil {
+				return err
+			}
+		}
+	}
+
 	return nil
 }
 
@@ -171,6 +188,8 @@ func (s *Scheduler) runTask(ctx context.Context, task *domain.ScheduledTask) {
 		switch task.ID {
 		case domain.TaskIDDocumentSync:
 			result.ItemsProcessed, err = s.runDocumentSync(ctx)
+		case domain.TaskIDSearchCompact:
+			result.ItemsProcessed, err = s.runSearchCompaction(ctx)
 		default:
 			log.Printf("scheduler: unknown task ID: %s", task.ID)
 			return
@@ -221,3 +240,21 @@ func (s *Scheduler) runDocumentSync(ctx context.Context) (int, error) {
 	err := s.syncOrch.SyncAll(ctx)
 	return 0, err
 }
+
+// runSearchCompaction compacts the search index in place, reclaiming the
+// space that re-syncs leave behind so search I/O does not grow over time.
+//
+//nolint:unparam // compaction has no item count
+func (s *Scheduler) runSearchCompaction(ctx context.Context) (int, error) {
+	compactable, ok := s.searchEngine.(driven.CompactableSearchEngine)
+	if !ok {
+		return 0, nil
+	}
+
+	stats, err := compactable.Compact(ctx)
+	if err != nil {
+		return 0, err
+	}
+	log.Printf("scheduler: compacted search index from %d to %d bytes", stats.BytesBefore, stats.BytesAfter)
+	return 0, nil
+}
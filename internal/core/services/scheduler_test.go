@@ -126,6 +126,21 @@ func (m *mockSyncOrchestrator) Status(_ context.Context, _ string) (*driving.Syn
 	return &driving.SyncStatus{}, nil
 }
 
+// mockCompactableSearchEngine implements driven.CompactableSearchEngine for testing.
+type mockCompactableSearchEngine struct {
+	mockSearchEngine
+	compactCalls int
+	compactErr   error
+}
+
+func (m *mockCompactableSearchEngine) Compact(_ context.Context) (driven.CompactionStats, error) {
+	m.compactCalls++
+	if m.compactErr != nil {
+		return driven.CompactionStats{}, m.compactErr
+	}
+	return driven.CompactionStats{BytesBefore: 2048, BytesAfter: 1024}, nil
+}
+
 // Ensure mocks implement interfaces
 var _ driven.SchedulerStore = (*mockSchedulerStore)(nil)
 var _ driving.SyncOrchestrator = (*mockSyncOrchestrator)(nil)
@@ -232,6 +247,58 @@ func TestScheduler_InitialiseTasks(t *testing.T) {
 	assert.True(t, docTask.Enabled)
 }
 
+func TestScheduler_InitialiseTasks_SearchCompaction(t *testing.T) {
+	ctx := context.Background()
+
+	t.Run("compactable engine", func(t *testing.T) {
+		store := newMockSchedulerStore()
+		scheduler := NewScheduler(domain.DefaultSchedulerConfig(), store, &mockSyncOrchestrator{})
+		scheduler.SetSearchEngine(&mockCompactableSearchEngine{})
+
+		require.NoError(t, scheduler.initialiseTasks(ctx))
+
+		task, err := store.GetTask(ctx, domain.TaskIDSearchCompact)
+		require.NoError(t, err)
+		require.NotNil(t, task)
+		assert.Equal(t, "Search Index Compaction", task.Name)
+		assert.Equal(t, 24*time.Hour, task.Interval)
+	})
+
+	t.Run("engine without compaction", func(t *testing.T) {
+		store := newMockSchedulerStore()
+		scheduler := NewScheduler(domain.DefaultSchedulerConfig(), store, &mockSyncOrchestrator{})
+		scheduler.SetSearchEngine(&mockSearchEngine{})
+
+		require.NoError(t, scheduler.initialiseTasks(ctx))
+
+		task, err := store.GetTask(ctx, domain.TaskIDSearchCompact)
+		require.NoError(t, err)
+		assert.Nil(t, task)
+	})
+}
+
+func TestScheduler_RunSearchCompaction(t *testing.T) {
+	ctx := context.Background()
+	engine := &mockCompactableSearchEngine{}
+	scheduler := NewScheduler(domain.DefaultSchedulerConfig(), newMockSchedulerStore(), nil)
+	scheduler.SetSearchEngine(engine)
+
+	_, err := scheduler.runSearchCompaction(ctx)
+	require.NoError(t, err)
+	assert.Equal(t, 1, engine.compactCalls)
+
+	engine.compactErr = assert.AnError
+	_, err = scheduler.runSearchCompaction(ctx)
+	assert.ErrorIs(t, err, assert.AnError)
+}
+
+func TestScheduler_RunSearchCompaction_NoEngine(t *testing.T) {
+	scheduler := NewScheduler(domain.DefaultSchedulerConfig(), newMockSchedulerStore(), nil)
+
+	_, err := scheduler.runSearchCompaction(context.Background())
+	require.NoError(t, err)
+}
+
 func TestScheduler_EnsureTask_UpdateInterval(t *testing.T) {
 	config := domain.DefaultSchedulerConfig()
 	store := newMockSchedulerStore()
@@ -22,8 +22,20 @@ type scoredChunk struct {
 	chunkID string
 	score   float64
 	source  string // "keyword", "vector", or "merged"
+	snippet string // Engine-generated highlight, if any
 }
 
+// snippetLength is the maximum length of engine-generated snippets, matching
+// the highlights built by generateHighlights.
+const snippetLength = 200
+
+// collapsedOverfetchDivisor sizes the extra candidates fetched when keyword
+// hits are collapsed by document: limit/divisor on top of limit.
+const collapsedOverfetchDivisor = 4
+
+// rrfK is the reciprocal rank fusion constant for hybrid searches.
+const rrfK = 60
+
 // SearchService provides hybrid search functionality.
 type SearchService struct {
 	docStore         driven.DocumentStore
@@ -33,6 +45,7 @@ type SearchService struct {
 	llmService       driven.LLMService
 	sourceStore      driven.SourceStore
 	credentialsStore driven.CredentialsStore
+	hybridSearcher   driven.HybridSearcher
 }
 
 // NewSearchService creates a new search service.
@@ -63,6 +76,13 @@ func (s *SearchService) SetCredentialsStore(store driven.CredentialsStore) {
 	s.credentialsStore = store
 }
 
+// SetHybridSearcher sets a backend that runs hybrid searches natively.
+// Hybrid searches then make one fused call instead of two searches merged
+// here; if it fails, they fall back to the separate searches.
+func (s *SearchService) SetHybridSearcher(searcher driven.HybridSearcher) {
+	s.hybridSearcher = searcher
+}
+
 // Search performs hybrid search across all indexed documents.
 func (s *SearchService) Search(
 	ctx context.Context, query string, opts domain.SearchOptions,
@@ -84,17 +104,19 @@ func (s *SearchService) Search(
 	}
 	logger.Debug("Limit: %d, Offset: %d", limit, opts.Offset)
 
+	// Determine effective search mode based on options and available services
+	mode := s.effectiveMode(opts)
+	logger.Info("Effective search mode: %s", mode.Description())
+
 	// Request more results internally to account for filtering
-	internalLimit := limit * 2
+	internalLimit := s.internalLimit(limit, mode, opts)
 	if len(opts.SourceIDs) > 0 {
-		internalLimit = limit * 3
 		logger.Debug("Source filter: %v", opts.SourceIDs)
 	}
 	logger.Debug("Internal limit: %d", internalLimit)
 
-	// Determine effective search mode based on options and available services
-	mode := s.effectiveMode(opts)
-	logger.Info("Effective search mode: %s", mode.Description())
+	// Only the page being returned needs snippets
+	snippetTopN := opts.Offset + limit
 
 	// Log available services
 	logger.Debug("Services available: keyword=%t, vector=%t, embedding=%t, llm=%t",
@@ -110,23 +132,23 @@ func (s *SearchService) Search(
 	switch mode {
 	case domain.SearchModeTextOnly:
 		logger.Debug("Executing keyword search")
-		chunks, err = s.keywordSearch(ctx, query, internalLimit)
+		chunks, err = s.keywordSearch(ctx, query, internalLimit, snippetTopN)
 
 	case domain.SearchModeHybrid:
 		logger.Debug("Executing hybrid search (keyword + vector)")
-		chunks, err = s.hybridSearch(ctx, query, internalLimit)
+		chunks, err = s.hybridSearch(ctx, query, internalLimit, snippetTopN, opts.SourceIDs)
 
 	case domain.SearchModeLLMAssisted:
 		logger.Debug("Executing LLM-assisted search")
-		chunks, err = s.llmAssistedSearch(ctx, query, internalLimit)
+		chunks, err = s.llmAssistedSearch(ctx, query, internalLimit, snippetTopN)
 
 	case domain.SearchModeFull:
 		logger.Debug("Executing full search (LLM + hybrid)")
-		chunks, err = s.fullSearch(ctx, query, internalLimit)
+		chunks, err = s.fullSearch(ctx, query, internalLimit, snippetTopN, opts.SourceIDs)
 
 	default:
 		logger.Debug("Fallback to keyword search")
-		chunks, err = s.keywordSearch(ctx, query, internalLimit)
+		chunks, err = s.keywordSearch(ctx, query, internalLimit, snippetTopN)
 	}
 
 	if err != nil {
@@ -157,6 +179,26 @@ func (s *SearchService) Search(
 	return results, nil
 }
 
+// internalLimit returns how many candidates to fetch for a page of limit
+// results. Source filtering drops candidates after the fact, and without
+// collapsing one long document can fill the candidate list with its chunks.
+// Keyword hits from an engine that collapses by document are already
+// diverse, so keyword-only modes then only need headroom for chunks deleted
+// since they were indexed.
+func (s *SearchService) internalLimit(limit int, mode domain.SearchMode, opts domain.SearchOptions) int {
+	if len(opts.SourceIDs) > 0 {
+		return limit * 3
+	}
+
+	keywordOnly := mode != domain.SearchModeHybrid && mode != domain.SearchModeFull
+	if collapsing, ok := s.searchIndex.(driven.CollapsingSearchEngine); ok && keywordOnly &&
+		collapsing.MaxHitsPerDocument() > 0 {
+		return limit + limit/collapsedOverfetchDivisor + 1
+	}
+
+	return limit * 2
+}
+
 // effectiveMode determines the search mode based on options and available services.
 // It gracefully degrades if required services are unavailable.
 func (s *SearchService) effectiveMode(opts domain.SearchOptions) domain.SearchMode {
@@ -193,7 +235,11 @@ func (s *SearchService) effectiveMode(opts domain.SearchOptions) domain.SearchMo
 }
 
 // keywordSearch performs full-text search using Xapian.
-func (s *SearchService) keywordSearch(ctx context.Context, query string, limit int) ([]scoredChunk, error) {
+// When the engine supports it, the best snippetTopN hits come back with
+// highlighted snippets so hydration need not scan their content.
+func (s *SearchService) keywordSearch(
+	ctx context.Context, query string, limit, snippetTopN int,
+) ([]scoredChunk, error) {
 	if s.searchIndex == nil {
 		logger.Warn("Keyword search unavailable: search engine is nil")
 		return nil, errors.New("search engine unavailable")
@@ -201,7 +247,16 @@ func (s *SearchService) keywordSearch(ctx context.Context, query string, limit i
 
 	logger.Debug("Keyword search: query=%q, limit=%d", query, limit)
 
-	hits, err := s.searchIndex.Search(ctx, query, limit)
+	var hits []driven.SearchHit
+	var err error
+	if snippets, ok := s.searchIndex.(driven.SnippetSearchEngine); ok {
+		hits, err = snippets.SearchWithSnippets(ctx, query, limit, driven.SnippetOptions{
+			Length: snippetLength,
+			TopN:   snippetTopN,
+		})
+	} else {
+		hits, err = s.searchIndex.Search(ctx, query, limit)
+	}
 	if err != nil {
 		logger.Warn("Keyword search error: %v", err)
 		return nil, fmt.Errorf("keyword search: %w", err)
@@ -215,6 +270,7 @@ func (s *SearchService) keywordSearch(ctx context.Context, query string, limit i
 			chunkID: hit.ChunkID,
 			score:   hit.Score,
 			source:  "keyword",
+			snippet: hit.Snippet,
 		}
 	}
 
@@ -222,7 +278,14 @@ func (s *SearchService) keywordSearch(ctx context.Context, query string, limit i
 }
 
 // vectorSearch performs semantic similarity search using HNSW.
-func (s *SearchService) vectorSearch(ctx context.Context, query string, limit int) ([]scoredChunk, error) {
+// A source filter is applied inside the index when it supports filtering,
+// so the hits are the nearest chunks of those sources rather than whatever
+// survives post-filtering of the nearest chunks overall. Vectors the index
+// holds without a source (indexed before it recorded sources) pass that
+// filter and are checked by the source post-filter in Search.
+func (s *SearchService) vectorSearch(
+	ctx context.Context, query string, limit int, sourceIDs []string,
+) ([]scoredChunk, error) {
 	if s.vectorIndex == nil {
 		logger.Warn("Vector search unavailable: vector index is nil")
 		return nil, errors.New("vector index unavailable")
@@ -244,7 +307,12 @@ func (s *SearchService) vectorSearch(ctx context.Context, query string, limit in
 	logger.Debug("Query embedding: %d dimensions", len(embedding))
 
 	// Search vector index
-	hits, err := s.vectorIndex.Search(ctx, embedding, limit)
+	var hits []driven.VectorHit
+	if filterable, ok := s.vectorIndex.(driven.FilterableVectorIndex); ok && len(sourceIDs) > 0 {
+		hits, err = filterable.SearchFiltered(ctx, embedding, limit, driven.VectorFilter{SourceIDs: sourceIDs})
+	} else {
+		hits, err = s.vectorIndex.Search(ctx, embedding, limit)
+	}
 	if err != nil {
 		logger.Warn("Vector index search failed: %v", err)
 		return nil, fmt.Errorf("vector search: %w", err)
@@ -265,7 +333,17 @@ func (s *SearchService) vectorSearch(ctx context.Context, query string, limit in
 }
 
 // hybridSearch combines keyword and vector search using RRF.
-func (s *SearchService) hybridSearch(ctx context.Context, query string, limit int) ([]scoredChunk, error) {
+func (s *SearchService) hybridSearch(
+	ctx context.Context, query string, limit, snippetTopN int, sourceIDs []string,
+) ([]scoredChunk, error) {
+	if s.hybridSearcher != nil && s.embeddingService != nil {
+		results, err := s.nativeHybridSearch(ctx, query, limit, snippetTopN, sourceIDs)
+		if err == nil {
+			return results, nil
+		}
+		logger.Warn("Hybrid search: native fusion failed, searching separately: %v", err)
+	}
+
 	logger.Debug("Hybrid search: running keyword and vector searches in parallel")
 
 	// Run keyword and vector searches in parallel
@@ -277,12 +355,12 @@ func (s *SearchService) hybridSearch(ctx context.Context, query string, limit in
 
 	go func() {
 		defer wg.Done()
-		keywordResults, keywordErr = s.keywordSearch(ctx, query, limit)
+		keywordResults, keywordErr = s.keywordSearch(ctx, query, limit, snippetTopN)
 	}()
 
 	go func() {
 		defer wg.Done()
-		vectorResults, vectorErr = s.vectorSearch(ctx, query, limit)
+		vectorResults, vectorErr = s.vectorSearch(ctx, query, limit, sourceIDs)
 	}()
 
 	wg.Wait()
@@ -306,14 +384,57 @@ func (s *SearchService) hybridSearch(ctx context.Context, query string, limit in
 	// Merge using Reciprocal Rank Fusion
 	logger.Debug("Hybrid search: merging %d keyword + %d vector results with RRF",
 		len(keywordResults), len(vectorResults))
-	merged := s.reciprocalRankFusion(keywordResults, vectorResults, 60)
+	merged := s.reciprocalRankFusion(keywordResults, vectorResults, rrfK)
 	logger.Debug("Hybrid search: merged to %d results", len(merged))
 
 	return merged, nil
 }
 
+// nativeHybridSearch runs both searches and their fusion in one call to the
+// hybrid searcher. Fused hits carry no engine snippets, so hydration builds
+// the highlights. Without a query embedding it degrades to keyword search,
+// as hybridSearch does.
+func (s *SearchService) nativeHybridSearch(
+	ctx context.Context, query string, limit, snippetTopN int, sourceIDs []string,
+) ([]scoredChunk, error) {
+	embedding, err := s.embeddingService.Embed(ctx, query)
+	if err != nil {
+		logger.Warn("Hybrid search: query embedding failed, using keyword results only: %v", err)
+		return s.keywordSearch(ctx, query, limit, snippetTopN)
+	}
+
+	opts := driven.HybridSearchOptions{
+		KeywordLimit: limit,
+		VectorLimit:  limit,
+		Fusion:       driven.FusionRRF,
+		RRFK:         rrfK,
+	}
+	if len(sourceIDs) > 0 {
+		opts.Filter = &driven.VectorFilter{SourceIDs: sourceIDs}
+	}
+
+	hits, err := s.hybridSearcher.HybridSearch(ctx, query, embedding, opts)
+	if err != nil {
+		return nil, err
+	}
+	logger.Debug("Hybrid search: %d fused results", len(hits))
+
+	results := make([]scoredChunk, len(hits))
+	for i, hit := range hits {
+		results[i] = scoredChunk{
+			chunkID: hit.ChunkID,
+			score:   hit.Score,
+			source:  "merged",
+		}
+	}
+
+	return results, nil
+}
+
 // llmAssistedSearch uses LLM to expand the query before keyword search.
-func (s *SearchService) llmAssistedSearch(ctx context.Context, query string, limit int) ([]scoredChunk, error) {
+func (s *SearchService) llmAssistedSearch(
+	ctx context.Context, query string, limit, snippetTopN int,
+) ([]scoredChunk, error) {
 	// Expand query using LLM if available
 	expandedQuery := query
 	if s.llmService != nil {
@@ -330,11 +451,13 @@ func (s *SearchService) llmAssistedSearch(ctx context.Context, query string, lim
 	}
 
 	// Perform keyword search with expanded query
-	return s.keywordSearch(ctx, expandedQuery, limit)
+	return s.keywordSearch(ctx, expandedQuery, limit, snippetTopN)
 }
 
 // fullSearch combines LLM query expansion with hybrid search.
-func (s *SearchService) fullSearch(ctx context.Context, query string, limit int) ([]scoredChunk, error) {
+func (s *SearchService) fullSearch(
+	ctx context.Context, query string, limit, snippetTopN int, sourceIDs []string,
+) ([]scoredChunk, error) {
 	// Expand query using LLM if available
 	expandedQuery := query
 	if s.llmService != nil {
@@ -349,7 +472,7 @@ func (s *SearchService) fullSearch(ctx context.Context, query string, limit int)
 	}
 
 	// Run hybrid search with the expanded query
-	return s.hybridSearch(ctx, expandedQuery, limit)
+	return s.hybridSearch(ctx, expandedQuery, limit, snippetTopN, sourceIDs)
 }
 
 // Merges two ranked lists using Reciprocal Rank Fusion (RRF).
@@ -359,12 +482,16 @@ func (s *SearchService) fullSearch(ctx context.Context, query string, limit int)
 func (s *SearchService) reciprocalRankFusion(list1, list2 []scoredChunk, k int) []scoredChunk {
 	scores := make(map[string]float64)
 	seen := make(map[string]bool)
+	snippets := make(map[string]string)
 
 	// Calculate RRF scores for list1
 	for rank, chunk := range list1 {
 		rrf := 1.0 / float64(k+rank+1)
 		scores[chunk.chunkID] += rrf
 		seen[chunk.chunkID] = true
+		if chunk.snippet != "" {
+			snippets[chunk.chunkID] = chunk.snippet
+		}
 	}
 
 	// Add RRF scores for list2
@@ -372,6 +499,9 @@ func (s *SearchService) reciprocalRankFusion(list1, list2 []scoredChunk, k int)
 		rrf := 1.0 / float64(k+rank+1)
 		scores[chunk.chunkID] += rrf
 		seen[chunk.chunkID] = true
+		if chunk.snippet != "" {
+			snippets[chunk.chunkID] = chunk.snippet
+		}
 	}
 
 	// Convert to slice and sort by combined score
@@ -381,6 +511,7 @@ func (s *SearchService) reciprocalRankFusion(list1, list2 []scoredChunk, k int)
 			chunkID: id,
 			score:   scores[id],
 			source:  "merged",
+			snippet: snippets[id],
 		})
 	}
 
@@ -422,8 +553,13 @@ func (s *SearchService) hydrateResults(
 			return nil, fmt.Errorf("get document %s: %w", chunk.DocumentID, err)
 		}
 
-		// Generate highlights
-		highlights := s.generateHighlights(chunk.Content, query)
+		// Prefer the engine's snippet; otherwise scan the content
+		var highlights []string
+		if sc.snippet != "" {
+			highlights = []string{sc.snippet}
+		} else {
+			highlights = s.generateHighlights(chunk.Content, query)
+		}
 
 		// Build SourceName from source and credentials
 		sourceName := s.getSourceName(ctx, doc.SourceID)
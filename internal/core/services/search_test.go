@@ -76,6 +76,97 @@ func (m *mockVectorIndex) Close() error {
 	return nil
 }
 
+// mockFilterableVectorIndex implements driven.FilterableVectorIndex for testing.
+type mockFilterableVectorIndex struct {
+	mockVectorIndex
+	filteredHits  []driven.VectorHit
+	filters       []driven.VectorFilter
+	searchCalls   int
+	filteredCalls int
+}
+
+func (m *mockFilterableVectorIndex) Search(ctx context.Context, query []float32, k int) ([]driven.VectorHit, error) {
+	m.searchCalls++
+	return m.mockVectorIndex.Search(ctx, query, k)
+}
+
+func (m *mockFilterableVectorIndex) AddBatchWithAttributes(
+	_ context.Context, _ []string, _ [][]float32, _ []driven.VectorAttributes,
+) error {
+	return m.addErr
+}
+
+func (m *mockFilterableVectorIndex) SearchFiltered(
+	_ context.Context, _ []float32, _ int, filter driven.VectorFilter,
+) ([]driven.VectorHit, error) {
+	m.filteredCalls++
+	m.filters = append(m.filters, filter)
+	return m.filteredHits, m.searchErr
+}
+
+// mockSnippetSearchEngine implements driven.SnippetSearchEngine for testing.
+type mockSnippetSearchEngine struct {
+	mockSearchEngine
+	snippets    map[string]string
+	opts        []driven.SnippetOptions
+	searchCalls int
+}
+
+func (m *mockSnippetSearchEngine) Search(ctx context.Context, query string, limit int) ([]driven.SearchHit, error) {
+	m.searchCalls++
+	return m.mockSearchEngine.Search(ctx, query, limit)
+}
+
+func (m *mockSnippetSearchEngine) SearchWithSnippets(
+	ctx context.Context, query string, limit int, opts driven.SnippetOptions,
+) ([]driven.SearchHit, error) {
+	m.opts = append(m.opts, opts)
+	hits, err := m.mockSearchEngine.Search(ctx, query, limit)
+	if err != nil {
+		return nil, err
+	}
+	out := make([]driven.SearchHit, len(hits))
+	for i, hit := range hits {
+		out[i] = hit
+		if opts.TopN == 0 || i < opts.TopN {
+			out[i].Snippet = m.snippets[hit.ChunkID]
+		}
+	}
+	return out, nil
+}
+
+// mockCollapsingSearchEngine implements driven.CollapsingSearchEngine for testing.
+type mockCollapsingSearchEngine struct {
+	mockSearchEngine
+	perDocument int
+	limits      []int
+}
+
+func (m *mockCollapsingSearchEngine) Search(ctx context.Context, query string, limit int) ([]driven.SearchHit, error) {
+	m.limits = append(m.limits, limit)
+	return m.mockSearchEngine.Search(ctx, query, limit)
+}
+
+func (m *mockCollapsingSearchEngine) MaxHitsPerDocument() int {
+	return m.perDocument
+}
+
+// mockHybridSearcher implements driven.HybridSearcher for testing.
+type mockHybridSearcher struct {
+	hits       []driven.SearchHit
+	err        error
+	opts       []driven.HybridSearchOptions
+	embeddings [][]float32
+}
+
+func (m *mockHybridSearcher) HybridSearch(
+	_ context.Context, _ string, embedding []float32, opts driven.HybridSearchOptions,
+) ([]driven.SearchHit, error) {
+	m.opts = append(m.opts, opts)
+	m.embeddings = append(m.embeddings, embedding)
+	return m.hits, m.err
+}
+
 // mockEmbeddingService implements driven.EmbeddingService for testing.
 type mockEmbeddingService struct {
 	embedding []float32
@@ -382,6 +473,50 @@ func TestSearchService_Search_SourceIDFilter(t *testing.T) {
 	}
 }
 
+func TestSearchService_Search_SourceIDFilter_FilterableVectorIndex(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockSearchEngine{hits: createTestHits()}
+	vectorIndex := &mockFilterableVectorIndex{
+		mockVectorIndex: mockVectorIndex{hits: createTestVectorHits()},
+		filteredHits:    []driven.VectorHit{{ChunkID: "chunk-1", Similarity: 0.9}},
+	}
+	embedService := &mockEmbeddingService{embedding: make([]float32, 384)}
+	service := NewSearchService(docStore, searchEngine, vectorIndex, embedService, nil)
+	ctx := context.Background()
+
+	results, err := service.Search(ctx, "test", domain.SearchOptions{
+		Semantic:  true,
+		SourceIDs: []string{"src-1"},
+	})
+
+	require.NoError(t, err)
+	// The source filter is pushed into the vector index
+	assert.Equal(t, 1, vectorIndex.filteredCalls)
+	assert.Equal(t, 0, vectorIndex.searchCalls)
+	require.Len(t, vectorIndex.filters, 1)
+	assert.Equal(t, []string{"src-1"}, vectorIndex.filters[0].SourceIDs)
+	for _, r := range results {
+		assert.Equal(t, "src-1", r.Document.SourceID)
+	}
+}
+
+func TestSearchService_Search_NoSourceFilter_UsesPlainVectorSearch(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockSearchEngine{hits: createTestHits()}
+	vectorIndex := &mockFilterableVectorIndex{
+		mockVectorIndex: mockVectorIndex{hits: createTestVectorHits()},
+	}
+	embedService := &mockEmbeddingService{embedding: make([]float32, 384)}
+	service := NewSearchService(docStore, searchEngine, vectorIndex, embedService, nil)
+	ctx := context.Background()
+
+	_, err := service.Search(ctx, "test", domain.SearchOptions{Semantic: true})
+
+	require.NoError(t, err)
+	assert.Equal(t, 1, vectorIndex.searchCalls)
+	assert.Equal(t, 0, vectorIndex.filteredCalls)
+}
+
 func TestSearchService_Search_NoSearchEngine(t *testing.T) {
 	docStore := setupTestDocStore(t)
 	service := NewSearchService(docStore, nil, nil, nil, nil)
@@ -535,6 +670,196 @@ func TestSearchService_Search_Highlights(t *testing.T) {
 	assert.True(t, foundHighlight, "should have generated highlights")
 }
 
+func TestSearchService_Search_EngineSnippets(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockSnippetSearchEngine{
+		mockSearchEngine: mockSearchEngine{hits: createTestHits()},
+		snippets: map[string]string{
+			"chunk-doc-1": "engine snippet one",
+			"chunk-doc-3": "engine snippet three",
+		},
+	}
+	service := NewSearchService(docStore, searchEngine, nil, nil, nil)
+	ctx := context.Background()
+
+	results, err := service.Search(ctx, "sercha", domain.SearchOptions{Limit: 2, Offset: 1})
+
+	require.NoError(t, err)
+	assert.Equal(t, 0, searchEngine.searchCalls)
+	require.Len(t, searchEngine.opts, 1)
+	assert.Equal(t, 3, searchEngine.opts[0].TopN, "snippets cover offset+limit")
+	assert.Equal(t, snippetLength, searchEngine.opts[0].Length)
+
+	// chunk-doc-2 has no engine snippet and falls back to a content scan.
+	require.Len(t, results, 2)
+	assert.Equal(t, "chunk-doc-2", results[0].Chunk.ID)
+	assert.Equal(t, []string{"Configure Sercha using the settings command."}, results[0].Highlights)
+	assert.Equal(t, "chunk-doc-3", results[1].Chunk.ID)
+	assert.Equal(t, []string{"engine snippet three"}, results[1].Highlights)
+}
+
+func TestSearchService_reciprocalRankFusion_KeepsSnippets(t *testing.T) {
+	service := NewSearchService(nil, nil, nil, nil, nil)
+
+	keyword := []scoredChunk{{chunkID: "a", score: 0.9, source: "keyword", snippet: "snippet a"}}
+	vector := []scoredChunk{{chunkID: "b", score: 0.8, source: "vector"}, {chunkID: "a", score: 0.7}}
+
+	merged := service.reciprocalRankFusion(keyword, vector, 60)
+
+	require.Len(t, merged, 2)
+	assert.Equal(t, "a", merged[0].chunkID)
+	assert.Equal(t, "snippet a", merged[0].snippet)
+	assert.Empty(t, merged[1].snippet)
+}
+
+func TestSearchService_Search_CollapsedKeywordHits_LowerOverfetch(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	ctx := context.Background()
+
+	tests := []struct {
+		name        string
+		perDocument int
+		opts        domain.SearchOptions
+		wantLimit   int
+	}{
+		{"collapsed", 3, domain.SearchOptions{Limit: 20}, 26},
+		{"not collapsed", 0, domain.SearchOptions{Limit: 20}, 40},
+		{"source filter", 3, domain.SearchOptions{Limit: 20, SourceIDs: []string{"src-1"}}, 60},
+	}
+
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			searchEngine := &mockCollapsingSearchEngine{
+				mockSearchEngine: mockSearchEngine{hits: createTestHits()},
+				perDocument:      tt.perDocument,
+			}
+			service := NewSearchService(docStore, searchEngine, nil, nil, nil)
+
+			_, err := service.Search(ctx, "sercha", tt.opts)
+
+			require.NoError(t, err)
+			assert.Equal(t, []int{tt.wantLimit}, searchEngine.limits)
+		})
+	}
+}
+
+func TestSearchService_Search_CollapsedKeywordHits_HybridKeepsOverfetch(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockCollapsingSearchEngine{
+		mockSearchEngine: mockSearchEngine{hits: createTestHits()},
+		perDocument:      3,
+	}
+	vectorIndex := &mockVectorIndex{hits: createTestVectorHits()}
+	embedService := &mockEmbeddingService{embedding: make([]float32, 384)}
+	service := NewSearchService(docStore, searchEngine, vectorIndex, embedService, nil)
+
+	_, err := service.Search(context.Background(), "sercha", domain.SearchOptions{
+		Limit:  10,
+		Hybrid: true,
+	})
+
+	require.NoError(t, err)
+	assert.Equal(t, []int{20}, searchEngine.limits)
+}
+
+func TestSearchService_Search_NativeHybrid(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockSnippetSearchEngine{mockSearchEngine: mockSearchEngine{hits: createTestHits()}}
+	vectorIndex := &mockFilterableVectorIndex{mockVectorIndex: mockVectorIndex{hits: createTestVectorHits()}}
+	embedService := &mockEmbeddingService{embedding: make([]float32, 384)}
+	hybrid := &mockHybridSearcher{hits: []driven.SearchHit{
+		{ChunkID: "chunk-doc-3", Score: 0.032},
+		{ChunkID: "chunk-doc-1", Score: 0.016},
+	}}
+	service := NewSearchService(docStore, searchEngine, vectorIndex, embedService, nil)
+	service.SetHybridSearcher(hybrid)
+
+	results, err := service.Search(context.Background(), "sercha", domain.SearchOptions{
+		Limit:  10,
+		Hybrid: true,
+	})
+
+	require.NoError(t, err)
+	require.Len(t, hybrid.opts, 1)
+	assert.Equal(t, driven.HybridSearchOptions{
+		KeywordLimit: 20,
+		VectorLimit:  20,
+		Fusion:       driven.FusionRRF,
+		RRFK:         60,
+	}, hybrid.opts[0])
+	assert.Len(t, hybrid.embeddings[0], 384)
+
+	// Neither index is searched separately.
+	assert.Equal(t, 0, searchEngine.searchCalls)
+	assert.Empty(t, searchEngine.opts)
+	assert.Equal(t, 0, vectorIndex.searchCalls)
+
+	require.Len(t, results, 2)
+	assert.Equal(t, "chunk-doc-3", results[0].Chunk.ID)
+	assert.Equal(t, "chunk-doc-1", results[1].Chunk.ID)
+	assert.NotEmpty(t, results[1].Highlights, "highlights are built from content")
+}
+
+func TestSearchService_Search_NativeHybrid_FiltersVectorsBySource(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockSearchEngine{hits: createTestHits()}
+	vectorIndex := &mockVectorIndex{hits: createTestVectorHits()}
+	embedService := &mockEmbeddingService{embedding: make([]float32, 384)}
+	hybrid := &mockHybridSearcher{hits: []driven.SearchHit{{ChunkID: "chunk-doc-1", Score: 0.016}}}
+	service := NewSearchService(docStore, searchEngine, vectorIndex, embedService, nil)
+	service.SetHybridSearcher(hybrid)
+
+	_, err := service.Search(context.Background(), "sercha", domain.SearchOptions{
+		Limit:     10,
+		Hybrid:    true,
+		SourceIDs: []string{"src-1"},
+	})
+
+	require.NoError(t, err)
+	require.Len(t, hybrid.opts, 1)
+	require.NotNil(t, hybrid.opts[0].Filter)
+	assert.Equal(t, []string{"src-1"}, hybrid.opts[0].Filter.SourceIDs)
+}
+
+func TestSearchService_Search_NativeHybrid_FallsBackOnError(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockSearchEngine{hits: createTestHits()}
+	vectorIndex := &mockVectorIndex{hits: createTestVectorHits()}
+	embedService := &mockEmbeddingService{embedding: make([]float32, 384)}
+	hybrid := &mockHybridSearcher{err: errors.New("native failure")}
+	service := NewSearchService(docStore, searchEngine, vectorIndex, embedService, nil)
+	service.SetHybridSearcher(hybrid)
+
+	results, err := service.Search(context.Background(), "sercha", domain.SearchOptions{
+		Limit:  10,
+		Hybrid: true,
+	})
+
+	require.NoError(t, err)
+	assert.Len(t, hybrid.opts, 1)
+	assert.Len(t, results, 3, "separate searches are merged instead")
+}
+
+func TestSearchService_Search_NativeHybrid_EmbeddingFailure(t *testing.T) {
+	docStore := setupTestDocStore(t)
+	searchEngine := &mockSearchEngine{hits: createTestHits()}
+	vectorIndex := &mockVectorIndex{hits: createTestVectorHits()}
+	embedService := &mockEmbeddingService{embedErr: errors.New("embedding down")}
+	hybrid := &mockHybridSearcher{}
+	service := NewSearchService(docStore, searchEngine, vectorIndex, embedService, nil)
+	service.SetHybridSearcher(hybrid)
+
+	results, err := service.Search(context.Background(), "sercha", domain.SearchOptions{
+		Limit:  10,
+		Hybrid: true,
+	})
+
+	require.NoError(t, err)
+	assert.Empty(t, hybrid.opts, "no fused search without an embedding")
+	require.Len(t, results, 3)
+	assert.Equal(t, "chunk-doc-1", results[0].Chunk.ID)
+}
+
 func TestSearchService_effectiveMode(t *testing.T) {
 	tests := []struct {
 		name         string
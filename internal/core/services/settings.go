@@ -28,6 +28,10 @@ const (
 	keyVectorEnabled   = "vector_index.enabled"
 	keyVectorDims      = "vector_index.dimensions"
 	keyVectorPrecision = "vector_index.precision"
+	keyVectorM         = "vector_index.m"
+	keyVectorEfBuild   = "vector_index.ef_construction"
+	keyVectorEfSearch  = "vector_index.ef_search"
+	keyVectorPartition = "vector_index.partitioned"
 )
 
 // SettingsService manages application settings.
@@ -65,9 +69,13 @@ func (s *SettingsService) Get() (*domain.AppSettings, error) {
 			APIKey:   s.configStore.GetString(keyLLMAPIKey),
 		},
 		VectorIndex: domain.VectorIndexSettings{
-			Enabled:    s.getBool(keyVectorEnabled, defaults.VectorIndex.Enabled),
-			Dimensions: s.getInt(keyVectorDims, defaults.VectorIndex.Dimensions),
-			Precision:  s.getVectorPrecision(defaults.VectorIndex.Precision),
+			Enabled:        s.getBool(keyVectorEnabled, defaults.VectorIndex.Enabled),
+			Dimensions:     s.getInt(keyVectorDims, defaults.VectorIndex.Dimensions),
+			Precision:      s.getVectorPrecision(defaults.VectorIndex.Precision),
+			M:              s.getInt(keyVectorM, defaults.VectorIndex.M),
+			EfConstruction: s.getInt(keyVectorEfBuild, defaults.VectorIndex.EfConstruction),
+			EfSearch:       s.getInt(keyVectorEfSearch, defaults.VectorIndex.EfSearch),
+			Partitioned:    s.getBool(keyVectorPartition, defaults.VectorIndex.Partitioned),
 		},
 	}
 
@@ -123,6 +131,18 @@ func (s *SettingsService) Save(settings *domain.AppSettings) error {
 	if err := s.configStore.Set(keyVectorPrecision, settings.VectorIndex.Precision.String()); err != nil {
 		return fmt.Errorf("save vector precision: %w", err)
 	}
+	if err := s.configStore.Set(keyVectorM, settings.VectorIndex.M); err != nil {
+		return fmt.Errorf("save vector m: %w", err)
+	}
+	if err := s.configStore.Set(keyVectorEfBuild, settings.VectorIndex.EfConstruction); err != nil {
+		return fmt.Errorf("save vector ef_construction: %w", err)
+	}
+	if err := s.configStore.Set(keyVectorEfSearch, settings.VectorIndex.EfSearch); err != nil {
+		return fmt.Errorf("save vector ef_search: %w", err)
+	}
+	if err := s.configStore.Set(keyVectorPartition, settings.VectorIndex.Partitioned); err != nil {
+		return fmt.Errorf("save vector partitioned: %w", err)
+	}
 
 	return nil
 }
@@ -463,8 +483,9 @@ func (s *SettingsService) GetSchedulerConfig() domain.SchedulerConfig {
 	// Per-task config
 	// Map from task ID to config key (underscore version for TOML)
 	taskKeys := map[string]string{
-		domain.TaskIDOAuthRefresh: "oauth_refresh",
-		domain.TaskIDDocumentSync: "document_sync",
+		domain.TaskIDOAuthRefresh:  "oauth_refresh",
+		domain.TaskIDDocumentSync:  "document_sync",
+		domain.TaskIDSearchCompact: "search_compact",
 	}
 
 	for taskID, configKey := range taskKeys {
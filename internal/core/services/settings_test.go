@@ -626,6 +626,39 @@ func TestSettingsService_Save_AllFieldsSet(t *testing.T) {
 	assert.Equal(t, 1536, retrieved.VectorIndex.Dimensions)
 }
 
+func TestSettingsService_Save_VectorIndexTuning(t *testing.T) {
+	store := memory.NewConfigStore()
+	service := NewSettingsService(store, nil)
+
+	settings := domain.DefaultAppSettings()
+	settings.VectorIndex.M = 32
+	settings.VectorIndex.EfConstruction = 400
+	settings.VectorIndex.EfSearch = 128
+	settings.VectorIndex.Partitioned = true
+
+	err := service.Save(&settings)
+	require.NoError(t, err)
+
+	retrieved, err := service.Get()
+	require.NoError(t, err)
+	assert.Equal(t, 32, retrieved.VectorIndex.M)
+	assert.Equal(t, 400, retrieved.VectorIndex.EfConstruction)
+	assert.Equal(t, 128, retrieved.VectorIndex.EfSearch)
+	assert.True(t, retrieved.VectorIndex.Partitioned)
+}
+
+func TestSettingsService_Get_VectorIndexTuningDefaults(t *testing.T) {
+	store := memory.NewConfigStore()
+	service := NewSettingsService(store, nil)
+
+	settings, err := service.Get()
+	require.NoError(t, err)
+	assert.Equal(t, 16, settings.VectorIndex.M)
+	assert.Equal(t, 200, settings.VectorIndex.EfConstruction)
+	assert.Equal(t, 50, settings.VectorIndex.EfSearch)
+	assert.False(t, settings.VectorIndex.Partitioned)
+}
+
 func TestSettingsService_SetEmbeddingProvider_PreservesExistingBaseURL(t *testing.T) {
 	store := memory.NewConfigStore()
 	service := NewSettingsService(store, nil)
@@ -18,6 +18,7 @@ type SourceService struct {
 	syncStore         driven.SyncStateStore
 	docStore          driven.DocumentStore
 	connectorRegistry driving.ConnectorRegistry
+	vectorIndex       driven.VectorIndex
 }
 
 // NewSourceService creates a new source service.
@@ -38,6 +39,12 @@ func (s *SourceService) SetConnectorRegistry(registry driving.ConnectorRegistry)
 	s.connectorRegistry = registry
 }
 
+// SetVectorIndex sets the vector index whose partition of a source is
+// dropped when the source is removed. Only partitioned indexes are affected.
+func (s *SourceService) SetVectorIndex(index driven.VectorIndex) {
+	s.vectorIndex = index
+}
+
 // Add creates a new source configuration.
 func (s *SourceService) Add(ctx context.Context, source domain.Source) error {
 	if s.sourceStore == nil {
@@ -91,7 +98,11 @@ func (s *SourceService) Remove(ctx context.Context, id string) error {
 	if s.sourceStore == nil {
 		return domain.ErrNotImplemented
 	}
-	// Cleanup: delete documents, sync state, then source
+	// Cleanup: delete vectors, documents, sync state, then source
+	if partitioned, ok := s.vectorIndex.(driven.PartitionedVectorIndex); ok {
+		//nolint:errcheck // Intentionally ignore errors to continue cleanup
+		_ = partitioned.DropSource(ctx, id)
+	}
 	if s.docStore != nil {
 		docs, err := s.docStore.ListDocuments(ctx, id)
 		if err == nil {
@@ -280,6 +280,36 @@ func TestSourceService_Remove_WithSyncState(t *testing.T) {
 	assert.ErrorIs(t, err, domain.ErrNotFound)
 }
 
+// mockPartitionedVectorIndex implements driven.PartitionedVectorIndex for testing.
+type mockPartitionedVectorIndex struct {
+	mockVectorIndex
+	dropped []string
+}
+
+func (m *mockPartitionedVectorIndex) DropSource(_ context.Context, sourceID string) error {
+	m.dropped = append(m.dropped, sourceID)
+	return nil
+}
+
+func (m *mockPartitionedVectorIndex) DeleteFromSource(_ context.Context, _, _ string) error {
+	return nil
+}
+
+func TestSourceService_Remove_DropsVectorPartition(t *testing.T) {
+	sourceStore := memory.NewSourceStore()
+	service := NewSourceService(sourceStore, memory.NewSyncStateStore(), memory.NewDocumentStore())
+	vectors := &mockPartitionedVectorIndex{}
+	service.SetVectorIndex(vectors)
+	ctx := context.Background()
+
+	err := service.Add(ctx, domain.Source{ID: "test-source", Name: "Test Source"})
+	require.NoError(t, err)
+
+	err = service.Remove(ctx, "test-source")
+	require.NoError(t, err)
+	assert.Equal(t, []string{"test-source"}, vectors.dropped)
+}
+
 func TestSourceService_Remove_NilStore(t *testing.T) {
 	service := NewSourceService(nil, nil, nil)
 	ctx := context.Background()
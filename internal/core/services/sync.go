@@ -110,7 +110,17 @@ func (o *SyncOrchestrator) Sync(ctx context.Context, sourceID string) error {
 
 	logger.Info("Starting sync for source %s", sourceID)
 
-	// 6. Choose sync strategy based on connector capabilities
+	// 6. Group keyword index writes for the whole run into one transaction;
+	// the cursor below is only saved once the batch is committed
+	batch, batched := o.searchIndex.(driven.BatchSearchEngine)
+	if batched {
+		if err := batch.BeginBatch(ctx); err != nil {
+			logger.Debug("Search index batching unavailable: %v", err)
+			batched = false
+		}
+	}
+
+	// 7. Choose sync strategy based on connector capabilities
 	var newCursor string
 
 	if caps.SupportsIncremental && syncState != nil && syncState.Cursor != "" {
@@ -127,11 +137,19 @@ func (o *SyncOrchestrator) Sync(ctx context.Context, sourceID string) error {
 		}
 	}
 
+	// Commit even after a failure: processed documents are already saved in
+	// the document store and their index entries should match
+	if batched {
+		if commitErr := batch.CommitBatch(ctx); commitErr != nil && err == nil {
+			err = fmt.Errorf("commit search index: %w", commitErr)
+		}
+	}
+
 	if err != nil {
 		return err
 	}
 
-	// 7. Update sync state with new cursor
+	// 8. Update sync state with new cursor
 	newState := domain.SyncState{
 		SourceID: sourceID,
 		Cursor:   newCursor,
@@ -351,20 +369,69 @@ func (o *SyncOrchestrator) processOneDocument(
 		return fmt.Errorf("save chunks: %w", err)
 	}
 
-	// 6. INDEX FOR KEYWORD SEARCH
-	for _, chunk := range chunks {
-		if err := o.searchIndex.Index(ctx, chunk); err != nil {
-			return fmt.Errorf("index chunk: %w", err)
+	// 6. INDEX FOR KEYWORD SEARCH (all chunks in one call when supported)
+	if batch, ok := o.searchIndex.(driven.BatchSearchEngine); ok {
+		if err := batch.IndexBatch(ctx, chunks); err != nil {
+			return fmt.Errorf("index chunks: %w", err)
+		}
+	} else {
+		for _, chunk := range chunks {
+			if err := o.searchIndex.Index(ctx, chunk); err != nil {
+				return fmt.Errorf("index chunk: %w", err)
+			}
 		}
 	}
 
 	// 7. INDEX FOR VECTOR SEARCH (if available)
 	if o.vectorIndex != nil && o.embeddingService != nil {
+		if err := o.indexVectors(ctx, source.ID, chunks); err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+// indexVectors adds chunk embeddings to the vector index, using a single
+// batch call when the index supports it. Indexes that filter by attribute
+// also get each chunk's source and document.
+func (o *SyncOrchestrator) indexVectors(ctx context.Context, sourceID string, chunks []domain.Chunk) error {
+	if filterable, ok := o.vectorIndex.(driven.FilterableVectorIndex); ok {
+		ids := make([]string, 0, len(chunks))
+		embeddings := make([][]float32, 0, len(chunks))
+		attrs := make([]driven.VectorAttributes, 0, len(chunks))
 		for _, chunk := range chunks {
 			if chunk.Embedding != nil {
-				if err := o.vectorIndex.Add(ctx, chunk.ID, chunk.Embedding); err != nil {
-					return fmt.Errorf("add vector: %w", err)
-				}
+				ids = append(ids, chunk.ID)
+				embeddings = append(embeddings, chunk.Embedding)
+				attrs = append(attrs, driven.VectorAttributes{SourceID: sourceID, DocumentID: chunk.DocumentID})
+			}
+		}
+		if err := filterable.AddBatchWithAttributes(ctx, ids, embeddings, attrs); err != nil {
+			return fmt.Errorf("add vectors: %w", err)
+		}
+		return nil
+	}
+
+	if batch, ok := o.vectorIndex.(driven.BatchVectorIndex); ok {
+		ids := make([]string, 0, len(chunks))
+		embeddings := make([][]float32, 0, len(chunks))
+		for _, chunk := range chunks {
+			if chunk.Embedding != nil {
+				ids = append(ids, chunk.ID)
+				embeddings = append(embeddings, chunk.Embedding)
+			}
+		}
+		if err := batch.AddBatch(ctx, ids, embeddings); err != nil {
+			return fmt.Errorf("add vectors: %w", err)
+		}
+		return nil
+	}
+
+	for _, chunk := range chunks {
+		if chunk.Embedding != nil {
+			if err := o.vectorIndex.Add(ctx, chunk.ID, chunk.Embedding); err != nil {
+				return fmt.Errorf("add vector: %w", err)
 			}
 		}
 	}
@@ -399,10 +466,18 @@ func (o *SyncOrchestrator) deleteDocumentByURI(ctx context.Context, sourceID, ur
 		return fmt.Errorf("get chunks: %w", err)
 	}
 
-	// Delete from vector index
+	// Delete from vector index, touching only the source's partition when
+	// vectors are partitioned by source
 	if o.vectorIndex != nil {
+		partitioned, _ := o.vectorIndex.(driven.PartitionedVectorIndex)
 		for _, chunk := range chunks {
-			if err := o.vectorIndex.Delete(ctx, chunk.ID); err != nil {
+			var err error
+			if partitioned != nil {
+				err = partitioned.DeleteFromSource(ctx, sourceID, chunk.ID)
+			} else {
+				err = o.vectorIndex.Delete(ctx, chunk.ID)
+			}
+			if err != nil {
 				logger.Debug("Failed to delete vector %s: %v", chunk.ID, err)
 			}
 		}
@@ -243,6 +243,46 @@ func (e *syncMockSearchEngine) Delete(_ context.Context, chunkID string) error {
 
 func (e *syncMockSearchEngine) Close() error { return nil }
 
+// syncMockBatchSearchEngine implements driven.BatchSearchEngine on top of syncMockSearchEngine.
+type syncMockBatchSearchEngine struct {
+	*syncMockSearchEngine
+	begins         int
+	commits        int
+	depth          int
+	indexedInBatch int
+	indexBatches   int
+	commitErr      error
+}
+
+func (e *syncMockBatchSearchEngine) IndexBatch(ctx context.Context, chunks []domain.Chunk) error {
+	e.indexBatches++
+	for _, chunk := range chunks {
+		if err := e.Index(ctx, chunk); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func (e *syncMockBatchSearchEngine) Index(ctx context.Context, chunk domain.Chunk) error {
+	if e.depth > 0 {
+		e.indexedInBatch++
+	}
+	return e.syncMockSearchEngine.Index(ctx, chunk)
+}
+
+func (e *syncMockBatchSearchEngine) BeginBatch(_ context.Context) error {
+	e.begins++
+	e.depth++
+	return nil
+}
+
+func (e *syncMockBatchSearchEngine) CommitBatch(_ context.Context) error {
+	e.commits++
+	e.depth--
+	return e.commitErr
+}
+
 // syncMockVectorIndex implements driven.VectorIndex with state tracking.
 type syncMockVectorIndex struct {
 	vectors map[string][]float32
@@ -275,6 +315,68 @@ func (v *syncMockVectorIndex) Delete(_ context.Context, id string) error {
 
 func (v *syncMockVectorIndex) Close() error { return nil }
 
+// syncMockBatchVectorIndex implements driven.BatchVectorIndex on top of syncMockVectorIndex.
+type syncMockBatchVectorIndex struct {
+	*syncMockVectorIndex
+	batchCalls int
+}
+
+func (v *syncMockBatchVectorIndex) AddBatch(_ context.Context, ids []string, embeddings [][]float32) error {
+	v.mu.Lock()
+	defer v.mu.Unlock()
+	v.batchCalls++
+	for i, id := range ids {
+		v.vectors[id] = embeddings[i]
+	}
+	return nil
+}
+
+// syncMockFilterableVectorIndex implements driven.FilterableVectorIndex on top of syncMockVectorIndex.
+type syncMockFilterableVectorIndex struct {
+	*syncMockVectorIndex
+	attrs map[string]driven.VectorAttributes
+}
+
+func (v *syncMockFilterableVectorIndex) AddBatchWithAttributes(
+	_ context.Context, ids []string, embeddings [][]float32, attrs []driven.VectorAttributes,
+) error {
+	v.mu.Lock()
+	defer v.mu.Unlock()
+	for i, id := range ids {
+		v.vectors[id] = embeddings[i]
+		v.attrs[id] = attrs[i]
+	}
+	return nil
+}
+
+func (v *syncMockFilterableVectorIndex) SearchFiltered(
+	_ context.Context, _ []float32, _ int, _ driven.VectorFilter,
+) ([]driven.VectorHit, error) {
+	return nil, nil
+}
+
+// syncMockPartitionedVectorIndex implements driven.PartitionedVectorIndex on top of
+// syncMockVectorIndex, recording the source of each routed delete.
+type syncMockPartitionedVectorIndex struct {
+	*syncMockVectorIndex
+	deletes       int
+	sourceDeletes map[string]string
+}
+
+func (v *syncMockPartitionedVectorIndex) Delete(ctx context.Context, id string) error {
+	v.deletes++
+	return v.syncMockVectorIndex.Delete(ctx, id)
+}
+
+func (v *syncMockPartitionedVectorIndex) DropSource(_ context.Context, _ string) error {
+	return nil
+}
+
+func (v *syncMockPartitionedVectorIndex) DeleteFromSource(ctx context.Context, sourceID, id string) error {
+	v.sourceDeletes[id] = sourceID
+	return v.syncMockVectorIndex.Delete(ctx, id)
+}
+
 // syncMockEmbeddingService implements driven.EmbeddingService.
 type syncMockEmbeddingService struct {
 	embedding []float32
@@ -511,6 +613,174 @@ func TestSyncOrchestrator_Sync_WithEmbeddings(t *testing.T) {
 	assert.Len(t, vectorIndex.vectors, 1)
 }
 
+func TestSyncOrchestrator_Sync_WithBatchVectorIndex(t *testing.T) {
+	sourceStore := memory.NewSourceStore()
+	syncStore := memory.NewSyncStateStore()
+	docStore := memory.NewDocumentStore()
+	exclusionStore := memory.NewExclusionStore()
+	factory := newSyncMockConnectorFactory()
+	registry := &syncMockNormaliserRegistry{}
+	searchEngine := newSyncMockSearchEngine()
+	vectorIndex := &syncMockBatchVectorIndex{syncMockVectorIndex: newSyncMockVectorIndex()}
+	embeddingService := &syncMockEmbeddingService{
+		embedding: []float32{0.5, 0.5, 0.5},
+	}
+
+	ctx := context.Background()
+
+	source := domain.Source{ID: "src-1", Name: "Test", Type: "mock"}
+	require.NoError(t, sourceStore.Save(ctx, source))
+
+	factory.connectors["src-1"] = &syncMockConnector{
+		sourceID: "src-1",
+		connType: "mock",
+		fullSyncDocs: []domain.RawDocument{
+			{SourceID: "src-1", URI: "file1.txt", MIMEType: "text/plain", Content: []byte("content 1")},
+			{SourceID: "src-1", URI: "file2.txt", MIMEType: "text/plain", Content: []byte("content 2")},
+		},
+	}
+
+	orchestrator := NewSyncOrchestrator(
+		sourceStore, syncStore, docStore, exclusionStore,
+		factory, registry, &syncMockPostProcessorPipeline{}, searchEngine, vectorIndex, embeddingService,
+	)
+
+	err := orchestrator.Sync(ctx, "src-1")
+
+	require.NoError(t, err)
+
+	// One batch call per document, covering all of its chunks
+	assert.Equal(t, 2, vectorIndex.batchCalls)
+	assert.Len(t, vectorIndex.vectors, 2)
+}
+
+func TestSyncOrchestrator_Sync_WithFilterableVectorIndex(t *testing.T) {
+	sourceStore := memory.NewSourceStore()
+	syncStore := memory.NewSyncStateStore()
+	docStore := memory.NewDocumentStore()
+	exclusionStore := memory.NewExclusionStore()
+	factory := newSyncMockConnectorFactory()
+	registry := &syncMockNormaliserRegistry{}
+	searchEngine := newSyncMockSearchEngine()
+	vectorIndex := &syncMockFilterableVectorIndex{
+		syncMockVectorIndex: newSyncMockVectorIndex(),
+		attrs:               make(map[string]driven.VectorAttributes),
+	}
+	embeddingService := &syncMockEmbeddingService{
+		embedding: []float32{0.5, 0.5, 0.5},
+	}
+
+	ctx := context.Background()
+
+	source := domain.Source{ID: "src-1", Name: "Test", Type: "mock"}
+	require.NoError(t, sourceStore.Save(ctx, source))
+
+	factory.connectors["src-1"] = &syncMockConnector{
+		sourceID: "src-1",
+		connType: "mock",
+		fullSyncDocs: []domain.RawDocument{
+			{SourceID: "src-1", URI: "file1.txt", MIMEType: "text/plain", Content: []byte("content 1")},
+		},
+	}
+
+	orchestrator := NewSyncOrchestrator(
+		sourceStore, syncStore, docStore, exclusionStore,
+		factory, registry, &syncMockPostProcessorPipeline{}, searchEngine, vectorIndex, embeddingService,
+	)
+
+	err := orchestrator.Sync(ctx, "src-1")
+
+	require.NoError(t, err)
+
+	// Every vector carries its source and parent document
+	require.Len(t, vectorIndex.attrs, 1)
+	for _, attrs := range vectorIndex.attrs {
+		assert.Equal(t, "src-1", attrs.SourceID)
+		assert.NotEmpty(t, attrs.DocumentID)
+	}
+}
+
+func TestSyncOrchestrator_Sync_BatchesSearchIndexWrites(t *testing.T) {
+	sourceStore := memory.NewSourceStore()
+	syncStore := memory.NewSyncStateStore()
+	docStore := memory.NewDocumentStore()
+	exclusionStore := memory.NewExclusionStore()
+	factory := newSyncMockConnectorFactory()
+	registry := &syncMockNormaliserRegistry{}
+	searchEngine := &syncMockBatchSearchEngine{syncMockSearchEngine: newSyncMockSearchEngine()}
+
+	ctx := context.Background()
+
+	source := domain.Source{ID: "src-1", Name: "Test", Type: "mock"}
+	require.NoError(t, sourceStore.Save(ctx, source))
+
+	factory.connectors["src-1"] = &syncMockConnector{
+		sourceID: "src-1",
+		connType: "mock",
+		fullSyncDocs: []domain.RawDocument{
+			{SourceID: "src-1", URI: "file1.txt", MIMEType: "text/plain", Content: []byte("content 1")},
+			{SourceID: "src-1", URI: "file2.txt", MIMEType: "text/plain", Content: []byte("content 2")},
+		},
+	}
+
+	orchestrator := NewSyncOrchestrator(
+		sourceStore, syncStore, docStore, exclusionStore,
+		factory, registry, &syncMockPostProcessorPipeline{}, searchEngine, nil, nil,
+	)
+
+	err := orchestrator.Sync(ctx, "src-1")
+
+	require.NoError(t, err)
+
+	// One batch for the whole run, covering every indexed chunk
+	assert.Equal(t, 1, searchEngine.begins)
+	assert.Equal(t, 1, searchEngine.commits)
+	assert.Equal(t, 0, searchEngine.depth)
+	assert.Equal(t, 2, searchEngine.indexedInBatch)
+	// Each document's chunks are indexed in a single call
+	assert.Equal(t, 2, searchEngine.indexBatches)
+}
+
+func TestSyncOrchestrator_Sync_BatchCommitFailure(t *testing.T) {
+	sourceStore := memory.NewSourceStore()
+	syncStore := memory.NewSyncStateStore()
+	docStore := memory.NewDocumentStore()
+	exclusionStore := memory.NewExclusionStore()
+	factory := newSyncMockConnectorFactory()
+	registry := &syncMockNormaliserRegistry{}
+	searchEngine := &syncMockBatchSearchEngine{
+		syncMockSearchEngine: newSyncMockSearchEngine(),
+		commitErr:            errors.New("disk full"),
+	}
+
+	ctx := context.Background()
+
+	source := domain.Source{ID: "src-1", Name: "Test", Type: "mock"}
+	require.NoError(t, sourceStore.Save(ctx, source))
+
+	factory.connectors["src-1"] = &syncMockConnector{
+		sourceID: "src-1",
+		connType: "mock",
+		fullSyncDocs: []domain.RawDocument{
+			{SourceID: "src-1", URI: "file1.txt", MIMEType: "text/plain", Content: []byte("content 1")},
+		},
+	}
+
+	orchestrator := NewSyncOrchestrator(
+		sourceStore, syncStore, docStore, exclusionStore,
+		factory, registry, &syncMockPostProcessorPipeline{}, searchEngine, nil, nil,
+	)
+
+	err := orchestrator.Sync(ctx, "src-1")
+
+	require.Error(t, err)
+	assert.Contains(t, err.Error(), "commit search index")
+
+	// The sync state is not advanced past an uncommitted batch
+	_, err = syncStore.Get(ctx, "src-1")
+	assert.ErrorIs(t, err, domain.ErrNotFound)
+}
+
 func TestSyncOrchestrator_Sync_IncrementalSync(t *testing.T) {
 	sourceStore := memory.NewSourceStore()
 	syncStore := memory.NewSyncStateStore()
@@ -864,3 +1134,50 @@ func TestSyncOrchestrator_ProcessChanges_Delete(t *testing.T) {
 	// Verify search index was cleaned
 	assert.Len(t, searchEngine.indexed, 0)
 }
+
+func TestSyncOrchestrator_ProcessChanges_DeleteRoutesToSourcePartition(t *testing.T) {
+	sourceStore := memory.NewSourceStore()
+	syncStore := memory.NewSyncStateStore()
+	docStore := memory.NewDocumentStore()
+	factory := newSyncMockConnectorFactory()
+	searchEngine := newSyncMockSearchEngine()
+	vectorIndex := &syncMockPartitionedVectorIndex{
+		syncMockVectorIndex: newSyncMockVectorIndex(),
+		sourceDeletes:       make(map[string]string),
+	}
+
+	ctx := context.Background()
+
+	source := domain.Source{ID: "src-1", Name: "Test", Type: "mock"}
+	require.NoError(t, sourceStore.Save(ctx, source))
+	doc := domain.Document{ID: "doc-1", SourceID: "src-1", URI: "existing.txt", Title: "Existing"}
+	require.NoError(t, docStore.SaveDocument(ctx, &doc))
+	chunk := domain.Chunk{ID: "chunk-1", DocumentID: "doc-1", Content: "content"}
+	require.NoError(t, docStore.SaveChunks(ctx, []domain.Chunk{chunk}))
+	require.NoError(t, vectorIndex.Add(ctx, chunk.ID, []float32{0.1, 0.2, 0.3}))
+	require.NoError(t, syncStore.Save(ctx, domain.SyncState{SourceID: "src-1", Cursor: "cursor-123"}))
+
+	factory.connectors["src-1"] = &syncMockConnector{
+		sourceID:     "src-1",
+		connType:     "mock",
+		capabilities: driven.ConnectorCapabilities{SupportsIncremental: true},
+		incSyncDocs: []domain.RawDocumentChange{
+			{
+				Type:     domain.ChangeDeleted,
+				Document: domain.RawDocument{SourceID: "src-1", URI: "existing.txt"},
+			},
+		},
+	}
+
+	orchestrator := NewSyncOrchestrator(
+		sourceStore, syncStore, docStore, memory.NewExclusionStore(),
+		factory, &syncMockNormaliserRegistry{}, &syncMockPostProcessorPipeline{}, searchEngine,
+		vectorIndex, &syncMockEmbeddingService{},
+	)
+
+	require.NoError(t, orchestrator.Sync(ctx, "src-1"))
+
+	assert.Equal(t, map[string]string{"chunk-1": "src-1"}, vectorIndex.sourceDeletes)
+	assert.Equal(t, 0, vectorIndex.deletes)
+	assert.Empty(t, vectorIndex.vectors)
+}